@@ -859,6 +859,23 @@ module snitch_cc #(
   // Tracer
   // --------------------------
   // pragma translate_off
+`ifdef SNITCH_BINARY_TRACE
+  // Binary tracer (`target/common/test/trace.cc`): records are passed through
+  // DPI unformatted and compressed in the background, decode them with
+  // `util/trace/gen_trace.py`.
+  import "DPI-C" function void snitch_trace_open(input int hart_id, input longint time_scale);
+  import "DPI-C" function void snitch_trace_snitch(
+    input int hart_id, input longint timestamp, input longint cycle, input int priv, input int pc,
+    input int insn, input snitch_pkg::snitch_trace_port_t extras);
+  import "DPI-C" function void snitch_trace_fpu(
+    input int hart_id, input longint timestamp, input longint cycle, input int priv,
+    input longint insn, input snitch_pkg::fpu_trace_port_t extras);
+  import "DPI-C" function void snitch_trace_fpu_seq(
+    input int hart_id, input longint timestamp, input longint cycle, input int priv,
+    input snitch_pkg::fpu_sequencer_trace_port_t extras);
+  import "DPI-C" function void snitch_trace_close(input int hart_id);
+  string time_scale;
+`endif
   int f;
   string fn;
   logic [63:0] cycle;
@@ -870,8 +887,15 @@ module snitch_cc #(
     #0;
 `endif
     $system("mkdir logs -p");
+`ifdef SNITCH_BINARY_TRACE
+    $sformat(fn, "logs/trace_hart_%05x.bin", hart_id_i);
+    // Record `$time` as is, along with the factor `%t` would scale it by
+    $sformat(time_scale, "%0t", 1);
+    snitch_trace_open(hart_id_i, time_scale.atoi());
+`else
     $sformat(fn, "logs/trace_hart_%05x.dasm", hart_id_i);
     f = $fopen(fn, "w");
+`endif
     $display("[Tracer] Logging Hart %d to %s", hart_id_i, fn);
   end
 
@@ -940,10 +964,15 @@ module snitch_cc #(
       if (
           !i_snitch.stall || i_snitch.retire_load || i_snitch.retire_acc
       ) begin
+`ifdef SNITCH_BINARY_TRACE
+        snitch_trace_snitch(hart_id_i, $time, cycle, i_snitch.priv_lvl_q, i_snitch.pc_q,
+            i_snitch.inst_data_i, extras_snitch);
+`else
         $sformat(trace_entry, "%t %1d %8d 0x%h DASM(%h) #; %s\n",
             $time, cycle, i_snitch.priv_lvl_q, i_snitch.pc_q, i_snitch.inst_data_i,
             snitch_pkg::print_snitch_trace(extras_snitch));
         $fwrite(f, trace_entry);
+`endif
       end
       if (FPEn) begin
         // Trace FPU iff:
@@ -953,18 +982,28 @@ module snitch_cc #(
         // OR an FPU result, LSU result or bus value is ready to be written back to an FPR register
         if (extras_fpu.acc_q_hs || extras_fpu.fpu_out_hs
         || extras_fpu.lsu_q_hs || extras_fpu.fpr_we) begin
+`ifdef SNITCH_BINARY_TRACE
+          snitch_trace_fpu(hart_id_i, $time, cycle, i_snitch.priv_lvl_q, extras_fpu.op_in,
+              extras_fpu);
+`else
           $sformat(trace_entry, "%t %1d %8d 0x%h DASM(%h) #; %s\n",
               $time, cycle, i_snitch.priv_lvl_q, 32'hz, extras_fpu.op_in,
               snitch_pkg::print_fpu_trace(extras_fpu));
           $fwrite(f, trace_entry);
+`endif
         end
         // sequencer instructions
         if (Xfrep) begin
           if (extras_fpu_seq_out.cbuf_push) begin
+`ifdef SNITCH_BINARY_TRACE
+            snitch_trace_fpu_seq(hart_id_i, $time, cycle, i_snitch.priv_lvl_q,
+                extras_fpu_seq_out);
+`else
             $sformat(trace_entry, "%t %1d %8d 0x%h DASM(%h) #; %s\n",
                 $time, cycle, i_snitch.priv_lvl_q, 32'hz, 64'hz,
                 snitch_pkg::print_fpu_sequencer_trace(extras_fpu_seq_out));
             $fwrite(f, trace_entry);
+`endif
           end
         end
       end
@@ -974,7 +1013,11 @@ module snitch_cc #(
   end
 
   final begin
+`ifdef SNITCH_BINARY_TRACE
+    snitch_trace_close(hart_id_i);
+`else
     $fclose(f);
+`endif
   end
   // verilog_lint: waive-stop always-ff-non-blocking
   // pragma translate_on
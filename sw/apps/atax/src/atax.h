@@ -53,6 +53,7 @@ void atax_job(void *args) {
     double *local_y;
     double *local_tmp;
     atax_args_t *local_args;
+    snrt_l1_mark_t l1_mark = snrt_l1_mark();
 
 #ifndef JOB_ARGS_PRELOADED
     // Allocate space for job arguments in TCDM
@@ -112,9 +113,5 @@ void atax_job(void *args) {
     snrt_cluster_hw_barrier();
 
     // Free memory
-#ifndef JOB_ARGS_PRELOADED
-    snrt_l1_update_next_v2(local_args);
-#else
-    snrt_l1_update_next_v2(local_A);
-#endif
+    snrt_l1_release(l1_mark);
 }
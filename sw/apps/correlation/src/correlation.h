@@ -88,6 +88,7 @@ void correlation_job(void *args) {
     double *local_stddev;
     double *local_corr;
     correlation_args_t *local_args;
+    snrt_l1_mark_t l1_mark = snrt_l1_mark();
 
 #ifndef JOB_ARGS_PRELOADED
     // Allocate space for job arguments in TCDM
@@ -199,9 +200,5 @@ void correlation_job(void *args) {
     }
 
     // Free memory
-#ifndef JOB_ARGS_PRELOADED
-    snrt_l1_update_next_v2(local_args);
-#else
-    snrt_l1_update_next_v2(local_data);
-#endif
+    snrt_l1_release(l1_mark);
 }
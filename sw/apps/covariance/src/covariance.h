@@ -241,6 +241,7 @@ void covariance_job(covariance_args_t *args) {
     double *local_b[2];
     uint32_t iterations, sb_iterations;
     uint32_t i, i_dma_in, i_compute, i_dma_out, i_row, i_col, buff_idx;
+    snrt_l1_mark_t l1_mark = snrt_l1_mark();
 
 #ifndef JOB_ARGS_PRELOADED
     // Allocate space for job arguments in TCDM
@@ -368,9 +369,5 @@ void covariance_job(covariance_args_t *args) {
     }
 
     // Free memory
-#ifndef JOB_ARGS_PRELOADED
-    snrt_l1_update_next_v2(args);
-#else
-    snrt_l1_update_next_v2(local_a[0]);
-#endif
+    snrt_l1_release(l1_mark);
 }
@@ -8,6 +8,7 @@
 #          Viviane Potocnik <vivianep@iis.ee.ethz.ch>
 #          Luca Colagrande <colluca@iis.ee.ethz.ch>
 
+from math import ceil
 import numpy as np
 import re
 import sys
@@ -47,42 +48,54 @@ class GemmDataGen(du.DataGen):
     def validate(self, gemm_fp, parallelize_m,
                  parallelize_k, m_tiles, n_tiles, k_tiles, transa,
                  transb, m, n, k, beta, **kwargs):
-        double_buffer = kwargs.get('double_buffer', False)
         partition_banks = kwargs.get('partition_banks', False)
-        tile_m = m / m_tiles
-        tile_n = n / n_tiles
-        tile_k = k / k_tiles
+        m_clusters = kwargs.get('m_clusters', 0)
+        n_clusters = kwargs.get('n_clusters', 0)
+        k_clusters = kwargs.get('k_clusters', 0)
+
+        # Tiles of zero are chosen by the planner of the kernel, which also
+        # overrides double_buffer and partition_banks
+        planned = not (m_tiles and n_tiles and k_tiles)
 
         dtype, impl = self.infer_implementation(gemm_fp)
 
+        # Tiles need not divide the problem, but none may be empty
+        for size, tiles, dim in [(m, m_tiles, 'm'), (n, n_tiles, 'n'), (k, k_tiles, 'k')]:
+            assert not tiles or (ceil(size / tiles) * (tiles - 1) < size), \
+                f'{dim}_tiles leaves the last tile along {dim} empty'
+
         # Calculate total TCDM occupation
         # Note: doesn't account for double buffering
-        prec = du.size_from_precision_t(dtype)
-        a_size = tile_m * tile_k * prec
-        b_size = tile_k * tile_n * prec
-        c_size = tile_m * tile_n * prec
-        total_size = a_size
-        total_size += b_size
-        total_size += c_size
-        du.validate_tcdm_footprint(total_size)
-
-        assert (m % m_tiles) == 0, 'm is not an integer multiple of tile size'
-        assert (n % n_tiles) == 0, 'n is not an integer multiple of tile size'
-        assert (k % k_tiles) == 0, 'k is not an integer multiple of tile size'
-        assert kwargs['load_a'] or (m_tiles == 1 and k_tiles == 1), 'A matrix can\'t be tiled if' \
+        if not planned:
+            tile_m = ceil(m / m_tiles)
+            tile_n = ceil(n / n_tiles)
+            tile_k = ceil(k / k_tiles)
+            prec = du.size_from_precision_t(dtype)
+            a_size = tile_m * tile_k * prec
+            b_size = tile_k * tile_n * prec
+            c_size = tile_m * tile_n * prec
+            total_size = a_size
+            total_size += b_size
+            total_size += c_size
+            du.validate_tcdm_footprint(total_size)
+
+        assert kwargs['load_a'] or (m_tiles <= 1 and k_tiles <= 1), 'A matrix can\'t be tiled if' \
             ' local tile buffer is externally managed (load_a == 0)'
-        assert kwargs['load_b'] or (k_tiles == 1 and n_tiles == 1), 'B matrix can\'t be tiled if' \
+        assert kwargs['load_b'] or (k_tiles <= 1 and n_tiles <= 1), 'B matrix can\'t be tiled if' \
             ' local tile buffer is externally managed (load_b == 0)'
-        assert kwargs['load_c'] or (m_tiles == 1 and n_tiles == 1), 'C matrix can\'t be tiled if' \
+        assert kwargs['load_c'] or (m_tiles <= 1 and n_tiles <= 1), 'C matrix can\'t be tiled if' \
             ' local tile buffer is externally managed (load_c == 0)'
-        assert not (parallelize_m and parallelize_k), 'Cannot parallelize k and m simultaneously'
-        assert not (double_buffer and parallelize_k), 'Cannot parallelize k when double buffering'
+        assert not (parallelize_m and parallelize_k), 'Cannot parallelize k and m simultaneously' \
+            ' on all clusters, use a cluster grid (m_clusters, n_clusters, k_clusters) instead'
+        assert (m_tiles % max(m_clusters, 1)) == 0, \
+            'm_tiles is not an integer multiple of m_clusters'
+        assert (n_tiles % max(n_clusters, 1)) == 0, \
+            'n_tiles is not an integer multiple of n_clusters'
+        assert (k_tiles % max(k_clusters, 1)) == 0, \
+            'k_tiles is not an integer multiple of k_clusters'
         assert not transa, 'SIMD kernels don\'t support transposed A matrix'
         assert (dtype == 8) or (impl == 'baseline') or (impl == 'naive') \
             or transb, 'Optimized SIMD kernels only support transposed B matrix'
-        assert (impl == 'baseline') or (impl == 'naive') or tile_n >= 8, \
-            'n dimension of tile size must be greater or equal to the unrolling factor (8) ' \
-            'when using optimized kernels'
         assert beta == 0 or beta == 1, 'Only values of 0 or 1 supported for beta'
         assert not (dtype == 8 and impl == "baseline"), 'No baseline implemented' \
             ' for FP64 (switch to NAIVE)'
@@ -90,6 +103,11 @@ class GemmDataGen(du.DataGen):
             'Expanding GEMM kernels not supported for FP64 and FP32'
         assert not (dtype == 1 and impl == "opt"), 'FP8 not supported in' \
             ' optimized implementation (switch to opt_ex)'
+        partition_banks = partition_banks and not planned
+        ragged = not planned and any(size % tiles for size, tiles in
+                                     [(m, m_tiles), (n, n_tiles), (k, k_tiles)])
+        assert not (partition_banks and ragged), \
+            'Cannot allocate buffer in a subset of banks if the tiles are not all of the same size'
         assert not (partition_banks and (transb or transa or k_tiles > 1 or n_tiles > 1)), \
             'Cannot allocate buffer in a subset of banks if the A, B and C matrix tiles are not ' \
             'a contiguous 1D block of data. This is guaranteed if A and B are not transposed and' \
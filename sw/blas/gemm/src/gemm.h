@@ -16,11 +16,235 @@
 
 #include "gemm_types.h"
 
+#include "gemm_plan.h"
+
 #include "gemm_fp16.h"
 #include "gemm_fp32.h"
 #include "gemm_fp64.h"
 #include "gemm_fp8.h"
 
+/**
+ * @brief Sum operator on FP8 values stored as `char`, for the cross-cluster
+ *        reduction of the partial C tiles.
+ */
+struct gemm_fp8_add {
+    char operator()(char a, char b) const {
+        asm volatile(
+            "fmv.b.x ft3, %[a]\n"
+            "fmv.b.x ft4, %[b]\n"
+            "fadd.b ft3, ft3, ft4 \n"
+            "fmv.x.b %[a], ft3\n"
+            : [ a ] "+r"(a)
+            : [ b ] "r"(b)
+            : "ft3", "ft4");
+        return a;
+    }
+};
+
+/**
+ * @brief Sum the partial C tiles of the clusters along the K dimension of the
+ *        cluster grid into the tile of the first cluster of @p group,
+ *        interpreting them according to `prec`.
+ * @note Both compute and DMA cores of all clusters must invoke this function,
+ *       though not necessarily at the same time, and synchronize before the
+ *       result is used (see `snrt_cluster_group_reduction_dma_decoupled`).
+ */
+inline void gemm_reduce_c_tile(void *dst, void *src, uint32_t len,
+                               uint32_t prec,
+                               const snrt_cluster_group_t *group) {
+    switch (prec) {
+        case FP64:
+            snrt_cluster_group_reduction_dma_decoupled(
+                (double *)dst, (double *)src, len, group);
+            break;
+        case FP32:
+            snrt_cluster_group_reduction_dma_decoupled(
+                (float *)dst, (float *)src, len, group);
+            break;
+        case FP16:
+            snrt_cluster_group_reduction_dma_decoupled(
+                (__fp16 *)dst, (__fp16 *)src, len, group);
+            break;
+        case FP8:
+            snrt_cluster_group_reduction_dma_decoupled(
+                (char *)dst, (char *)src, len, group, gemm_fp8_add());
+            break;
+    }
+}
+
+/**
+ * @brief Clusters of the cluster grid loading the same operand tiles.
+ *
+ * The clusters are `stride` apart, and the one of rank 0 is elected to load
+ * the tiles. If `mcast_mask` is non-zero, it loads them into the TCDM of all
+ * clusters at once, with a multicast DMA transfer.
+ */
+typedef struct {
+    uint32_t num;
+    uint32_t stride;
+    uint32_t rank;
+    uint32_t mcast_mask;
+} gemm_sharers_t;
+
+// Multicast is only possible if the sharers differ in a power-of-two number
+// of contiguous bits of their cluster index.
+static inline void gemm_map_sharers(uint32_t num, uint32_t stride,
+                                    uint32_t rank, uint32_t multicast,
+                                    gemm_sharers_t *sharers) {
+    sharers->num = num;
+    sharers->stride = stride;
+    sharers->rank = rank;
+    sharers->mcast_mask = 0;
+#if SNRT_SUPPORTS_MULTICAST
+    if (multicast && num > 1 && !(num & (num - 1)) && !(stride & (stride - 1)))
+        sharers->mcast_mask = (num - 1) * stride * SNRT_CLUSTER_OFFSET;
+#endif
+}
+
+/**
+ * @brief Position of a cluster in the cluster grid of a multi-cluster GEMM.
+ *
+ * The clusters are arranged in a `m` x `n` x `k` grid, with the K dimension
+ * varying fastest, so that the clusters reducing the same C tile are
+ * contiguous. If the grid is smaller than the system, it is replicated, and
+ * every replica computes the whole problem. The clusters of an incomplete
+ * replica stay idle.
+ */
+typedef struct {
+    uint32_t m;
+    uint32_t n;
+    uint32_t k;
+    uint32_t pm;
+    uint32_t pn;
+    uint32_t pk;
+    uint32_t active;
+    // Clusters along the K dimension sharing the C tiles of this cluster
+    snrt_cluster_group_t k_group;
+    // Clusters along the N and M dimensions sharing the A and B tiles of this
+    // cluster, respectively
+    gemm_sharers_t a_sharers;
+    gemm_sharers_t b_sharers;
+} gemm_cluster_grid_t;
+
+// Map the calling cluster onto the cluster grid. Returns a non-zero value if
+// the grid does not fit in the system.
+static inline int gemm_map_cluster(const gemm_args_t *largs,
+                                   gemm_cluster_grid_t *grid) {
+    grid->m = largs->m_clusters;
+    grid->n = largs->n_clusters;
+    grid->k = largs->k_clusters;
+    if (!grid->m) grid->m = largs->parallelize_m ? snrt_cluster_num() : 1;
+    if (!grid->n) grid->n = 1;
+    if (!grid->k) grid->k = largs->parallelize_k ? snrt_cluster_num() : 1;
+
+    uint32_t size = grid->m * grid->n * grid->k;
+    if (size > snrt_cluster_num()) return 1;
+    uint32_t replica = snrt_cluster_idx() / size;
+    uint32_t idx = snrt_cluster_idx() % size;
+    grid->active = replica < snrt_cluster_num() / size;
+    grid->pk = idx % grid->k;
+    grid->pn = (idx / grid->k) % grid->n;
+    grid->pm = idx / (grid->k * grid->n);
+
+    uint32_t first = snrt_cluster_idx() - grid->pk;
+    grid->k_group.mask = grid->active ? ((1u << grid->k) - 1) << first : 0;
+    grid->k_group.barrier_idx = 0;
+
+    gemm_map_sharers(grid->n, grid->k, grid->pn, largs->multicast,
+                     &grid->a_sharers);
+    gemm_map_sharers(grid->m, grid->n * grid->k, grid->pm, largs->multicast,
+                     &grid->b_sharers);
+    return 0;
+}
+
+enum { GEMM_OPERAND_A, GEMM_OPERAND_B };
+
+/**
+ * @brief Handshake state of the multicast operand loads, allocated at the
+ *        same offset in the TCDM of every cluster.
+ *
+ * Tiles are numbered by the DMA-in iteration which loads them, starting from
+ * one. `free[op][rank]` is written by the sharer of the given rank when its
+ * buffer for a tile of the operand can be overwritten. `ready[op]` is written
+ * by the loader when the tile has been multicast.
+ */
+typedef struct {
+    volatile uint32_t ready[2];
+    volatile uint32_t free[2][SNRT_CLUSTER_NUM];
+} gemm_mcast_state_t;
+
+// Address of a loader's TCDM buffer in the cluster of rank 1, to be used as
+// the destination of a multicast. See snrt_wake_all.
+static inline void *gemm_mcast_dst(void *ptr, const gemm_sharers_t *sharers) {
+    return snrt_remote_l1_ptr(ptr, snrt_cluster_idx(),
+                              snrt_cluster_idx() + sharers->stride);
+}
+
+// Signal the loader that the buffer for tile `seq` is free.
+static inline void gemm_mcast_release_buffer(gemm_mcast_state_t *state,
+                                             uint32_t op,
+                                             const gemm_sharers_t *sharers,
+                                             uint32_t seq) {
+    uint32_t loader = snrt_cluster_idx() - sharers->rank * sharers->stride;
+    gemm_mcast_state_t *loader_state =
+        (gemm_mcast_state_t *)snrt_remote_l1_ptr(state, snrt_cluster_idx(),
+                                                 loader);
+    loader_state->free[op][sharers->rank] = seq;
+}
+
+// Wait until all sharers freed their buffer for tile `seq`.
+static inline void gemm_mcast_wait_buffers(gemm_mcast_state_t *state,
+                                           uint32_t op,
+                                           const gemm_sharers_t *sharers,
+                                           uint32_t seq) {
+    for (uint32_t r = 1; r < sharers->num; r++)
+        while (state->free[op][r] < seq)
+            ;
+}
+
+// Signal the sharers that tile `seq` was multicast, and raise an interrupt
+// on their DM cores. The flag is written first, so that the sharers find it
+// set when they wake up.
+static inline void gemm_mcast_signal_ready(gemm_mcast_state_t *state,
+                                           uint32_t op,
+                                           const gemm_sharers_t *sharers,
+                                           uint32_t seq) {
+    volatile uint32_t *ready =
+        &((gemm_mcast_state_t *)gemm_mcast_dst(state, sharers))->ready[op];
+    volatile uint32_t *clint_set = (volatile uint32_t *)gemm_mcast_dst(
+        (void *)snrt_cluster_clint_set_ptr(), sharers);
+    snrt_enable_multicast(sharers->mcast_mask);
+    *ready = seq;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    *clint_set = 1 << snrt_cluster_core_idx();
+    snrt_disable_multicast();
+}
+
+// Sleep until tile `seq` was multicast. The interrupt only wakes up the core,
+// the flag tells which tile it signals.
+static inline void gemm_mcast_wait_ready(gemm_mcast_state_t *state,
+                                         uint32_t op, uint32_t seq) {
+    while (state->ready[op] < seq) {
+        snrt_wfi();
+        snrt_int_clr_mcip();
+    }
+}
+
+// Naive kernel of the given precision, computing the parts of a tile which
+// the optimized kernels do not support
+static inline gemm_fp_t gemm_naive_kernel(uint32_t prec) {
+    switch (prec) {
+        case FP64:
+            return gemm_fp64_naive;
+        case FP32:
+            return gemm_fp32_naive;
+        case FP16:
+            return gemm_fp16_naive;
+        default:
+            return gemm_fp8_naive;
+    }
+}
+
 /**
  * @brief Executes one GEMM tile on one Snitch cluster (single-cluster,
  *        single-tile GEMM).
@@ -35,7 +259,11 @@
  *    contiguous set of rows, but on a strided set of rows (stride equal to the
  *    number of compute cores).
  * 2. Each compute core invokes an underlying GEMM kernel function, to compute
- *    the assigned subproblem.
+ *    the assigned subproblem. Tiles of any size are supported: the kernel
+ *    computes the C columns in blocks of `GEMM_UNROLL` columns, and the
+ *    remaining columns are computed by the naive kernel of the same
+ *    precision, as are the tiles whose K dimension the optimized kernels do
+ *    not support (see `gemm_opt_kernel_supports_k()`).
  */
 void sc_st_gemm(gemm_fp_t kernel, sc_st_gemm_args_t *args) {
     if (snrt_is_compute_core()) {
@@ -57,97 +285,122 @@ void sc_st_gemm(gemm_fp_t kernel, sc_st_gemm_args_t *args) {
         uint32_t rem_m = args->m % core_num;
         if (snrt_cluster_core_idx() < rem_m) frac_m++;
 
+        // Split the C columns among the kernel and the naive kernel
+        uint32_t n_opt = args->n - (args->n % GEMM_UNROLL);
+        if (!gemm_opt_kernel_supports_k(args->k, args->prec)) n_opt = 0;
+
         // Invoke kernel for each core
         if (frac_m > 0) {
-            kernel(args->setup_ssr, args->partition_banks, args->transa,
-                   args->transb, frac_m, args->n, args->k, a, lda, args->b,
-                   args->ldb, args->beta, c, ldc);
+            if (n_opt > 0) {
+                kernel(args->setup_ssr, args->partition_banks, args->transa,
+                       args->transb, frac_m, n_opt, args->k, a, lda, args->b,
+                       args->ldb, args->beta, c, ldc);
+            }
+            if (n_opt < args->n) {
+                uint32_t offset_b = args->transb ? n_opt * args->ldb : n_opt;
+                void *b = (void *)((uintptr_t)(args->b) +
+                                   offset_b * args->prec);
+                void *c_rem = (void *)((uintptr_t)c + n_opt * args->prec);
+                gemm_naive_kernel(args->prec)(
+                    args->setup_ssr, args->partition_banks, args->transa,
+                    args->transb, frac_m, args->n - n_opt, args->k, a, lda, b,
+                    args->ldb, args->beta, c_rem, ldc);
+            }
             snrt_fpu_fence();
         }
     }
 }
 
-// With the partitioned banks layout, the stride between rows of a matrix
-// equals the number of TCDM lines needed to store a row of the matrix. This
-// function calculates such stride.
-// `size` is in bytes
-static inline uint32_t calculate_partitioned_banks_lines(
-    uint32_t banks_per_buffer, uint32_t size) {
-    return size / (banks_per_buffer * SNRT_TCDM_BANK_WIDTH);
-}
-
 // Allocate space for local tile buffers in TCDM, unless preloaded
 static inline void allocate_buffers(uint32_t size_a, uint32_t size_b,
                                     uint32_t size_c, const gemm_args_t *largs,
+                                    uint32_t k_parallel,
                                     uint32_t banks_per_buffer, void **la,
                                     void **lb, void **lc, void **lcr) {
-    uintptr_t a_addr[2], b_addr[2], c_addr[2];
+    void *a_addr[2] = {NULL, NULL}, *b_addr[2] = {NULL, NULL},
+         *c_addr[2] = {NULL, NULL};
 
-    // Calculate base address of each buffer
-    a_addr[0] = snrt_align_up_hyperbank((uintptr_t)snrt_l1_next_v2());
     if (largs->partition_banks) {
         // Each buffer is allocated in distinct TCDM banks. Particularly,
         // each buffer is assigned as many banks as there are compute cores.
         // Note: this assumes there are more than (banks_per_buffer * 3) banks.
-        b_addr[0] = a_addr[0] + SNRT_TCDM_BANK_WIDTH * banks_per_buffer;
-        c_addr[0] = b_addr[0] + SNRT_TCDM_BANK_WIDTH * banks_per_buffer;
+        snrt_l1_bank_group_t group;
+        snrt_l1_bank_group_begin(&group);
+        a_addr[0] =
+            snrt_l1_bank_group_alloc(&group, size_a, banks_per_buffer, 0);
+        b_addr[0] =
+            snrt_l1_bank_group_alloc(&group, size_b, banks_per_buffer, 0);
+        c_addr[0] =
+            snrt_l1_bank_group_alloc(&group, size_c, banks_per_buffer, 0);
 
         // If there are two hyperbanks, we allocate the second set of buffers
-        // in the second hyperbank, at the same offsets of the first set in
-        // in the first hyperbank.
-        if (SNRT_TCDM_HYPERBANK_NUM == 2) {
-            a_addr[1] = a_addr[0] + SNRT_TCDM_HYPERBANK_SIZE;
-            b_addr[1] = b_addr[0] + SNRT_TCDM_HYPERBANK_SIZE;
-            c_addr[1] = c_addr[0] + SNRT_TCDM_HYPERBANK_SIZE;
-        }
+        // in the second hyperbank, in the same banks as the first set.
         // If there is only one hyperbank, but we have enough banks to store the
         // second set of buffers also in distinct banks, then each buffer is
         // allocated in distinct banks.
-        else if (SNRT_TCDM_BANK_NUM >= (banks_per_buffer * 6)) {
-            a_addr[1] = c_addr[0] + SNRT_TCDM_BANK_WIDTH * banks_per_buffer;
-            b_addr[1] = a_addr[1] + SNRT_TCDM_BANK_WIDTH * banks_per_buffer;
-            c_addr[1] = b_addr[1] + SNRT_TCDM_BANK_WIDTH * banks_per_buffer;
-        }
         // In all other cases, each buffer in the second set is allocated in the
-        // same banks as the respective buffer in the first set.
-        else {
-            a_addr[1] = a_addr[0] + (SNRT_TCDM_HYPERBANK_WIDTH *
-                                     calculate_partitioned_banks_lines(
-                                         banks_per_buffer, size_a));
-            b_addr[1] = b_addr[0] + (SNRT_TCDM_HYPERBANK_WIDTH *
-                                     calculate_partitioned_banks_lines(
-                                         banks_per_buffer, size_b));
-            c_addr[1] = c_addr[0] + (SNRT_TCDM_HYPERBANK_WIDTH *
-                                     calculate_partitioned_banks_lines(
-                                         banks_per_buffer, size_c));
+        // same banks as the respective buffer in the first set, in the lines
+        // following the first set.
+        uint32_t hyperbank = SNRT_TCDM_HYPERBANK_NUM == 2;
+        if (!hyperbank && SNRT_TCDM_BANK_NUM < (banks_per_buffer * 6)) {
+            snrt_l1_bank_group_end(&group);
+            snrt_l1_bank_group_begin(&group);
         }
+        a_addr[1] = snrt_l1_bank_group_alloc(&group, size_a, banks_per_buffer,
+                                             hyperbank);
+        b_addr[1] = snrt_l1_bank_group_alloc(&group, size_b, banks_per_buffer,
+                                             hyperbank);
+        c_addr[1] = snrt_l1_bank_group_alloc(&group, size_c, banks_per_buffer,
+                                             hyperbank);
+        snrt_l1_bank_group_end(&group);
     } else {
-        b_addr[0] = snrt_align_up(a_addr[0] + size_a, sizeof(double));
-        c_addr[0] = snrt_align_up(b_addr[0] + size_b, sizeof(double));
-        a_addr[1] = snrt_align_up(c_addr[0] + size_c, sizeof(double));
-        b_addr[1] = snrt_align_up(a_addr[1] + size_a, sizeof(double));
-        c_addr[1] = snrt_align_up(b_addr[1] + size_b, sizeof(double));
+        // The second set of buffers is only allocated as needed, leaving more
+        // room for the tiles (see `gemm_plan_footprint()`)
+        a_addr[0] =
+            snrt_l1_alloc_cluster_local(size_a, SNRT_TCDM_HYPERBANK_WIDTH);
+        b_addr[0] = snrt_l1_alloc_cluster_local(size_b, sizeof(double));
+        c_addr[0] = snrt_l1_alloc_cluster_local(size_c, sizeof(double));
+        if (largs->double_buffer) {
+            a_addr[1] = snrt_l1_alloc_cluster_local(size_a, sizeof(double));
+            b_addr[1] = snrt_l1_alloc_cluster_local(size_b, sizeof(double));
+        }
+        if (largs->double_buffer || k_parallel)
+            c_addr[1] = snrt_l1_alloc_cluster_local(size_c, sizeof(double));
     }
 
     // Allocate
     if (largs->load_a) {
-        la[0] = (void *)a_addr[0];
-        if (largs->double_buffer) la[1] = (void *)a_addr[1];
+        la[0] = a_addr[0];
+        if (largs->double_buffer) la[1] = a_addr[1];
     } else
         la[0] = largs->a;
     if (largs->load_b) {
-        lb[0] = (void *)b_addr[0];
-        if (largs->double_buffer) lb[1] = (void *)b_addr[1];
+        lb[0] = b_addr[0];
+        if (largs->double_buffer) lb[1] = b_addr[1];
     } else
         lb[0] = largs->b;
+    // All C buffers are initialized, as they are switched among
+    // `num_c_buffers` also if C is not loaded. In that case, the only C tile
+    // resides in TCDM and every buffer refers to it.
     if (largs->load_c) {
-        lc[0] = (void *)c_addr[0];
-        if (largs->double_buffer) lc[1] = (void *)c_addr[1];
+        lc[0] = c_addr[0];
+        lc[1] = largs->double_buffer ? c_addr[1] : c_addr[0];
     } else
-        lc[0] = largs->c;
-    // Note: uses the second C buffer for the reduction phase. Double buffering
-    // is not supported when parallelizing K.
-    if (largs->parallelize_k) *lcr = (void *)c_addr[1];
+        lc[0] = lc[1] = largs->c;
+    lc[2] = lc[0];
+
+    // When parallelizing K, the partial C tiles of the other clusters are
+    // received in a scratch buffer. Without double buffering, the second C
+    // buffer is free for this purpose. With double buffering, the reduction
+    // of a C tile overlaps with the computation of the next tile, and is only
+    // written back in the following iteration, so a third C buffer is needed.
+    if (k_parallel && largs->double_buffer) {
+        if (largs->load_c)
+            lc[2] = snrt_l1_alloc_cluster_local(size_c, sizeof(double));
+        *lcr = snrt_l1_alloc_cluster_local(size_c, sizeof(double));
+    } else {
+        *lcr = c_addr[1];
+    }
 }
 
 // With the partitioned banks layout, the stride between rows of a matrix
@@ -171,21 +424,32 @@ static inline uint32_t calculate_partitioned_banks_stride(
  * @details
  * The function performs the following steps:
  * 1. Copies the input arguments to local memory for faster access.
- * 2. Calculates tile sizes based on the input dimensions and number of tiles.
+ * 2. Plans the tiling with `gemm_plan()`, if some number of tiles is zero,
+ *    and calculates tile sizes based on the input dimensions and number of
+ *    tiles. Dimensions which are not a multiple of the number of tiles end
+ *    with an edge tile, which is loaded, computed and stored in place of a
+ *    full tile.
  * 3. Allocates space in TCDM for local copies of matrix tiles, unless
  *    matrix tiles are already stored in TCDM (see `load_* arguments`).
- * 4. Distributes tiles to clusters for parallel processing.
+ * 4. Distributes tiles to clusters for parallel processing, according to
+ *    the position of each cluster in the cluster grid (see
+ *    `gemm_cluster_grid_t`).
  * 5. Iterates over the tiles, performing the following:
  *    - Copies data for the current tile into local memory.
  *    - Performs the tile computation using the `sc_st_gemm` function.
  *    - Performs a logarithmic reduction to combine partial results across
- *      clusters, if `parallelize_k` is enabled.
+ *      the clusters along the K dimension of the grid, if there are many.
  *    - Writes the result back to global memory.
  *
- * @note Current implementation assumes that `parallelize_m` and
- *       `parallelize_k` options are mutually exclusive.
+ * @return Non-zero if the cluster grid does not fit in the system, if no
+ *         tiling fits in the TCDM or if some tiles would be empty.
+ * @note The number of tiles in each dimension must be a multiple of the
+ *       respective dimension of the cluster grid. With `partition_banks`, the
+ *       dimensions must be multiples of the number of tiles.
  */
 static inline int gemm(const gemm_args_t *args) {
+    snrt_l1_mark_t l1_mark = snrt_l1_mark();
+
 #ifndef JOB_ARGS_PRELOADED
     // Copy the arguments to local memory
     gemm_args_t *largs = (gemm_args_t *)snrt_l1_alloc_cluster_local(
@@ -199,19 +463,58 @@ static inline int gemm(const gemm_args_t *args) {
     const gemm_args_t *largs = args;
 #endif
 
-    // Calculate tile sizes
-    uint32_t tile_m = largs->m / largs->m_tiles;
-    uint32_t tile_n = largs->n / largs->n_tiles;
-    uint32_t tile_k = largs->k / largs->k_tiles;
+    // Map the cluster onto the cluster grid
+    gemm_cluster_grid_t grid;
+    if (gemm_map_cluster(largs, &grid)) {
+        snrt_l1_release(l1_mark);
+        return 1;
+    }
+
+    // Plan the tiling, if not fully specified. The buffers are allocated from
+    // the next hyperbank-aligned address, and followed by the handshake state
+    // of the multicast operand loads.
+    gemm_args_t plan;
+    if (!largs->m_tiles || !largs->n_tiles || !largs->k_tiles) {
+        uint32_t budget = snrt_l1_available(SNRT_TCDM_HYPERBANK_WIDTH);
+        uint32_t reserved =
+            sizeof(gemm_mcast_state_t) + alignof(gemm_mcast_state_t);
+        budget = budget > reserved ? budget - reserved : 0;
+        plan = *largs;
+        if (gemm_plan(&plan, grid.m, grid.n, grid.k, budget)) {
+            snrt_l1_release(l1_mark);
+            return 1;
+        }
+        largs = &plan;
+    }
+    if (!gemm_valid_tiling(largs->m, largs->m_tiles) ||
+        !gemm_valid_tiling(largs->n, largs->n_tiles) ||
+        !gemm_valid_tiling(largs->k, largs->k_tiles)) {
+        snrt_l1_release(l1_mark);
+        return 1;
+    }
+
+    // Calculate tile sizes. The buffers are sized for full tiles, and also
+    // hold the edge tiles, with the same leading dimensions.
+    uint32_t tile_m = gemm_ceil_div(largs->m, largs->m_tiles);
+    uint32_t tile_n = gemm_ceil_div(largs->n, largs->n_tiles);
+    uint32_t tile_k = gemm_ceil_div(largs->k, largs->k_tiles);
+    uint32_t ragged = tile_m * largs->m_tiles != largs->m ||
+                      tile_n * largs->n_tiles != largs->n ||
+                      tile_k * largs->k_tiles != largs->k;
+    if (ragged && largs->partition_banks) {
+        snrt_l1_release(l1_mark);
+        return 1;
+    }
     uint32_t tile_a_size = tile_m * tile_k * largs->prec;
     uint32_t tile_b_size = tile_k * tile_n * largs->prec;
     uint32_t tile_c_size = tile_m * tile_n * largs->prec;
 
     // Allocate space for local tile buffers in TCDM, unless preloaded
     void *a0, *a1, *b0, *b1, *c0, *c1;
-    void *la[2], *lb[2], *lc[2], *lcr;
+    void *la[2], *lb[2], *lc[3], *lcr;
     int banks_per_buffer = snrt_cluster_compute_core_num();
-    allocate_buffers(tile_a_size, tile_b_size, tile_c_size, largs,
+    uint32_t k_parallel = grid.k > 1;
+    allocate_buffers(tile_a_size, tile_b_size, tile_c_size, largs, k_parallel,
                      banks_per_buffer, la, lb, lc, &lcr);
     if (snrt_cluster_core_idx() == 0) {
         DUMP(la[0]);
@@ -223,67 +526,92 @@ static inline int gemm(const gemm_args_t *args) {
     }
     snrt_cluster_hw_barrier();
 
-    // Distribute m and k tiles to clusters
-    uint32_t cluster_m_tiles = largs->m_tiles;
-    uint32_t cluster_k_tiles = largs->k_tiles;
-    if (largs->parallelize_m) cluster_m_tiles /= snrt_cluster_num();
-    if (largs->parallelize_k) cluster_k_tiles /= snrt_cluster_num();
+    // Allocate and reset the handshake state of the multicast operand loads.
+    // All clusters must have reset it before any cluster writes to it.
+    uint32_t multicast = grid.a_sharers.mcast_mask | grid.b_sharers.mcast_mask;
+    snrt_cluster_group_t all_clusters = snrt_cluster_group_all();
+    gemm_mcast_state_t *mcast_state = NULL;
+    if (multicast) {
+        mcast_state = (gemm_mcast_state_t *)snrt_l1_alloc_cluster_local(
+            sizeof(gemm_mcast_state_t), alignof(gemm_mcast_state_t));
+        if (snrt_is_dm_core()) {
+            snrt_dma_start_1d(mcast_state, snrt_zero_memory_ptr(),
+                              sizeof(gemm_mcast_state_t));
+            snrt_dma_wait_all();
+        }
+        snrt_cluster_group_barrier(&all_clusters);
+    }
+
+    // Distribute tiles to clusters
+    uint32_t cluster_m_tiles = largs->m_tiles / grid.m;
+    uint32_t cluster_n_tiles = largs->n_tiles / grid.n;
+    uint32_t cluster_k_tiles = largs->k_tiles / grid.k;
+
+    // With double buffering, the reduction of the C tiles along the K
+    // dimension of the grid is an additional pipeline stage: a C tile is
+    // reduced in the iteration after its computation, while the next tile is
+    // computed, and written back in the following iteration. C buffers are
+    // thus switched among three buffers.
+    uint32_t overlap_reduction = largs->double_buffer && k_parallel;
+    uint32_t num_c_buffers = 1;
+    if (largs->double_buffer) num_c_buffers = overlap_reduction ? 3 : 2;
 
     // Calculate number of iterations
-    uint32_t num_tiles = cluster_m_tiles * largs->n_tiles * cluster_k_tiles;
+    uint32_t num_tiles = cluster_m_tiles * cluster_n_tiles * cluster_k_tiles;
     uint32_t num_iters = num_tiles;
     if (largs->double_buffer)
         num_iters += 2;
     else
         num_iters += 1;
+    if (overlap_reduction) num_iters += 1;
 
     // Iterate over all tiles
     for (uint32_t i = 0; i < num_iters; i++) {
         // Calculate tile indices (we iterate in k->n->m order)
         int dma_in_i = i;
         int comp_i = largs->double_buffer ? i - 1 : i;
-        int dma_out_i = largs->double_buffer ? i - 2 : i - 1;
+        int red_i = overlap_reduction ? comp_i - 1 : comp_i;
+        int dma_out_i = red_i - 1;
         int dma_in_k = dma_in_i % cluster_k_tiles;
         int dma_in_mn = dma_in_i / cluster_k_tiles;
-        int dma_in_n = dma_in_mn % largs->n_tiles;
-        int dma_in_m = dma_in_mn / largs->n_tiles;
+        int dma_in_n = dma_in_mn % cluster_n_tiles;
+        int dma_in_m = dma_in_mn / cluster_n_tiles;
         int comp_k = comp_i % cluster_k_tiles;
         int comp_mn = comp_i / cluster_k_tiles;
-        int comp_n = comp_mn % largs->n_tiles;
-        int comp_m = comp_mn / largs->n_tiles;
+        int comp_n = comp_mn % cluster_n_tiles;
+        int comp_m = comp_mn / cluster_n_tiles;
+        int red_k = red_i % cluster_k_tiles;
+        int red_mn = red_i / cluster_k_tiles;
         int dma_out_k = dma_out_i % cluster_k_tiles;
         int dma_out_mn = dma_out_i / cluster_k_tiles;
-        int dma_out_n = dma_out_mn % largs->n_tiles;
-        int dma_out_m = dma_out_mn / largs->n_tiles;
-
-        // If m and k tiles are parallelized across clusters,
-        // calculate the absolute m and k indices for each cluster
-        int dma_in_m_abs = dma_in_m;
-        int comp_m_abs = comp_m;
-        int dma_out_m_abs = dma_out_m;
-        int dma_in_k_abs = dma_in_k;
-        int comp_k_abs = comp_k;
-        int dma_out_k_abs = dma_out_k;
-        if (largs->parallelize_m) {
-            dma_in_m_abs += snrt_cluster_idx() * cluster_m_tiles;
-            comp_m_abs += snrt_cluster_idx() * cluster_m_tiles;
-            dma_out_m_abs += snrt_cluster_idx() * cluster_m_tiles;
-        }
-        if (largs->parallelize_k) {
-            dma_in_k_abs += snrt_cluster_idx() * cluster_k_tiles;
-            comp_k_abs += snrt_cluster_idx() * cluster_k_tiles;
-            dma_out_k_abs += snrt_cluster_idx() * cluster_k_tiles;
-        }
+        int dma_out_n = dma_out_mn % cluster_n_tiles;
+        int dma_out_m = dma_out_mn / cluster_n_tiles;
+
+        // Calculate the absolute m, n and k indices from the position of the
+        // cluster in the grid
+        int dma_in_m_abs = dma_in_m + grid.pm * cluster_m_tiles;
+        int dma_out_m_abs = dma_out_m + grid.pm * cluster_m_tiles;
+        int dma_in_n_abs = dma_in_n + grid.pn * cluster_n_tiles;
+        int dma_out_n_abs = dma_out_n + grid.pn * cluster_n_tiles;
+        int dma_in_k_abs = dma_in_k + grid.pk * cluster_k_tiles;
+        int comp_m_abs = comp_m + grid.pm * cluster_m_tiles;
+        int comp_n_abs = comp_n + grid.pn * cluster_n_tiles;
+        int comp_k_abs = comp_k + grid.pk * cluster_k_tiles;
+
+        // Reduce the C tile once it is fully accumulated
+        int reduce = k_parallel && red_i >= 0 && red_i < num_tiles &&
+                     red_k == (cluster_k_tiles - 1);
 
         // DMA out phase
-        if (snrt_is_dm_core()) {
-            if (dma_out_i >= 0) {
+        if (snrt_is_dm_core() && grid.active) {
+            if (dma_out_i >= 0 && dma_out_k == (cluster_k_tiles - 1)) {
                 // Switch buffers
-                int buff_idx = largs->double_buffer ? dma_out_mn % 2 : 0;
+                int buff_idx = dma_out_mn % num_c_buffers;
 
                 // Store C
-                // If parallelize_k, then only cluster 0 must writeback
-                if ((snrt_cluster_idx() == 0) || !(largs->parallelize_k)) {
+                // Only the first cluster along the K dimension holds the
+                // reduced result and must writeback
+                if (grid.pk == 0) {
                     if (largs->partition_banks) {
                         snrt_dma_2d_to_1d(
                             (void *)((uintptr_t)largs->c +
@@ -292,9 +620,10 @@ static inline int gemm(const gemm_args_t *args) {
                             banks_per_buffer * SNRT_TCDM_BANK_WIDTH,
                             SNRT_TCDM_HYPERBANK_WIDTH);
                     } else {
-                        snrt_dma_store_2d_tile(largs->c, lc[buff_idx],
-                                               dma_out_m_abs, dma_out_n, tile_m,
-                                               tile_n, largs->ldc, largs->prec);
+                        snrt_dma_store_2d_edge_tile(
+                            largs->c, lc[buff_idx], dma_out_m_abs,
+                            dma_out_n_abs, tile_m, tile_n, largs->m, largs->n,
+                            largs->ldc, largs->prec);
                     }
                     snrt_dma_wait_all();
                 }
@@ -302,52 +631,90 @@ static inline int gemm(const gemm_args_t *args) {
         }
 
         // DMA in phase
-        if (snrt_is_dm_core()) {
+        if (snrt_is_dm_core() && grid.active) {
             if (dma_in_i < num_tiles) {
                 // Switch buffers
                 // A and B buffers are switched every iteration, while the C
                 // buffer only needs to be switched after fully accumulating
                 // the result, i.e. after finishing the K loop.
                 int buff_idx = largs->double_buffer ? dma_in_i % 2 : 0;
-                int c_buff_idx = largs->double_buffer ? dma_in_mn % 2 : 0;
+                int c_buff_idx = dma_in_mn % num_c_buffers;
+
+                // Operand tiles shared by multiple clusters are only loaded by
+                // the first of them, once all of them freed the respective
+                // buffer, and multicast to all of them
+                uint32_t seq = dma_in_i + 1;
+                uint32_t mcast_a =
+                    largs->load_a ? grid.a_sharers.mcast_mask : 0;
+                uint32_t mcast_b =
+                    largs->load_b ? grid.b_sharers.mcast_mask : 0;
+                uint32_t loader_a = !mcast_a || grid.a_sharers.rank == 0;
+                uint32_t loader_b = !mcast_b || grid.b_sharers.rank == 0;
+                if (!loader_a)
+                    gemm_mcast_release_buffer(mcast_state, GEMM_OPERAND_A,
+                                              &grid.a_sharers, seq);
+                if (!loader_b)
+                    gemm_mcast_release_buffer(mcast_state, GEMM_OPERAND_B,
+                                              &grid.b_sharers, seq);
+                if (mcast_a && loader_a)
+                    gemm_mcast_wait_buffers(mcast_state, GEMM_OPERAND_A,
+                                            &grid.a_sharers, seq);
+                if (mcast_b && loader_b)
+                    gemm_mcast_wait_buffers(mcast_state, GEMM_OPERAND_B,
+                                            &grid.b_sharers, seq);
 
                 // Load A
-                if (largs->load_a) {
+                if (largs->load_a && loader_a) {
+                    void *a_dst = mcast_a
+                                      ? gemm_mcast_dst(la[buff_idx],
+                                                       &grid.a_sharers)
+                                      : la[buff_idx];
+                    void *a_src = (void *)((uintptr_t)largs->a +
+                                           dma_in_m_abs * tile_a_size);
                     if (largs->partition_banks) {
-                        snrt_dma_1d_to_2d(
-                            la[buff_idx],
-                            (void *)((uintptr_t)largs->a +
-                                     dma_in_m_abs * tile_a_size),
-                            tile_a_size,
+                        snrt_dma_start_2d_mcast(
+                            (uint64_t)a_dst, (uint64_t)a_src,
                             banks_per_buffer * SNRT_TCDM_BANK_WIDTH,
-                            SNRT_TCDM_HYPERBANK_WIDTH);
+                            SNRT_TCDM_HYPERBANK_WIDTH,
+                            banks_per_buffer * SNRT_TCDM_BANK_WIDTH,
+                            tile_a_size /
+                                (banks_per_buffer * SNRT_TCDM_BANK_WIDTH),
+                            mcast_a);
                     } else {
-                        snrt_dma_load_2d_tile(
-                            la[buff_idx], largs->a, dma_in_m_abs, dma_in_k_abs,
-                            tile_m, tile_k, largs->lda, largs->prec);
+                        snrt_dma_load_2d_edge_tile(
+                            a_dst, largs->a, dma_in_m_abs, dma_in_k_abs,
+                            tile_m, tile_k, largs->m, largs->k, largs->lda,
+                            largs->prec, mcast_a);
                     }
                 }
 
                 // Load B
-                if (largs->load_b) {
+                if (largs->load_b && loader_b) {
+                    void *b_dst = mcast_b
+                                      ? gemm_mcast_dst(lb[buff_idx],
+                                                       &grid.b_sharers)
+                                      : lb[buff_idx];
+                    void *b_src = (void *)((uintptr_t)largs->b +
+                                           dma_in_k_abs * tile_b_size);
                     if (largs->transb) {
-                        snrt_dma_load_2d_tile(lb[buff_idx], largs->b, dma_in_n,
-                                              dma_in_k_abs, tile_n, tile_k,
-                                              largs->ldb, largs->prec);
+                        snrt_dma_load_2d_edge_tile(
+                            b_dst, largs->b, dma_in_n_abs, dma_in_k_abs,
+                            tile_n, tile_k, largs->n, largs->k, largs->ldb,
+                            largs->prec, mcast_b);
+                    } else if (largs->partition_banks) {
+                        snrt_dma_start_2d_mcast(
+                            (uint64_t)b_dst, (uint64_t)b_src,
+                            banks_per_buffer * SNRT_TCDM_BANK_WIDTH,
+                            SNRT_TCDM_HYPERBANK_WIDTH,
+                            banks_per_buffer * SNRT_TCDM_BANK_WIDTH,
+                            tile_b_size /
+                                (banks_per_buffer * SNRT_TCDM_BANK_WIDTH),
+                            mcast_b);
                     } else {
-                        if (largs->partition_banks) {
-                            snrt_dma_1d_to_2d(
-                                lb[buff_idx],
-                                (void *)((uintptr_t)largs->b +
-                                         dma_in_k_abs * tile_b_size),
-                                tile_b_size,
-                                banks_per_buffer * SNRT_TCDM_BANK_WIDTH,
-                                SNRT_TCDM_HYPERBANK_WIDTH);
-                        } else {
-                            snrt_dma_load_2d_tile(
-                                lb[buff_idx], largs->b, dma_in_k_abs, dma_in_n,
-                                tile_k, tile_n, largs->ldb, largs->prec);
-                        }
+                        snrt_dma_load_2d_edge_tile(
+                            b_dst, largs->b, dma_in_k_abs, dma_in_n_abs,
+                            tile_k, tile_n, largs->k, largs->n, largs->ldb,
+                            largs->prec, mcast_b);
                     }
                 }
 
@@ -366,10 +733,10 @@ static inline int gemm(const gemm_args_t *args) {
                                 banks_per_buffer * SNRT_TCDM_BANK_WIDTH,
                                 SNRT_TCDM_HYPERBANK_WIDTH);
                         } else {
-                            snrt_dma_load_2d_tile(lc[c_buff_idx], largs->c,
-                                                  dma_in_m_abs, dma_in_n,
-                                                  tile_m, tile_n, largs->ldc,
-                                                  largs->prec);
+                            snrt_dma_load_2d_edge_tile(
+                                lc[c_buff_idx], largs->c, dma_in_m_abs,
+                                dma_in_n_abs, tile_m, tile_n, largs->m,
+                                largs->n, largs->ldc, largs->prec, 0);
                         }
                     } else if (dma_in_k == 0) {
                         // Clusters other than the first need to initialize
@@ -388,9 +755,31 @@ static inline int gemm(const gemm_args_t *args) {
                     }
                 }
                 snrt_dma_wait_all();
+
+                // Hand over the shared tiles
+                if (mcast_a && loader_a)
+                    gemm_mcast_signal_ready(mcast_state, GEMM_OPERAND_A,
+                                            &grid.a_sharers, seq);
+                if (mcast_b && loader_b)
+                    gemm_mcast_signal_ready(mcast_state, GEMM_OPERAND_B,
+                                            &grid.b_sharers, seq);
+                if (!loader_a)
+                    gemm_mcast_wait_ready(mcast_state, GEMM_OPERAND_A, seq);
+                if (!loader_b)
+                    gemm_mcast_wait_ready(mcast_state, GEMM_OPERAND_B, seq);
             }
         }
 
+        // When overlapping the reduction, the DM core takes part in it as soon
+        // as its transfers for this iteration are done, while the compute
+        // cores compute the next tile. The partial C tiles of the clusters
+        // which do not receive from any other are thus sent during the
+        // computation.
+        if (reduce && overlap_reduction && snrt_is_dm_core()) {
+            gemm_reduce_c_tile(lcr, lc[red_mn % num_c_buffers],
+                               tile_m * tile_n, largs->prec, &grid.k_group);
+        }
+
         // Additional barrier required when not double buffering
         if (!largs->double_buffer) snrt_cluster_hw_barrier();
 
@@ -398,10 +787,10 @@ static inline int gemm(const gemm_args_t *args) {
         if (comp_i >= 0 && comp_i < num_tiles) {
             // Switch buffers
             int buff_idx = largs->double_buffer ? comp_i % 2 : 0;
-            int c_buff_idx = largs->double_buffer ? comp_mn % 2 : 0;
+            int c_buff_idx = comp_mn % num_c_buffers;
 
             // Only compute cores participate in the tile computation
-            if (!snrt_is_dm_core()) {
+            if (!snrt_is_dm_core() && grid.active) {
                 // uint32_t start_cycle = snrt_mcycle();
 
                 // In the first k iteration we accumulate with the C matrix
@@ -411,9 +800,11 @@ static inline int gemm(const gemm_args_t *args) {
                 uint32_t beta_k = comp_k_abs == 0 ? largs->beta : 1;
 
                 // Tile computation
+                // The SSRs must be reconfigured for every tile if the tiles
+                // are not all of the same size
                 sc_st_gemm_args_t sc_st_args;
                 sc_st_args.prec = largs->prec;
-                sc_st_args.setup_ssr = largs->setup_ssr;
+                sc_st_args.setup_ssr = largs->setup_ssr || ragged;
                 sc_st_args.partition_banks = largs->partition_banks;
                 sc_st_args.transa = largs->transa;
                 sc_st_args.transb = largs->transb;
@@ -443,26 +834,43 @@ static inline int gemm(const gemm_args_t *args) {
                 } else {
                     sc_st_args.ldc = tile_n;
                 }
-                sc_st_args.m = tile_m;
-                sc_st_args.n = tile_n;
-                sc_st_args.k = tile_k;
+                sc_st_args.m = snrt_tile_extent(comp_m_abs, tile_m, largs->m);
+                sc_st_args.n = snrt_tile_extent(comp_n_abs, tile_n, largs->n);
+                sc_st_args.k = snrt_tile_extent(comp_k_abs, tile_k, largs->k);
                 sc_st_gemm(largs->gemm_fp, &sc_st_args);
 
                 // uint32_t end_cycle = snrt_mcycle();
             }
+        }
 
-            // Add the partial result tiles from the various clusters together
-            // in a logarithmic reduction fashion.
-            // Note: both compute and DMA cores participate in this step.
-            if (largs->parallelize_k && (comp_k == (cluster_k_tiles - 1))) {
-                snrt_global_reduction_dma(
-                    (double *)lcr, (double *)lc[c_buff_idx], tile_m * tile_n);
-            }
+        // Reduction phase
+        // Add the partial result tiles from the clusters along the K
+        // dimension together in a logarithmic reduction fashion.
+        // Note: both compute and DMA cores of all clusters participate in
+        // this step, as the clusters along the K dimension of distinct grid
+        // positions reduce concurrently. Without double buffering, the tile
+        // was computed in this same iteration, and all cores must be done
+        // with it before the DM core starts sending it.
+        if (reduce && !(overlap_reduction && snrt_is_dm_core())) {
+            if (!overlap_reduction) snrt_cluster_hw_barrier();
+            gemm_reduce_c_tile(lcr, lc[red_mn % num_c_buffers],
+                               tile_m * tile_n, largs->prec, &grid.k_group);
         }
 
         // Synchronize cores after every iteration
         snrt_cluster_hw_barrier();
     }
 
+    // All multicast interrupts must have been delivered and cleared before
+    // leaving, or they would wake up the DM cores from their next WFI, e.g. in
+    // snrt_inter_cluster_barrier
+    if (multicast) {
+        if (snrt_is_dm_core()) __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        snrt_cluster_group_barrier(&all_clusters);
+        if (snrt_is_dm_core()) snrt_int_clr_mcip();
+    }
+
+    // Free the local copies of the arguments and the tile buffers
+    snrt_l1_release(l1_mark);
     return 0;
 }
@@ -0,0 +1,379 @@
+// Copyright 2025 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file
+ * @brief Tiling planner of the multi-cluster GEMM.
+ *
+ * Chooses the number of tiles along every dimension of the problem, whether
+ * to double buffer the tiles and whether to partition the TCDM banks among
+ * the tile buffers, so as to maximize the utilization of the FPUs. Since the
+ * number of floating-point operations is fixed by the problem, this amounts
+ * to minimizing the runtime, which is estimated with a simple model of the
+ * kernels and of the DMA transfers. Only tilings whose buffers fit in the
+ * TCDM are considered.
+ *
+ * Tiles have `ceil(size / tiles)` elements along every dimension, so that the
+ * problem dimensions need not be multiples of the number of tiles. The last
+ * tile along a dimension is then an edge tile, cut short by the end of the
+ * matrices.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+// Number of C columns the optimized kernels compute at once. The columns of a
+// tile in excess of a multiple of this are computed by the naive kernels.
+#define GEMM_UNROLL 8
+
+// Cost model of the planner, in cycles
+// Overhead of an optimized kernel per block of GEMM_UNROLL C elements
+#define GEMM_PLAN_BLOCK_OVERHEAD 16
+// Multiply-accumulate in a naive kernel
+#define GEMM_PLAN_NAIVE_MAC_CYCLES 6
+// Overhead per tile, for the kernel setup and the synchronization
+#define GEMM_PLAN_TILE_OVERHEAD 200
+// Overhead per DMA transfer
+#define GEMM_PLAN_DMA_LATENCY 50
+
+// Number of K tilings evaluated, from the fewest K tiles which fit in the
+// TCDM, to trade tile size for overlap of the transfers with double buffering
+#define GEMM_PLAN_K_CANDIDATES 3
+
+static inline uint32_t gemm_ceil_div(uint32_t a, uint32_t b) {
+    return (a + b - 1) / b;
+}
+
+// Elements of a 64-bit SIMD word of the kernels of the given precision
+static inline uint32_t gemm_simd_lanes(uint32_t prec) {
+    return sizeof(double) / prec;
+}
+
+/**
+ * @brief Check whether the optimized kernels support a tile with the given K
+ *        dimension. It must be a multiple of the SIMD width, and span enough
+ *        SIMD words for the FREP loops of the kernels. Other tiles are
+ *        computed by the naive kernels.
+ */
+static inline int gemm_opt_kernel_supports_k(uint32_t k, uint32_t prec) {
+    uint32_t lanes = gemm_simd_lanes(prec);
+    uint32_t min_words = prec == FP64 ? 3 : (prec == FP32 ? 2 : 1);
+    return (k % lanes) == 0 && (k / lanes) >= min_words;
+}
+
+/**
+ * @brief Check that `tiles` tiles of `ceil(size / tiles)` elements partition
+ *        a dimension of `size` elements, i.e. that none of them is empty.
+ */
+static inline int gemm_valid_tiling(uint32_t size, uint32_t tiles) {
+    return tiles && tiles <= size &&
+           gemm_ceil_div(size, tiles) * (tiles - 1) < size;
+}
+
+// TCDM footprint of the tile buffers, as allocated by `allocate_buffers()`
+static inline uint32_t gemm_plan_footprint(const gemm_args_t *args,
+                                           uint32_t tile_m, uint32_t tile_n,
+                                           uint32_t tile_k, uint32_t k_parallel,
+                                           uint32_t double_buffer,
+                                           uint32_t partition_banks) {
+    uint32_t size_a = tile_m * tile_k * args->prec;
+    uint32_t size_b = tile_k * tile_n * args->prec;
+    uint32_t size_c = tile_m * tile_n * args->prec;
+    size_a = gemm_ceil_div(size_a, sizeof(double)) * sizeof(double);
+    size_b = gemm_ceil_div(size_b, sizeof(double)) * sizeof(double);
+    size_c = gemm_ceil_div(size_c, sizeof(double)) * sizeof(double);
+
+    // Reduction buffers, and third C buffer
+    uint32_t extra_c = 0;
+    if (k_parallel && double_buffer) extra_c = args->load_c ? 2 : 1;
+
+    if (partition_banks) {
+        uint32_t banks_per_buffer = snrt_cluster_compute_core_num();
+        uint32_t row_size = banks_per_buffer * SNRT_TCDM_BANK_WIDTH;
+        uint32_t size = size_a > size_b ? size_a : size_b;
+        if (size_c > size) size = size_c;
+        uint32_t lines = gemm_ceil_div(size, row_size);
+        uint32_t groups = 1;
+        if (SNRT_TCDM_HYPERBANK_NUM == 1 &&
+            SNRT_TCDM_BANK_NUM < (banks_per_buffer * 6))
+            groups = 2;
+        return groups * lines * SNRT_TCDM_HYPERBANK_WIDTH *
+                   SNRT_TCDM_HYPERBANK_NUM +
+               extra_c * size_c;
+    }
+
+    uint32_t ab_buffers = double_buffer ? 2 : 1;
+    uint32_t c_buffers = 1 + extra_c;
+    if (double_buffer || k_parallel) c_buffers++;
+    return ab_buffers * (size_a + size_b) + c_buffers * size_c;
+}
+
+// Check whether the banks can be partitioned among the tile buffers: the
+// tiles must be contiguous blocks of the matrices, i.e. only M may be tiled,
+// and all of the same size. See the `partition_banks` argument of `gemm()`.
+static inline int gemm_plan_can_partition_banks(const gemm_args_t *args,
+                                                uint32_t m_tiles,
+                                                uint32_t n_tiles,
+                                                uint32_t k_tiles) {
+    uint32_t banks_per_buffer = snrt_cluster_compute_core_num();
+    uint32_t elems_per_line =
+        (banks_per_buffer * SNRT_TCDM_BANK_WIDTH) / args->prec;
+    return args->prec == FP64 && !args->transa && !args->transb &&
+           n_tiles == 1 && k_tiles == 1 && (args->m % m_tiles) == 0 &&
+           (args->n % elems_per_line) == 0 &&
+           (args->k % elems_per_line) == 0 && elems_per_line == GEMM_UNROLL &&
+           (banks_per_buffer * 3) <= SNRT_TCDM_BANK_PER_HYPERBANK_NUM;
+}
+
+// Cycles for the compute cores to compute a tile
+static inline uint32_t gemm_plan_compute_cycles(uint32_t m, uint32_t n,
+                                                uint32_t k, uint32_t prec) {
+    uint32_t rows = gemm_ceil_div(m, snrt_cluster_compute_core_num());
+    uint32_t blocks = n / GEMM_UNROLL;
+    uint32_t naive_cols = n % GEMM_UNROLL;
+    if (!gemm_opt_kernel_supports_k(k, prec)) {
+        blocks = 0;
+        naive_cols = n;
+    }
+    uint32_t words = k / gemm_simd_lanes(prec);
+    uint32_t cycles = blocks * (GEMM_UNROLL * words + GEMM_PLAN_BLOCK_OVERHEAD);
+    cycles += naive_cols * k * GEMM_PLAN_NAIVE_MAC_CYCLES;
+    return rows * cycles + GEMM_PLAN_TILE_OVERHEAD;
+}
+
+// Cycles for the DMA to transfer `rows` rows of `row_size` bytes
+static inline uint32_t gemm_plan_dma_cycles(uint32_t rows, uint32_t row_size) {
+    return GEMM_PLAN_DMA_LATENCY +
+           rows * gemm_ceil_div(row_size, SNRT_DMA_BEAT_SIZE);
+}
+
+/**
+ * @brief Tiles computed by a cluster along one dimension of the problem:
+ *        `num[0]` full tiles of `size[0]` elements and `num[1]` edge tiles of
+ *        `size[1]` elements.
+ */
+typedef struct {
+    uint32_t size[2];
+    uint32_t num[2];
+} gemm_plan_dim_t;
+
+// Tiles of the first and of the last cluster along a dimension of `size`
+// elements, split in `tiles` tiles among `grid` clusters. Only the last
+// cluster computes the edge tile.
+static inline void gemm_plan_dims(uint32_t size, uint32_t tiles, uint32_t grid,
+                                  gemm_plan_dim_t *first,
+                                  gemm_plan_dim_t *last) {
+    uint32_t tile = gemm_ceil_div(size, tiles);
+    first->size[0] = last->size[0] = tile;
+    first->size[1] = last->size[1] = size - (tiles - 1) * tile;
+    first->num[0] = tiles / grid;
+    first->num[1] = 0;
+    last->num[0] = tiles / grid - 1;
+    last->num[1] = 1;
+}
+
+// Estimated cycles for a cluster to compute its tiles
+static inline uint64_t gemm_plan_cluster_cycles(
+    const gemm_args_t *args, const gemm_plan_dim_t *dm,
+    const gemm_plan_dim_t *dn, const gemm_plan_dim_t *dk, uint32_t grid_k,
+    uint32_t double_buffer, uint32_t partition_banks) {
+    uint32_t prec = args->prec;
+    uint32_t k_tiles = dk->num[0] + dk->num[1];
+    uint64_t cycles = 0;
+    for (uint32_t i = 0; i < 2; i++) {
+        for (uint32_t j = 0; j < 2; j++) {
+            uint32_t m = dm->size[i], n = dn->size[j];
+            uint32_t num_mn = dm->num[i] * dn->num[j];
+            if (!num_mn) continue;
+
+            // C tiles are loaded in the first and stored in the last K
+            // iteration, and reduced along the K dimension of the grid
+            uint32_t dma_c = gemm_plan_dma_cycles(m, n * prec);
+            if (args->load_c) dma_c *= 2;
+            // Without double buffering, the transfers of the reduction do
+            // not overlap with the computation
+            uint32_t reduction = 0;
+            for (uint32_t level = 1; level < grid_k; level *= 2) {
+                reduction +=
+                    gemm_ceil_div(m * n, snrt_cluster_compute_core_num());
+                if (!double_buffer)
+                    reduction += gemm_plan_dma_cycles(1, m * n * prec);
+            }
+            cycles += (uint64_t)num_mn * reduction;
+
+            for (uint32_t l = 0; l < 2; l++) {
+                uint32_t k = dk->size[l];
+                uint32_t num = num_mn * dk->num[l];
+                if (!num) continue;
+                uint32_t compute = gemm_plan_compute_cycles(m, n, k, prec);
+                uint32_t dma = dma_c / k_tiles;
+                if (args->load_a)
+                    dma += gemm_plan_dma_cycles(m, k * prec);
+                if (args->load_b) {
+                    if (args->transb)
+                        dma += gemm_plan_dma_cycles(n, k * prec);
+                    else
+                        dma += gemm_plan_dma_cycles(k, n * prec);
+                }
+                // While the DMA overlaps with the computation, every beat it
+                // transfers occupies some banks, which stalls the compute
+                // cores accessing them, unless the banks are partitioned
+                if (double_buffer && !partition_banks)
+                    compute += dma * SNRT_DMA_BEAT_SIZE /
+                               (SNRT_TCDM_BANK_WIDTH * SNRT_TCDM_BANK_NUM);
+                if (double_buffer)
+                    cycles += (uint64_t)num * (compute > dma ? compute : dma);
+                else
+                    cycles += (uint64_t)num * (compute + dma);
+            }
+        }
+    }
+    // Pipeline fill and drain with double buffering
+    if (double_buffer)
+        cycles += gemm_plan_compute_cycles(dm->size[0], dn->size[0],
+                                           dk->size[0], prec);
+    return cycles;
+}
+
+// Estimated runtime of a tiling, i.e. of the slowest of the first and the
+// last cluster along every dimension of the grid
+static inline uint64_t gemm_plan_cycles(const gemm_args_t *args,
+                                        uint32_t m_tiles, uint32_t n_tiles,
+                                        uint32_t k_tiles, uint32_t grid_m,
+                                        uint32_t grid_n, uint32_t grid_k,
+                                        uint32_t double_buffer,
+                                        uint32_t partition_banks) {
+    gemm_plan_dim_t dm[2], dn[2], dk[2];
+    gemm_plan_dims(args->m, m_tiles, grid_m, &dm[0], &dm[1]);
+    gemm_plan_dims(args->n, n_tiles, grid_n, &dn[0], &dn[1]);
+    gemm_plan_dims(args->k, k_tiles, grid_k, &dk[0], &dk[1]);
+    uint64_t first = gemm_plan_cluster_cycles(args, &dm[0], &dn[0], &dk[0],
+                                              grid_k, double_buffer,
+                                              partition_banks);
+    uint64_t last = gemm_plan_cluster_cycles(args, &dm[1], &dn[1], &dk[1],
+                                             grid_k, double_buffer,
+                                             partition_banks);
+    return first > last ? first : last;
+}
+
+// Next number of tiles to consider along a dimension. The number grows
+// geometrically, to bound the number of tilings the planner evaluates.
+static inline uint32_t gemm_plan_next_tiles(uint32_t tiles, uint32_t grid) {
+    uint32_t next = gemm_ceil_div(tiles * 3 / 2, grid) * grid;
+    return next > tiles ? next : tiles + grid;
+}
+
+/**
+ * @brief Choose the tiling of a GEMM problem.
+ *
+ * Every number of tiles which is zero in @p args is chosen by the planner,
+ * while the others are retained. The planner further chooses whether to
+ * double buffer the tiles and to partition the TCDM banks among the tile
+ * buffers, overriding `double_buffer` and `partition_banks`.
+ *
+ * The number of tiles along every dimension is a multiple of the respective
+ * dimension of the cluster grid. Operands which are not loaded by `gemm()`
+ * (see `load_a`, `load_b` and `load_c`) cannot be tiled.
+ *
+ * @param args Arguments of the GEMM, updated with the chosen tiling.
+ * @param grid_m M dimension of the cluster grid.
+ * @param grid_n N dimension of the cluster grid.
+ * @param grid_k K dimension of the cluster grid.
+ * @param budget Bytes of TCDM available for the tile buffers.
+ * @return Non-zero if no tiling fits in the budget.
+ */
+static inline int gemm_plan(gemm_args_t *args, uint32_t grid_m,
+                            uint32_t grid_n, uint32_t grid_k,
+                            uint32_t budget) {
+    uint32_t cores = snrt_cluster_compute_core_num();
+    uint32_t k_parallel = grid_k > 1;
+
+    // Range of the number of tiles along every dimension. Tiles are not made
+    // smaller than needed to keep all cores busy, or to fill the unrolled
+    // loops of the kernels.
+    uint32_t min_m = args->m_tiles ? args->m_tiles : grid_m;
+    uint32_t min_n = args->n_tiles ? args->n_tiles : grid_n;
+    uint32_t min_k = args->k_tiles ? args->k_tiles : grid_k;
+    uint32_t max_m = args->m_tiles ? args->m_tiles : args->m;
+    uint32_t max_n = args->n_tiles ? args->n_tiles : args->n;
+    uint32_t max_k = args->k_tiles ? args->k_tiles : args->k;
+    if (!args->m_tiles && args->m >= cores * grid_m)
+        max_m = args->m / cores;
+    if (!args->n_tiles && args->n >= GEMM_UNROLL * grid_n)
+        max_n = args->n / GEMM_UNROLL;
+    if (!args->load_a || !args->load_c) max_m = min_m;
+    if (!args->load_b || !args->load_c) max_n = min_n;
+    if (!args->load_a || !args->load_b) max_k = min_k;
+
+    uint64_t best = UINT64_MAX;
+    uint32_t best_tiles[3] = {0, 0, 0};
+    uint32_t best_double_buffer = 0, best_partition_banks = 0;
+    for (uint32_t db = 0; db < 2; db++) {
+        for (uint32_t pb = 0; pb < 2; pb++) {
+            if (pb && !gemm_plan_can_partition_banks(args, min_m, min_n, min_k))
+                continue;
+            for (uint32_t mt = min_m; mt <= max_m;
+                 mt = gemm_plan_next_tiles(mt, grid_m)) {
+                if (!gemm_valid_tiling(args->m, mt)) continue;
+                uint32_t tile_m = gemm_ceil_div(args->m, mt);
+                uint32_t whole_nk_fits = 0;
+                for (uint32_t nt = min_n; nt <= max_n;
+                     nt = gemm_plan_next_tiles(nt, grid_n)) {
+                    if (!gemm_valid_tiling(args->n, nt)) continue;
+                    uint32_t tile_n = gemm_ceil_div(args->n, nt);
+
+                    // Find the fewest K tiles which fit in the TCDM
+                    uint32_t kt = min_k;
+                    uint32_t fits = 0;
+                    for (; kt <= max_k; kt = gemm_plan_next_tiles(kt, grid_k)) {
+                        uint32_t tile_k = gemm_ceil_div(args->k, kt);
+                        fits = gemm_plan_footprint(args, tile_m, tile_n,
+                                                   tile_k, k_parallel, db,
+                                                   pb) <= budget;
+                        if (fits) break;
+                    }
+                    if (!fits) continue;
+                    uint32_t whole_k_fits = kt == min_k;
+                    if (whole_k_fits && nt == min_n) whole_nk_fits = 1;
+
+                    // Evaluate it and the next few K tilings, which overlap
+                    // more of the transfers with double buffering
+                    uint32_t candidates = 0;
+                    for (; candidates < GEMM_PLAN_K_CANDIDATES && kt <= max_k;
+                         kt += grid_k) {
+                        if (!gemm_valid_tiling(args->k, kt)) continue;
+                        candidates++;
+                        if (pb &&
+                            !gemm_plan_can_partition_banks(args, mt, nt, kt))
+                            continue;
+                        uint64_t cycles = gemm_plan_cycles(
+                            args, mt, nt, kt, grid_m, grid_n, grid_k, db, pb);
+                        if (cycles < best) {
+                            best = cycles;
+                            best_tiles[0] = mt;
+                            best_tiles[1] = nt;
+                            best_tiles[2] = kt;
+                            best_double_buffer = db;
+                            best_partition_banks = pb;
+                        }
+                    }
+
+                    // Splitting N further would only make the tiles smaller
+                    if (whole_k_fits) break;
+                }
+                // Likewise for M, once a tile fits all of N and K
+                if (whole_nk_fits) break;
+            }
+        }
+    }
+    if (best == UINT64_MAX) return 1;
+
+    args->m_tiles = best_tiles[0];
+    args->n_tiles = best_tiles[1];
+    args->k_tiles = best_tiles[2];
+    args->double_buffer = best_double_buffer;
+    args->partition_banks = best_partition_banks;
+    return 0;
+}
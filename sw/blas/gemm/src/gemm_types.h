@@ -24,23 +24,52 @@ typedef void (*gemm_fp_t)(uint32_t setup_ssr, uint32_t partition_banks,
  *
  * @var gemm_args_t::m_tiles
  * Partition the problem into the specified number of tiles along the M
- * dimension.
+ * dimension. The M dimension need not be a multiple of it: tiles have
+ * `ceil(m / m_tiles)` elements, except for the last one,
+ * which is cut short. If zero, it is chosen by `gemm_plan()`.
  *
  * @var gemm_args_t::n_tiles
  * Partition the problem into the specified number of tiles along the N
- * dimension.
+ * dimension. The N dimension need not be a multiple of it: tiles have
+ * `ceil(n / n_tiles)` elements, except for the last one,
+ * which is cut short. If zero, it is chosen by `gemm_plan()`.
  *
  * @var gemm_args_t::k_tiles
  * Partition the problem into the specified number of tiles along the K
- * dimension.
+ * dimension. The K dimension need not be a multiple of it: tiles have
+ * `ceil(k / k_tiles)` elements, except for the last one,
+ * which is cut short. If zero, it is chosen by `gemm_plan()`.
  *
  * @var gemm_args_t::parallelize_m
- * If set, distributes tiles on the M dimension to different clusters.
+ * If set, distributes tiles on the M dimension to all clusters. Shorthand for
+ * setting `m_clusters` to the number of clusters.
  *
  * @var gemm_args_t::parallelize_k
- * If set, distributes tiles on the K dimension to different clusters.
- * The `snrt_global_reduction_dma` function is used to reduce the partial
- * results obtained in each cluster.
+ * If set, distributes tiles on the K dimension to all clusters. Shorthand for
+ * setting `k_clusters` to the number of clusters.
+ *
+ * @var gemm_args_t::m_clusters
+ * Number of clusters the tiles on the M dimension are distributed to, i.e.
+ * the M dimension of the cluster grid. If zero, it defaults to the number of
+ * clusters if `parallelize_m` is set, and to one otherwise.
+ *
+ * @var gemm_args_t::n_clusters
+ * Number of clusters the tiles on the N dimension are distributed to, i.e.
+ * the N dimension of the cluster grid. If zero, it defaults to one.
+ *
+ * @var gemm_args_t::k_clusters
+ * Number of clusters the tiles on the K dimension are distributed to, i.e.
+ * the K dimension of the cluster grid. If zero, it defaults to the number of
+ * clusters if `parallelize_k` is set, and to one otherwise. The partial
+ * results of the clusters along the K dimension are reduced with
+ * `snrt_cluster_group_reduction_dma`, with the precision given by `prec`.
+ *
+ * @var gemm_args_t::multicast
+ * If set, every A (resp. B) tile needed by multiple clusters along the N
+ * (resp. M) dimension of the cluster grid is read from memory only once, by
+ * the first of these clusters, and multicast into the TCDM of all of them.
+ * Only effective if the system supports multicast, and the number of clusters
+ * sharing a tile and their distance in the grid are powers of two.
  *
  * @var gemm_args_t::load_a
  * Flag indicating whether to allocate and load the A matrix into TCDM.
@@ -59,7 +88,10 @@ typedef void (*gemm_fp_t)(uint32_t setup_ssr, uint32_t partition_banks,
  *
  * @var gemm_args_t::double_buffer
  * Flag indicating whether to employ double buffering on arrays that are loaded
- * from memory.
+ * from memory. When the K dimension of the cluster grid is larger than one,
+ * the reduction of every C tile then overlaps with the computation of the
+ * next tile, at the cost of a third C buffer and a reduction buffer.
+ * Overridden by `gemm_plan()` if any number of tiles is zero.
  *
  * @var gemm_args_t::gemm_fp
  * Function pointer of a specific GEMM kernel implementation in Snitch, e.g.
@@ -72,10 +104,12 @@ typedef void (*gemm_fp_t)(uint32_t setup_ssr, uint32_t partition_banks,
  * Flag indicating whether to (re)configure the SSRs. Only needs to be set
  * on the invocation for the first tile. Successive tiles of the same problem
  * can inherit the same settings of the first tile without reconfiguration.
+ * Always set if the tiles are not all of the same size.
  *
  * @var gemm_args_t::partition_banks
  * Flag indicating whether to partition the banks, assigning a unique subset
- * of banks to each buffer.
+ * of banks to each buffer. Only supported if the tiles are all of the same
+ * size. Overridden by `gemm_plan()` if any number of tiles is zero.
  */
 typedef struct {
     uint32_t m_tiles;
@@ -83,6 +117,10 @@ typedef struct {
     uint32_t k_tiles;
     uint32_t parallelize_m;
     uint32_t parallelize_k;
+    uint32_t m_clusters;
+    uint32_t n_clusters;
+    uint32_t k_clusters;
+    uint32_t multicast;
     uint32_t load_a;
     uint32_t load_b;
     uint32_t load_c;
@@ -14,6 +14,8 @@ typedef struct {
     uint32_t end;
     // Address of the next allocated block
     uint32_t next;
+    // Highest address reached by `next`, i.e. the high-water mark
+    uint32_t peak;
 } snrt_allocator_t;
 
 inline void *snrt_l1_next();
@@ -8,10 +8,61 @@
 
 #include "alloc_decls.h"
 
+// Maximum depth of the cross-cluster reduction tree
+#define SNRT_REDUCTION_MAX_LEVELS 8
+
+// Progress of the cross-cluster reductions, see snrt_global_reduction_dma.
+// The counters are cumulative over all reductions, so they never need to be
+// reset.
+typedef struct {
+    // Incremented by each compute core when entering a reduction (or on their
+    // behalf by the DM core, in decoupled reductions), and after reducing a
+    // chunk
+    uint32_t entered;
+    uint32_t reduced;
+    // Incremented by each compute core after reducing a chunk received at
+    // each level of the tree
+    uint32_t consumed[SNRT_REDUCTION_MAX_LEVELS];
+    // Number of chunks received at each level of the tree, and broadcast by
+    // cluster 0, written by the sending cluster's DM core
+    uint32_t received[SNRT_REDUCTION_MAX_LEVELS];
+    uint32_t broadcast;
+} snrt_reduction_dma_state_t;
+
+// Maximum depth of the inter-cluster barrier trees, and number of barrier
+// states, one per group of clusters which may synchronize concurrently
+#define SNRT_CLUSTER_BARRIER_MAX_LEVELS 8
+#define SNRT_CLUSTER_BARRIER_NUM 4
+
+// State of a cluster in an inter-cluster barrier, see
+// snrt_inter_cluster_tree_barrier. All flags hold the epoch of the barrier in
+// which they were last signaled, so they never need to be reset.
+typedef struct {
+    // Number of barriers the cluster completed, only accessed locally
+    uint32_t epoch;
+    // Written by the children in the tree, and by the partners of every
+    // round of the dissemination barrier
+    uint32_t arrived[SNRT_CLUSTER_BARRIER_MAX_LEVELS];
+    uint32_t signaled[SNRT_CLUSTER_BARRIER_MAX_LEVELS];
+    // Written by the parent in the tree, or multicast by the root
+    uint32_t released;
+} snrt_cluster_barrier_t;
+
 typedef struct {
     uint32_t hw_barrier;
     uint32_t reduction;
     snrt_allocator_t l1_allocator;
+    // Next channel handed out by `snrt_dma_schedule_channels`
+    uint32_t dma_next_channel;
+    // Cluster-shared state of the event unit, the data mover and the OpenMP
+    // runtime, published by the core allocating it to the other cores
+    void *volatile eu_p;
+    void *volatile dm_p;
+    void *volatile omp_p;
+    // Region profiling buffers of all cores, see snrt_perf_region_init
+    void *volatile perf_regions;
+    snrt_reduction_dma_state_t reduction_dma;
+    snrt_cluster_barrier_t cluster_barrier[SNRT_CLUSTER_BARRIER_NUM];
 } cls_t;
 
 inline cls_t* cls();
@@ -11,6 +11,16 @@ typedef struct {
     uint32_t volatile iteration;
 } snrt_barrier_t;
 
+// Subset of the clusters which synchronize through an inter-cluster barrier
+typedef struct {
+    // Bit `i` is set if cluster `i` belongs to the group
+    uint32_t mask;
+    // Barrier state used by the group, in [0, SNRT_CLUSTER_BARRIER_NUM).
+    // Groups sharing clusters must use distinct states if they synchronize
+    // concurrently.
+    uint32_t barrier_idx;
+} snrt_cluster_group_t;
+
 extern volatile uint32_t _snrt_mutex;
 extern volatile snrt_barrier_t _snrt_barrier;
 extern volatile uint32_t _reduction_result;
@@ -27,6 +37,15 @@ inline void snrt_cluster_hw_barrier();
 
 inline void snrt_global_barrier();
 
+inline void snrt_partial_barrier(snrt_barrier_t *barr, uint32_t n);
+
+inline void snrt_inter_cluster_tree_barrier(const snrt_cluster_group_t *group);
+
+inline void snrt_inter_cluster_dissemination_barrier(
+    const snrt_cluster_group_t *group);
+
+inline void snrt_cluster_group_barrier(const snrt_cluster_group_t *group);
+
 inline uint32_t snrt_global_all_to_all_reduction(uint32_t value);
 
 inline void snrt_wait_writeback(uint32_t val);
@@ -4,13 +4,33 @@
 
 __thread snrt_allocator_t l1_allocator_v2;
 
+void snrt_l1_alloc_error(const char *msg) {
+    snrt_allocator_t *alloc = snrt_l1_allocator_v2();
+    printf("[alloc] L1 allocation failed on core %u: %s (next %#x, end %#x)\n",
+           snrt_global_core_idx(), msg, alloc->next, alloc->end);
+    asm volatile("ecall \n");
+}
+
 extern snrt_allocator_t *snrt_l1_allocator_v2();
 
 extern void *snrt_l1_next_v2();
 
+extern snrt_l1_mark_t snrt_l1_mark();
+
+extern void snrt_l1_release(snrt_l1_mark_t mark);
+
+extern uint32_t snrt_l1_high_water_mark();
+
+extern uint32_t snrt_l1_available(size_t alignment);
+
 extern void *snrt_l1_alloc_cluster_local(size_t size, size_t alignment);
 extern void *snrt_l1_alloc_compute_core_local(size_t size, size_t alignment);
 
+extern void snrt_l1_bank_group_begin(snrt_l1_bank_group_t *group);
+extern void *snrt_l1_bank_group_alloc(snrt_l1_bank_group_t *group, size_t size,
+                                      uint32_t num_banks, uint32_t hyperbank);
+extern void snrt_l1_bank_group_end(snrt_l1_bank_group_t *group);
+
 extern void *snrt_remote_l1_ptr(void *ptr, uint32_t src_cluster_idx,
                                 uint32_t dst_cluster_idx);
 
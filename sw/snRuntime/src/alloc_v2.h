@@ -10,6 +10,12 @@
  * memory. It includes functions for allocating memory for cluster-local
  * variables, compute core-local variables, and for manipulating pointers to
  * variables allocated by different cores or clusters.
+ *
+ * Allocations can be scoped: `snrt_l1_mark()` records the state of the
+ * allocator and `snrt_l1_release()` frees everything allocated since.
+ * Buffers which are accessed concurrently can be placed in disjoint TCDM
+ * banks, or in distinct hyperbanks, through a bank group, see
+ * `snrt_l1_bank_group_begin()`.
  */
 
 extern __thread snrt_allocator_t l1_allocator_v2;
@@ -38,12 +44,77 @@ inline void snrt_l1_update_next_v2(void *next) {
 }
 
 /**
- * @brief Check if the allocation exceeds the allocator bounds and raise an
- *        exception if it does.
+ * @brief Report a failed allocation and raise an exception.
+ *
+ * @param msg Description of the failure.
+ */
+void snrt_l1_alloc_error(const char *msg);
+
+/**
+ * @brief Check if the allocation exceeds the allocator bounds and report it
+ *        if it does. Otherwise, update the high-water mark.
  */
 static inline void snrt_l1_alloc_check_bounds() {
-    if (snrt_l1_allocator_v2()->next > snrt_l1_allocator_v2()->end)
-        asm volatile("ecall \n");
+    snrt_allocator_t *alloc = snrt_l1_allocator_v2();
+    if (alloc->next > alloc->end) snrt_l1_alloc_error("out of memory");
+    if (alloc->next > alloc->peak) alloc->peak = alloc->next;
+}
+
+/**
+ * @brief State of the L1 allocator, to release the allocations performed
+ *        after it was recorded.
+ */
+typedef struct {
+    uint32_t next;
+    uint32_t end;
+} snrt_l1_mark_t;
+
+/**
+ * @brief Record the state of the L1 allocator.
+ *
+ * @return A mark to pass to `snrt_l1_release()`.
+ */
+inline snrt_l1_mark_t snrt_l1_mark() {
+    snrt_l1_mark_t mark = {snrt_l1_allocator_v2()->next,
+                           snrt_l1_allocator_v2()->end};
+    return mark;
+}
+
+/**
+ * @brief Free all L1 allocations performed since `mark` was recorded.
+ *
+ * @param mark A mark returned by `snrt_l1_mark()`. Marks must be released
+ *        in the reverse order in which they were recorded.
+ * @note As every core keeps its own copy of the allocator, every core which
+ *       performed the allocations should release them.
+ */
+inline void snrt_l1_release(snrt_l1_mark_t mark) {
+    snrt_l1_allocator_v2()->next = mark.next;
+    snrt_l1_allocator_v2()->end = mark.end;
+}
+
+/**
+ * @brief Get the high-water mark of the L1 allocator.
+ *
+ * @return The maximum number of bytes allocated at any point in time since
+ *         the allocator was initialized.
+ */
+inline uint32_t snrt_l1_high_water_mark() {
+    return snrt_l1_allocator_v2()->peak - snrt_l1_allocator_v2()->base;
+}
+
+/**
+ * @brief Get the number of bytes which can still be allocated.
+ *
+ * @param alignment The alignment of the first allocation, whose padding is
+ *        not available.
+ * @return The number of bytes between the next address with the given
+ *         alignment and the end of the heap.
+ */
+inline uint32_t snrt_l1_available(size_t alignment) {
+    uint32_t next = snrt_align_up(snrt_l1_allocator_v2()->next, alignment);
+    uint32_t end = snrt_l1_allocator_v2()->end;
+    return next < end ? end - next : 0;
 }
 
 /**
@@ -91,6 +162,91 @@ inline void *snrt_l1_alloc_compute_core_local(size_t size,
     return retval;
 }
 
+/**
+ * @brief Group of buffers placed in disjoint TCDM banks.
+ *
+ * The buffers of a group share a range of TCDM lines, starting at `base` in
+ * every hyperbank. Each buffer is assigned a contiguous subset of the banks of
+ * a hyperbank, in order of allocation, so that the buffers of a group can be
+ * accessed concurrently without bank conflicts.
+ */
+typedef struct {
+    // Address of the first line of the group in the first hyperbank
+    uint32_t base;
+    // Number of lines occupied by the largest buffer of the group
+    uint32_t lines;
+    // Index of the first bank not yet assigned, in every hyperbank
+    uint32_t next_bank[SNRT_TCDM_HYPERBANK_NUM];
+} snrt_l1_bank_group_t;
+
+/**
+ * @brief Start a group of buffers placed in disjoint TCDM banks.
+ *
+ * The group starts at the first TCDM line after the current allocations.
+ * No other allocation may be performed until `snrt_l1_bank_group_end()`.
+ *
+ * @param group The group to initialize.
+ */
+inline void snrt_l1_bank_group_begin(snrt_l1_bank_group_t *group) {
+    group->base =
+        snrt_align_up_hyperbank((uintptr_t)snrt_l1_allocator_v2()->next);
+    group->lines = 0;
+    for (uint32_t i = 0; i < SNRT_TCDM_HYPERBANK_NUM; i++)
+        group->next_bank[i] = 0;
+}
+
+/**
+ * @brief Allocate a buffer in the next `num_banks` banks of a group.
+ *
+ * The buffer is laid out in rows of `num_banks * SNRT_TCDM_BANK_WIDTH` bytes,
+ * one per TCDM line. Consecutive rows are thus `SNRT_TCDM_HYPERBANK_WIDTH`
+ * bytes apart. A buffer assigned all the banks of a hyperbank is contiguous,
+ * i.e. interleaved over all banks.
+ *
+ * @param group The group to allocate the buffer in.
+ * @param size The size of the buffer in bytes.
+ * @param num_banks The number of banks assigned to the buffer.
+ * @param hyperbank The hyperbank the buffer is placed in.
+ * @return Pointer to the first row of the buffer.
+ */
+inline void *snrt_l1_bank_group_alloc(snrt_l1_bank_group_t *group, size_t size,
+                                      uint32_t num_banks, uint32_t hyperbank) {
+    uint32_t bank = group->next_bank[hyperbank];
+    uint32_t row_size = num_banks * SNRT_TCDM_BANK_WIDTH;
+    uint32_t lines = (size + row_size - 1) / row_size;
+    if (bank + num_banks > SNRT_TCDM_BANK_PER_HYPERBANK_NUM)
+        snrt_l1_alloc_error("out of banks");
+    group->next_bank[hyperbank] = bank + num_banks;
+    if (lines > group->lines) group->lines = lines;
+    return (void *)(group->base + hyperbank * SNRT_TCDM_HYPERBANK_SIZE +
+                    bank * SNRT_TCDM_BANK_WIDTH);
+}
+
+/**
+ * @brief End a group of buffers placed in disjoint TCDM banks.
+ *
+ * Allocates the lines occupied by the group. If the group spans multiple
+ * hyperbanks, the allocations following the group are bounded by the lines
+ * the group occupies in the second hyperbank, until the group is released.
+ *
+ * @param group The group to end.
+ */
+inline void snrt_l1_bank_group_end(snrt_l1_bank_group_t *group) {
+    snrt_allocator_t *alloc = snrt_l1_allocator_v2();
+    uint32_t size = group->lines * SNRT_TCDM_HYPERBANK_WIDTH;
+    for (uint32_t i = SNRT_TCDM_HYPERBANK_NUM - 1; i > 0; i--) {
+        if (group->next_bank[i]) {
+            alloc->next = group->base + i * SNRT_TCDM_HYPERBANK_SIZE + size;
+            snrt_l1_alloc_check_bounds();
+            uint32_t end = group->base + SNRT_TCDM_HYPERBANK_SIZE;
+            if (end < alloc->end) alloc->end = end;
+            break;
+        }
+    }
+    alloc->next = group->base + size;
+    snrt_l1_alloc_check_bounds();
+}
+
 /**
  * @brief Get a pointer to the same variable allocated by another core.
  *
@@ -150,4 +306,5 @@ inline void snrt_alloc_init_v2() {
         snrt_align_up(snrt_l1_start_addr(), MIN_CHUNK_SIZE);
     snrt_l1_allocator_v2()->end = heap_end_addr;
     snrt_l1_allocator_v2()->next = snrt_l1_allocator_v2()->base;
+    snrt_l1_allocator_v2()->peak = snrt_l1_allocator_v2()->base;
 }
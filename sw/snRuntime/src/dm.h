@@ -13,18 +13,22 @@
  * @brief Define DM_USE_GLOBAL_CLINT to use the cluster-shared CLINT based SW
  * interrupt system for synchronization. If not defined, the harts use the
  * cluster-local CLINT to syncrhonize which is faster but only works for
- * cluster-local synchronization which is sufficient at the moment since the
- * OpenMP runtime is single cluster only.
+ * cluster-local synchronization. This is sufficient since a team spanning
+ * multiple clusters is forked and joined by the first core of each cluster,
+ * which synchronizes with the cores of its own cluster only.
  *
  */
 // #define DM_USE_GLOBAL_CLINT
 
 /**
- * @brief Number of outstanding transactions to buffer. Each requires
- * sizeof(dm_task_t) bytes
+ * @brief Number of requests to buffer, a power of two. Each requires
+ * sizeof(dm_task_t) bytes. The DM core also keeps track of the completion of
+ * at most this many issued requests.
  *
  */
-#define DM_TASK_QUEUE_SIZE 4
+#ifndef DM_TASK_QUEUE_SIZE
+#define DM_TASK_QUEUE_SIZE 16
+#endif
 
 //================================================================================
 // Macros
@@ -74,25 +78,40 @@ typedef struct {
     uint32_t nreps;
     uint32_t cfg;
     uint32_t twod;
+    // Sequence number of the slot: equal to the ticket of the request which
+    // may claim it when free, and to that ticket plus one once the request
+    // is published
+    uint32_t seq;
 } dm_task_t;
 
+/**
+ * @brief Completion token of a request, see dm_wait_token()
+ */
+typedef uint32_t dm_token_t;
+
 // used for ultra-fine grained communication
 // stat_q can be used to request a command, 0 is no command
 // the response is put into stat_p and is valid iff stat_pvalid is non-zero
 typedef enum en_stat {
-    // commands the DM core to wait until all transfers are complete
-    STAT_WAIT_IDLE = 1,
     // abort and exit
     STAT_EXIT = 2,
     // poll if DM is ready
     STAT_READY = 3,
 } en_stat_t;
 
+/**
+ * @brief Lock-free ring of requests, with multiple producers and the DM core
+ * as single consumer. Producers claim a ticket with an AMO on `queue_tail`,
+ * and fill the slot of their ticket once the DM core has freed it.
+ */
 typedef struct {
     dm_task_t queue[DM_TASK_QUEUE_SIZE];
-    uint32_t queue_back;
-    uint32_t queue_front;
-    volatile uint32_t queue_fill;
+    // Ticket of the next request to enqueue, and to issue
+    volatile uint32_t queue_tail;
+    volatile uint32_t queue_head;
+    // Number of requests whose transfers have completed
+    volatile uint32_t completed;
+    // Serializes the status requests
     volatile uint32_t mutex;
     volatile en_stat_t stat_q;
     volatile uint32_t stat_p;
@@ -109,11 +128,6 @@ typedef struct {
  *
  */
 extern __thread volatile dm_t *dm_p;
-/**
- * @brief Pointer to where the DM struct in TCDM is located
- *
- */
-extern volatile dm_t *volatile dm_p_global;
 
 //================================================================================
 // Functions
@@ -129,20 +143,32 @@ static inline void wake_dm(void) {
     snrt_int_sw_set(basehart + snrt_cluster_dm_core_idx());
 }
 #else
+static inline int dm_has_work(void);
 static inline void wfi_dm(uint32_t cluster_core_idx) {
-    __atomic_add_fetch(&dm_p->dm_wfi, 1, __ATOMIC_RELAXED);
-    snrt_wfi();
+    __atomic_add_fetch(&dm_p->dm_wfi, 1, __ATOMIC_SEQ_CST);
+    // Requests published before dm_wfi was raised did not send a wakeup
+    if (!dm_has_work()) snrt_wfi();
     snrt_int_cluster_clr(1 << cluster_core_idx);
     __atomic_add_fetch(&dm_p->dm_wfi, -1, __ATOMIC_RELAXED);
 }
 static inline void wake_dm(void) {
-    // wait for DM to sleep before sending wakeup
-    while (!__atomic_load_n(&dm_p->dm_wfi, __ATOMIC_RELAXED))
-        ;
-    snrt_int_cluster_set(1 << snrt_cluster_compute_core_num());
+    // only send a wakeup if the DM sleeps, or is about to
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&dm_p->dm_wfi, __ATOMIC_RELAXED))
+        snrt_int_cluster_set(1 << snrt_cluster_compute_core_num());
 }
 #endif  // #ifdef DM_USE_GLOBAL_CLINT
 
+/**
+ * @brief Check if a request is ready to be issued, a status request is
+ * pending, or issued transfers have yet to complete
+ */
+static inline int dm_has_work(void) {
+    uint32_t head = dm_p->queue_head;
+    return dm_p->queue[head % DM_TASK_QUEUE_SIZE].seq == head + 1 ||
+           dm_p->stat_q || dm_p->completed != head;
+}
+
 /**
  * @brief Init the data mover and load a pointer to the DM struct in to TLS.
  * Needs to be called by the DM itself and all harts that want to use the dm
@@ -157,13 +183,17 @@ inline void dm_init(void) {
 #else
         snrt_interrupt_enable(IRQ_M_CLUSTER);
 #endif
-        dm_p = (dm_t *)snrt_l1_alloc(sizeof(dm_t));
-        snrt_dma_memset((void *)dm_p, 0, sizeof(dm_t));
-        dm_p_global = dm_p;
+        // The DMA memset only clears whole 64-byte chunks
+        uint32_t size = snrt_align_up(sizeof(dm_t), 64);
+        dm_p = (dm_t *)snrt_l1_alloc(size);
+        snrt_dma_memset((void *)dm_p, 0, size);
+        for (uint32_t i = 0; i < DM_TASK_QUEUE_SIZE; i++)
+            dm_p->queue[i].seq = i;
+        cls()->dm_p = (void *)dm_p;
     } else {
-        while (!dm_p_global)
+        while (!cls()->dm_p)
             ;
-        dm_p = dm_p_global;
+        dm_p = (volatile dm_t *)cls()->dm_p;
     }
 }
 
@@ -175,44 +205,54 @@ inline void dm_main(void) {
     volatile dm_task_t *t;
     uint32_t do_exit = 0;
     uint32_t cluster_core_idx = snrt_cluster_core_idx();
+    // Transfer IDs of the issued requests, by ticket
+    uint32_t txid[DM_TASK_QUEUE_SIZE];
+    uint32_t head = dm_p->queue_head;
+    uint32_t completed = dm_p->completed;
 
     DM_PRINTF(10, "enter main\n");
 
     while (!do_exit) {
-        /// New transaction to issue?
-        if (dm_p->queue_fill) {
+        /// Issue all published transactions, as long as their completion can
+        /// be tracked
+        t = &dm_p->queue[head % DM_TASK_QUEUE_SIZE];
+        while (__atomic_load_n(&t->seq, __ATOMIC_ACQUIRE) == head + 1 &&
+               head - completed < DM_TASK_QUEUE_SIZE) {
             // wait until DMA is ready
             while (__builtin_sdma_stat(DM_STATUS_WOULD_BLOCK))
                 ;
 
-            t = &dm_p->queue[dm_p->queue_back];
-
             if (t->twod) {
                 DM_PRINTF(10, "start twod\n");
-                __builtin_sdma_start_twod(t->src, t->dst, t->size, t->sstrd,
-                                          t->dstrd, t->nreps, t->cfg);
+                txid[head % DM_TASK_QUEUE_SIZE] = __builtin_sdma_start_twod(
+                    t->src, t->dst, t->size, t->sstrd, t->dstrd, t->nreps,
+                    t->cfg);
             } else {
                 DM_PRINTF(10, "start oned\n");
-                __builtin_sdma_start_oned(t->src, t->dst, t->size, t->cfg);
+                txid[head % DM_TASK_QUEUE_SIZE] =
+                    __builtin_sdma_start_oned(t->src, t->dst, t->size, t->cfg);
             }
 
-            // bump
-            dm_p->queue_back = (dm_p->queue_back + 1) % DM_TASK_QUEUE_SIZE;
-            __atomic_add_fetch(&dm_p->queue_fill, -1, __ATOMIC_RELAXED);
+            // free the slot for the ticket one lap ahead, and bump
+            __atomic_store_n(&t->seq, head + DM_TASK_QUEUE_SIZE,
+                             __ATOMIC_RELEASE);
+            head++;
+            dm_p->queue_head = head;
+            t = &dm_p->queue[head % DM_TASK_QUEUE_SIZE];
+        }
+
+        /// Retire the completed transactions, in order
+        if (completed != head) {
+            uint32_t done = __builtin_sdma_stat(DM_STATUS_COMPLETE_ID);
+            while (completed != head &&
+                   done >= txid[completed % DM_TASK_QUEUE_SIZE])
+                completed++;
+            __atomic_store_n(&dm_p->completed, completed, __ATOMIC_RELEASE);
         }
 
         /// any STAT request pending?
         if (dm_p->stat_q) {
             switch (dm_p->stat_q) {
-                case STAT_WAIT_IDLE:
-                    // check status and set pvalid if DMA is idle and clear
-                    // request
-                    if (__builtin_sdma_stat(DM_STATUS_BUSY) == 0) {
-                        DM_PRINTF(50, "idle\n");
-                        dm_p->stat_pvalid = 1;
-                        dm_p->stat_q = (en_stat_t)0;
-                    }
-                    break;
                 case STAT_EXIT:
                     do_exit = 1;
                     break;
@@ -224,8 +264,9 @@ inline void dm_main(void) {
             }
         }
 
-        // sleep if queue is empty and no stats pending
-        if (!dm_p->queue_fill && !dm_p->stat_q) {
+        // sleep if queue is empty, all transactions completed and no stats
+        // pending
+        if (!dm_has_work()) {
             wfi_dm(cluster_core_idx);
         }
     }
@@ -248,47 +289,62 @@ inline void dm_exit(void) {
     wake_dm();
 }
 
+/**
+ * @brief Claim the slot of the next request in the queue
+ * @details block only if DM queue is full
+ *
+ * @param ticket returns the ticket of the request
+ * @return the slot, to fill and publish with dm_publish()
+ */
+static inline volatile dm_task_t *dm_claim(uint32_t *ticket) {
+    *ticket = __atomic_fetch_add(&dm_p->queue_tail, 1, __ATOMIC_RELAXED);
+    volatile dm_task_t *t = &dm_p->queue[*ticket % DM_TASK_QUEUE_SIZE];
+    // wait for the DM core to issue the request which used the slot one lap
+    // before
+    while (__atomic_load_n(&t->seq, __ATOMIC_ACQUIRE) != *ticket) wake_dm();
+    return t;
+}
+
+/**
+ * @brief Publish a request filled in a slot returned by dm_claim()
+ * @return completion token of the request
+ */
+static inline dm_token_t dm_publish(volatile dm_task_t *t, uint32_t ticket) {
+    __atomic_store_n(&t->seq, ticket + 1, __ATOMIC_RELEASE);
+    return ticket + 1;
+}
+
 /**
  * @brief Queue an asynchronus memory copy. The transfer is not started unless
- * dm_start or dm_wait is issued
+ * dm_start or dm_wait is issued, or the DM core is already busy
  * @details block only if DM queue is full
  *
  * @param dest destination pointer
  * @param src source pointer
  * @param n number of bytes to copy
- * @return transfer ID
+ * @return completion token of the transfer, see dm_wait_token()
  */
-inline void dm_memcpy_async(void *dest, const void *src, size_t n) {
-    uint32_t s;
+inline dm_token_t dm_memcpy_async(void *dest, const void *src, size_t n) {
+    uint32_t ticket;
     volatile dm_task_t *t;
 
     DM_PRINTF(10, "dm_memcpy_async %#x -> %#x size %d\n", src, dest,
               (uint32_t)n);
 
-    // poll queue size
-    do {
-        s = __atomic_load_n(&dm_p->queue_fill, __ATOMIC_RELAXED);
-    } while (s >= DM_TASK_QUEUE_SIZE);
-    _dm_mtx_lock();
-
     // insert
-    t = &dm_p->queue[dm_p->queue_front];
+    t = dm_claim(&ticket);
     t->src = (uint64_t)src;
     t->dst = (uint64_t)dest;
     t->size = (uint32_t)n;
     t->twod = 0;
     t->cfg = 0;
 
-    // bump
-    __atomic_add_fetch(&dm_p->queue_fill, 1, __ATOMIC_RELAXED);
-    dm_p->queue_front = (dm_p->queue_front + 1) % DM_TASK_QUEUE_SIZE;
-
-    _dm_mtx_release();
+    return dm_publish(t, ticket);
 }
 
 /**
  * @brief Queue an asynchronus memory copy. The transfer is not started unless
- * dm_start or dm_wait is issued
+ * dm_start or dm_wait is issued, or the DM core is already busy
  * @details block only if DM queue is full
  *
  * @param src source address
@@ -298,24 +354,19 @@ inline void dm_memcpy_async(void *dest, const void *src, size_t n) {
  * @param dstrd outer destination stride
  * @param nreps number of repetitions in outer dimension
  * @param cfg DMA configuration
+ * @return completion token of the transfer, see dm_wait_token()
  */
-inline void dm_memcpy2d_async(uint64_t src, uint64_t dst, uint32_t size,
-                              uint32_t sstrd, uint32_t dstrd, uint32_t nreps,
-                              uint32_t cfg) {
-    uint32_t s;
+inline dm_token_t dm_memcpy2d_async(uint64_t src, uint64_t dst, uint32_t size,
+                                    uint32_t sstrd, uint32_t dstrd,
+                                    uint32_t nreps, uint32_t cfg) {
+    uint32_t ticket;
     volatile dm_task_t *t;
 
     DM_PRINTF(10, "dm_memcpy2d_async %#x -> %#x size %d\n", src, dst,
               (uint32_t)size);
 
-    // poll queue size
-    do {
-        s = __atomic_load_n(&dm_p->queue_fill, __ATOMIC_RELAXED);
-    } while (s >= DM_TASK_QUEUE_SIZE);
-    _dm_mtx_lock();
-
     // insert
-    t = &dm_p->queue[dm_p->queue_front];
+    t = dm_claim(&ticket);
     t->src = src;
     t->dst = dst;
     t->size = size;
@@ -325,11 +376,30 @@ inline void dm_memcpy2d_async(uint64_t src, uint64_t dst, uint32_t size,
     t->twod = 1;
     t->cfg = cfg;
 
-    // bump
-    __atomic_add_fetch(&dm_p->queue_fill, 1, __ATOMIC_RELAXED);
-    dm_p->queue_front = (dm_p->queue_front + 1) % DM_TASK_QUEUE_SIZE;
+    return dm_publish(t, ticket);
+}
 
-    _dm_mtx_release();
+/**
+ * @brief Check if a transfer has completed
+ *
+ * @param token completion token returned when queuing the transfer
+ */
+inline int dm_test_token(dm_token_t token) {
+    uint32_t completed = __atomic_load_n(&dm_p->completed, __ATOMIC_ACQUIRE);
+    // robust to the wrap-around of the tickets
+    return (int32_t)(completed - token) >= 0;
+}
+
+/**
+ * @brief Wait for a transfer, and all transfers queued before it by any core,
+ * to complete
+ *
+ * @param token completion token returned when queuing the transfer
+ */
+inline void dm_wait_token(dm_token_t token) {
+    // signal data mover, until the requests queued by other cores up to this
+    // one are published
+    while (!dm_test_token(token)) wake_dm();
 }
 
 /**
@@ -339,34 +409,11 @@ inline void dm_memcpy2d_async(uint64_t src, uint64_t dst, uint32_t size,
 inline void dm_start(void) { wake_dm(); }
 
 /**
- * @brief Wait for all DMA transfers to complete
+ * @brief Wait for all transfers queued so far, by any core, to complete
  * @details
  */
 inline void dm_wait(void) {
-    uint32_t s;
-
-    // signal data mover
-    wake_dm();
-
-    // first, wait for the dm queue to be empty and no request be pending
-    do {
-        s = __atomic_load_n(&dm_p->queue_fill, __ATOMIC_RELAXED);
-    } while (s != 0);
-    while (dm_p->stat_q)
-        ;
-
-    // then, issue the STAT_WAIT_IDLE request so the DM core polls for the DMA
-    // to be idle
-    _dm_mtx_lock();
-    dm_p->stat_pvalid = 0;
-    // this is the request
-    dm_p->stat_q = STAT_WAIT_IDLE;
-    // signal data mover
-    wake_dm();
-    // whenever stat_pvalid is non-zero, the DMA has completed all transfers
-    while (!dm_p->stat_pvalid)
-        ;
-    _dm_mtx_release();
+    dm_wait_token(__atomic_load_n(&dm_p->queue_tail, __ATOMIC_RELAXED));
 }
 
 /**
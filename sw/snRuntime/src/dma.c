@@ -28,7 +28,46 @@ extern snrt_dma_txid_t snrt_dma_load_2d_tile(
     size_t tile_x1_size, size_t tile_x0_size, size_t full_x0_size,
     uint32_t prec);
 
+extern size_t snrt_tile_extent(size_t tile_idx, size_t tile_size,
+                               size_t full_size);
+
+extern snrt_dma_txid_t snrt_dma_load_2d_edge_tile(
+    void *dst, void *src, size_t tile_x1_idx, size_t tile_x0_idx,
+    size_t tile_x1_size, size_t tile_x0_size, size_t full_x1_size,
+    size_t full_x0_size, size_t full_ld, uint32_t prec, uint32_t mcast);
+
 extern snrt_dma_txid_t snrt_dma_store_2d_tile(
     void *dst, void *src, size_t tile_x1_idx, size_t tile_x0_idx,
     size_t tile_x1_size, size_t tile_x0_size, size_t full_x0_size,
     uint32_t prec);
+
+extern snrt_dma_txid_t snrt_dma_store_2d_edge_tile(
+    void *dst, void *src, size_t tile_x1_idx, size_t tile_x0_idx,
+    size_t tile_x1_size, size_t tile_x0_size, size_t full_x1_size,
+    size_t full_x0_size, size_t full_ld, uint32_t prec);
+
+extern snrt_dma_txid_t snrt_dma_start_1d_channel(uint64_t dst, uint64_t src,
+                                                 size_t size, uint32_t channel);
+
+extern snrt_dma_txid_t snrt_dma_start_2d_channel(uint64_t dst, uint64_t src,
+                                                 size_t size, size_t dst_stride,
+                                                 size_t src_stride,
+                                                 size_t repeat,
+                                                 uint32_t channel);
+
+extern snrt_dma_txid_t snrt_dma_completed_channel(uint32_t channel);
+
+extern uint32_t snrt_dma_schedule_channels(uint32_t num_chunks,
+                                           uint32_t num_channels);
+
+extern snrt_dma_handle_t snrt_dma_start_1d_striped(uint64_t dst, uint64_t src,
+                                                   size_t size,
+                                                   uint32_t num_channels);
+
+extern snrt_dma_handle_t snrt_dma_start_2d_striped(
+    uint64_t dst, uint64_t src, size_t size, size_t dst_stride,
+    size_t src_stride, size_t repeat, uint32_t num_channels);
+
+extern int snrt_dma_handle_done(const snrt_dma_handle_t *handle);
+
+extern void snrt_dma_wait_handle(const snrt_dma_handle_t *handle);
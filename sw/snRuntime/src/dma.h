@@ -65,15 +65,21 @@ static inline uint32_t snrt_dma_start_1d(volatile void *dst, volatile void *src,
 /**
  * @brief Start an asynchronous multicast 1D DMA transfer with 64-bit wide
  * pointers.
- * @param mask Multicast mask applied on the destination address.
+ * @param mask Multicast mask applied on the destination address. If zero,
+ *             a regular transfer is issued, also on targets without
+ *             multicast support.
  * @see snrt_dma_start_1d(uint64_t, uint64_t, size_t, uint32_t) for a
  *      description of the other parameters.
  */
 static inline uint32_t snrt_dma_start_1d_mcast(uint64_t dst, uint64_t src,
                                                size_t size, uint32_t mask,
                                                const uint32_t channel = 0) {
+    if (!mask) return snrt_dma_start_1d(dst, src, size, channel);
     asm volatile("dmmcast %[mask] \n" : : [ mask ] "r"(mask));
-    return snrt_dma_start_1d(dst, src, size, channel);
+    uint32_t txid = snrt_dma_start_1d(dst, src, size, channel);
+    // Reset the mask, so that subsequent transfers are not multicast
+    asm volatile("dmmcast zero \n");
+    return txid;
 }
 
 /**
@@ -89,7 +95,8 @@ static inline uint32_t snrt_dma_start_1d_mcast(volatile void *dst,
                                                volatile void *src, size_t size,
                                                uint32_t mask,
                                                const uint32_t channel = 0) {
-    return snrt_dma_start_1d_mcast((uint64_t)dst, (uint64_t)src, size, channel);
+    return snrt_dma_start_1d_mcast((uint64_t)dst, (uint64_t)src, size, mask,
+                                   channel);
 }
 
 /**
@@ -152,6 +159,30 @@ static inline uint32_t snrt_dma_start_2d(volatile void *dst, volatile void *src,
                              src_stride, repeat, channel);
 }
 
+/**
+ * @brief Start an asynchronous multicast 2D DMA transfer with 64-bit wide
+ * pointers.
+ * @param mask Multicast mask applied on the destination address. If zero,
+ *             a regular transfer is issued, also on targets without
+ *             multicast support.
+ * @see snrt_dma_start_2d(uint64_t, uint64_t, size_t, size_t, size_t, size_t,
+ *      uint32_t) for a description of the other parameters.
+ */
+static inline snrt_dma_txid_t snrt_dma_start_2d_mcast(
+    uint64_t dst, uint64_t src, size_t size, size_t dst_stride,
+    size_t src_stride, size_t repeat, uint32_t mask,
+    const uint32_t channel = 0) {
+    if (!mask)
+        return snrt_dma_start_2d(dst, src, size, dst_stride, src_stride,
+                                 repeat, channel);
+    asm volatile("dmmcast %[mask] \n" : : [ mask ] "r"(mask));
+    snrt_dma_txid_t txid = snrt_dma_start_2d(dst, src, size, dst_stride,
+                                             src_stride, repeat, channel);
+    // Reset the mask, so that subsequent transfers are not multicast
+    asm volatile("dmmcast zero \n");
+    return txid;
+}
+
 /**
  * @brief Block until a DMA transfer finishes on a specific DMA channel.
  * @param txid The DMA transfer's ID.
@@ -365,6 +396,65 @@ inline snrt_dma_txid_t snrt_dma_load_2d_tile(
                                  tile_x0_size * prec);
 }
 
+/**
+ * @brief Get the number of elements of a tile which lie within an array.
+ *
+ * Tiles of @p tile_size elements partition a dimension of @p full_size
+ * elements, which need not be a multiple of @p tile_size. The last tile is
+ * then an edge tile, cut short by the end of the array.
+ *
+ * @param tile_idx Coordinate of the tile along the dimension.
+ * @param tile_size Number of elements in a tile.
+ * @param full_size Number of elements in the dimension of the array.
+ */
+inline size_t snrt_tile_extent(size_t tile_idx, size_t tile_size,
+                               size_t full_size) {
+    size_t start = tile_idx * tile_size;
+    if (start >= full_size) return 0;
+    size_t extent = full_size - start;
+    return extent < tile_size ? extent : tile_size;
+}
+
+/**
+ * @brief Load a 2D tile of a 2D array, which may be an edge tile.
+ *
+ * Only the part of the tile within the array is transferred, see
+ * `snrt_tile_extent()`. The destination keeps the leading dimension of a full
+ * tile, so that edge tiles can be loaded into the same buffers as full tiles.
+ *
+ * @param dst Pointer to the tile destination.
+ * @param src Pointer to the source array.
+ * @param tile_x1_idx Outermost coordinate of the tile in the 2D array.
+ * @param tile_x0_idx Innermost coordinate of the tile in the 2D array.
+ * @param tile_x1_size Number of elements in the outermost dimension of a full
+ *                     tile.
+ * @param tile_x0_size Number of elements in the innermost dimension of a full
+ *                     tile.
+ * @param full_x1_size Number of elements in the outermost dimension of the
+ *                     array.
+ * @param full_x0_size Number of elements in the innermost dimension of the
+ *                     array.
+ * @param full_ld Leading dimension of the array, in elements.
+ * @param prec Number of bytes of each element in the 2D array.
+ * @param mcast Multicast mask applied on the destination address. If zero,
+ *              the tile is only loaded into the calling cluster.
+ */
+inline snrt_dma_txid_t snrt_dma_load_2d_edge_tile(
+    void *dst, void *src, size_t tile_x1_idx, size_t tile_x0_idx,
+    size_t tile_x1_size, size_t tile_x0_size, size_t full_x1_size,
+    size_t full_x0_size, size_t full_ld, uint32_t prec, uint32_t mcast) {
+    size_t src_offset = tile_x0_idx * tile_x0_size;
+    src_offset += tile_x1_idx * tile_x1_size * full_ld;
+    src_offset *= prec;
+    size_t x1_extent =
+        snrt_tile_extent(tile_x1_idx, tile_x1_size, full_x1_size);
+    size_t x0_extent =
+        snrt_tile_extent(tile_x0_idx, tile_x0_size, full_x0_size);
+    return snrt_dma_start_2d_mcast((uint64_t)dst, (uint64_t)src + src_offset,
+                                   x0_extent * prec, tile_x0_size * prec,
+                                   full_ld * prec, x1_extent, mcast);
+}
+
 /**
  * @brief Load a 2D tile of a 2D array and reshape it to occupy a subset of
  *        TCDM banks.
@@ -438,6 +528,32 @@ inline snrt_dma_txid_t snrt_dma_store_2d_tile(
                                   prec, tile_x0_size * prec);
 }
 
+/**
+ * @brief Store a 2D tile, which may be an edge tile, to a 2D array.
+ *
+ * Only the part of the tile within the array is transferred, see
+ * `snrt_dma_load_2d_edge_tile()`.
+ *
+ * @param dst Pointer to the destination array.
+ * @param src Pointer to the source tile.
+ * @see snrt_dma_load_2d_edge_tile for a description of the other parameters.
+ */
+inline snrt_dma_txid_t snrt_dma_store_2d_edge_tile(
+    void *dst, void *src, size_t tile_x1_idx, size_t tile_x0_idx,
+    size_t tile_x1_size, size_t tile_x0_size, size_t full_x1_size,
+    size_t full_x0_size, size_t full_ld, uint32_t prec) {
+    size_t dst_offset = tile_x0_idx * tile_x0_size;
+    dst_offset += tile_x1_idx * tile_x1_size * full_ld;
+    dst_offset *= prec;
+    size_t x1_extent =
+        snrt_tile_extent(tile_x1_idx, tile_x1_size, full_x1_size);
+    size_t x0_extent =
+        snrt_tile_extent(tile_x0_idx, tile_x0_size, full_x0_size);
+    return snrt_dma_start_2d((uint64_t)dst + dst_offset, (uint64_t)src,
+                             x0_extent * prec, full_ld * prec,
+                             tile_x0_size * prec, x1_extent);
+}
+
 inline snrt_dma_txid_t snrt_dma_store_2d_tile_from_banks(
     void *dst, void *src, size_t tile_x1_idx, size_t tile_x0_idx,
     size_t tile_x1_size, size_t tile_x0_size, size_t full_x0_size,
@@ -450,4 +566,279 @@ inline snrt_dma_txid_t snrt_dma_store_2d_tile_from_banks(
     return snrt_dma_store_2d_tile(dst, src, tile_x1_idx, tile_x0_idx,
                                   tile_x1_size_in_banks, tile_x0_size_in_banks,
                                   full_x0_size, prec, tile_ld);
-}
\ No newline at end of file
+}
+//================================================================================
+// Multi-channel transfers
+//================================================================================
+
+/// Minimum number of bytes a striped transfer assigns to a channel.
+#ifndef SNRT_DMA_STRIPE_MIN_SIZE
+#define SNRT_DMA_STRIPE_MIN_SIZE 1024
+#endif
+
+/**
+ * @brief A logical DMA transfer, possibly split across several channels.
+ *
+ * Holds the ID of the last transfer issued on every channel in @ref mask.
+ */
+typedef struct {
+    snrt_dma_txid_t txid[SNRT_DMA_NUM_CHANNELS];
+    uint32_t mask;
+} snrt_dma_handle_t;
+
+/**
+ * @brief Start an asynchronous 1D DMA transfer on a channel selected at
+ *        runtime.
+ * @see snrt_dma_start_1d(uint64_t, uint64_t, size_t, uint32_t) for a
+ *      description of the parameters.
+ * @note Unlike snrt_dma_start_1d(), @p channel need not be known at compile
+ *       time, at the cost of a branch to the instruction encoding it.
+ */
+inline snrt_dma_txid_t snrt_dma_start_1d_channel(uint64_t dst, uint64_t src,
+                                                 size_t size,
+                                                 uint32_t channel) {
+    switch (channel) {
+        case 1:
+            return snrt_dma_start_1d(dst, src, size, 1);
+        case 2:
+            return snrt_dma_start_1d(dst, src, size, 2);
+        case 3:
+            return snrt_dma_start_1d(dst, src, size, 3);
+        case 4:
+            return snrt_dma_start_1d(dst, src, size, 4);
+        case 5:
+            return snrt_dma_start_1d(dst, src, size, 5);
+        case 6:
+            return snrt_dma_start_1d(dst, src, size, 6);
+        case 7:
+            return snrt_dma_start_1d(dst, src, size, 7);
+        default:
+            return snrt_dma_start_1d(dst, src, size, 0);
+    }
+}
+
+/**
+ * @brief Start an asynchronous 2D DMA transfer on a channel selected at
+ *        runtime.
+ * @see snrt_dma_start_2d(uint64_t, uint64_t, size_t, size_t, size_t, size_t,
+ *      uint32_t) for a description of the parameters.
+ */
+inline snrt_dma_txid_t snrt_dma_start_2d_channel(uint64_t dst, uint64_t src,
+                                                 size_t size,
+                                                 size_t dst_stride,
+                                                 size_t src_stride,
+                                                 size_t repeat,
+                                                 uint32_t channel) {
+    switch (channel) {
+        case 1:
+            return snrt_dma_start_2d(dst, src, size, dst_stride, src_stride,
+                                     repeat, 1);
+        case 2:
+            return snrt_dma_start_2d(dst, src, size, dst_stride, src_stride,
+                                     repeat, 2);
+        case 3:
+            return snrt_dma_start_2d(dst, src, size, dst_stride, src_stride,
+                                     repeat, 3);
+        case 4:
+            return snrt_dma_start_2d(dst, src, size, dst_stride, src_stride,
+                                     repeat, 4);
+        case 5:
+            return snrt_dma_start_2d(dst, src, size, dst_stride, src_stride,
+                                     repeat, 5);
+        case 6:
+            return snrt_dma_start_2d(dst, src, size, dst_stride, src_stride,
+                                     repeat, 6);
+        case 7:
+            return snrt_dma_start_2d(dst, src, size, dst_stride, src_stride,
+                                     repeat, 7);
+        default:
+            return snrt_dma_start_2d(dst, src, size, dst_stride, src_stride,
+                                     repeat, 0);
+    }
+}
+
+/**
+ * @brief Return the ID of the last transfer completed on a channel selected
+ *        at runtime.
+ */
+inline snrt_dma_txid_t snrt_dma_completed_channel(uint32_t channel) {
+    snrt_dma_txid_t txid;
+    switch (channel) {
+        case 1:
+            asm volatile("dmstati %0, (1 << 2) | 0" : "=r"(txid));
+            break;
+        case 2:
+            asm volatile("dmstati %0, (2 << 2) | 0" : "=r"(txid));
+            break;
+        case 3:
+            asm volatile("dmstati %0, (3 << 2) | 0" : "=r"(txid));
+            break;
+        case 4:
+            asm volatile("dmstati %0, (4 << 2) | 0" : "=r"(txid));
+            break;
+        case 5:
+            asm volatile("dmstati %0, (5 << 2) | 0" : "=r"(txid));
+            break;
+        case 6:
+            asm volatile("dmstati %0, (6 << 2) | 0" : "=r"(txid));
+            break;
+        case 7:
+            asm volatile("dmstati %0, (7 << 2) | 0" : "=r"(txid));
+            break;
+        default:
+            asm volatile("dmstati %0, (0 << 2) | 0" : "=r"(txid));
+            break;
+    }
+    return txid;
+}
+
+/**
+ * @brief Pick the channels for a transfer split into @p num_chunks chunks.
+ * @return The first channel to use; the following chunks are issued on the
+ *         next channels, modulo @p num_channels.
+ *
+ * Channels are handed out round-robin, such that consecutive transfers too
+ * small to be striped still spread over all channels.
+ */
+inline uint32_t snrt_dma_schedule_channels(uint32_t num_chunks,
+                                           uint32_t num_channels) {
+    uint32_t first = cls()->dma_next_channel % num_channels;
+    cls()->dma_next_channel = (first + num_chunks) % num_channels;
+    return first;
+}
+
+/**
+ * @brief Start an asynchronous 1D DMA transfer striped across channels.
+ * @param dst The destination address.
+ * @param src The source address.
+ * @param size The size of the transfer in bytes.
+ * @param num_channels The maximum number of channels to use. Clipped to the
+ *                     number of channels of the DMA.
+ * @return A handle to wait for the whole transfer with
+ *         snrt_dma_wait_handle().
+ *
+ * The transfer is split into chunks of equal size, aligned to the DMA bus
+ * width, and at least @ref SNRT_DMA_STRIPE_MIN_SIZE bytes each, so small
+ * transfers use a single channel.
+ */
+inline snrt_dma_handle_t snrt_dma_start_1d_striped(uint64_t dst, uint64_t src,
+                                                   size_t size,
+                                                   uint32_t num_channels) {
+    snrt_dma_handle_t handle = {{0}, 0};
+    if (size == 0) return handle;
+    if (num_channels > SNRT_DMA_NUM_CHANNELS)
+        num_channels = SNRT_DMA_NUM_CHANNELS;
+    if (num_channels == 0) num_channels = 1;
+
+    size_t chunk = (size + num_channels - 1) / num_channels;
+    chunk = (chunk + SNRT_DMA_BEAT_SIZE - 1) & ~(SNRT_DMA_BEAT_SIZE - 1);
+    if (chunk < SNRT_DMA_STRIPE_MIN_SIZE) chunk = SNRT_DMA_STRIPE_MIN_SIZE;
+    uint32_t num_chunks = (size + chunk - 1) / chunk;
+
+    uint32_t channel = snrt_dma_schedule_channels(num_chunks, num_channels);
+    for (uint32_t i = 0; i < num_chunks; i++) {
+        size_t len = size < chunk ? size : chunk;
+        handle.txid[channel] =
+            snrt_dma_start_1d_channel(dst, src, len, channel);
+        handle.mask |= 1 << channel;
+        dst += len;
+        src += len;
+        size -= len;
+        channel = (channel + 1) % num_channels;
+    }
+    return handle;
+}
+
+/**
+ * @brief Start an asynchronous 1D DMA transfer striped across channels, using
+ *        native-size pointers.
+ * @see snrt_dma_start_1d_striped(uint64_t, uint64_t, size_t, uint32_t)
+ */
+inline snrt_dma_handle_t snrt_dma_start_1d_striped(volatile void *dst,
+                                                   volatile void *src,
+                                                   size_t size,
+                                                   uint32_t num_channels) {
+    return snrt_dma_start_1d_striped((uint64_t)dst, (uint64_t)src, size,
+                                     num_channels);
+}
+
+/**
+ * @brief Start an asynchronous 2D DMA transfer striped across channels.
+ * @see snrt_dma_start_2d(uint64_t, uint64_t, size_t, size_t, size_t, size_t,
+ *      uint32_t) for a description of the transfer parameters.
+ * @param num_channels The maximum number of channels to use. Clipped to the
+ *                     number of channels of the DMA.
+ * @return A handle to wait for the whole transfer with
+ *         snrt_dma_wait_handle().
+ *
+ * The 1D transfers are distributed in contiguous groups of equal size over
+ * the channels, each group moving at least @ref SNRT_DMA_STRIPE_MIN_SIZE
+ * bytes.
+ */
+inline snrt_dma_handle_t snrt_dma_start_2d_striped(
+    uint64_t dst, uint64_t src, size_t size, size_t dst_stride,
+    size_t src_stride, size_t repeat, uint32_t num_channels) {
+    snrt_dma_handle_t handle = {{0}, 0};
+    if (size == 0 || repeat == 0) return handle;
+    if (num_channels > SNRT_DMA_NUM_CHANNELS)
+        num_channels = SNRT_DMA_NUM_CHANNELS;
+    if (num_channels == 0) num_channels = 1;
+
+    size_t rows = (repeat + num_channels - 1) / num_channels;
+    size_t min_rows = (SNRT_DMA_STRIPE_MIN_SIZE + size - 1) / size;
+    if (rows < min_rows) rows = min_rows;
+    uint32_t num_chunks = (repeat + rows - 1) / rows;
+
+    uint32_t channel = snrt_dma_schedule_channels(num_chunks, num_channels);
+    for (uint32_t i = 0; i < num_chunks; i++) {
+        size_t n = repeat < rows ? repeat : rows;
+        handle.txid[channel] = snrt_dma_start_2d_channel(
+            dst, src, size, dst_stride, src_stride, n, channel);
+        handle.mask |= 1 << channel;
+        dst += n * dst_stride;
+        src += n * src_stride;
+        repeat -= n;
+        channel = (channel + 1) % num_channels;
+    }
+    return handle;
+}
+
+/**
+ * @brief Start an asynchronous 2D DMA transfer striped across channels, using
+ *        native-size pointers.
+ * @see snrt_dma_start_2d_striped(uint64_t, uint64_t, size_t, size_t, size_t,
+ *      size_t, uint32_t)
+ */
+inline snrt_dma_handle_t snrt_dma_start_2d_striped(
+    volatile void *dst, volatile void *src, size_t size, size_t dst_stride,
+    size_t src_stride, size_t repeat, uint32_t num_channels) {
+    return snrt_dma_start_2d_striped((uint64_t)dst, (uint64_t)src, size,
+                                     dst_stride, src_stride, repeat,
+                                     num_channels);
+}
+
+/**
+ * @brief Check whether all parts of a logical DMA transfer have completed.
+ * @param handle The handle returned when starting the transfer.
+ */
+inline int snrt_dma_handle_done(const snrt_dma_handle_t *handle) {
+    for (uint32_t c = 0; c < SNRT_DMA_NUM_CHANNELS; c++) {
+        if ((handle->mask & (1 << c)) &&
+            snrt_dma_completed_channel(c) < handle->txid[c])
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Block until all parts of a logical DMA transfer have completed.
+ * @param handle The handle returned when starting the transfer.
+ */
+inline void snrt_dma_wait_handle(const snrt_dma_handle_t *handle) {
+    for (uint32_t c = 0; c < SNRT_DMA_NUM_CHANNELS; c++) {
+        if (handle->mask & (1 << c)) {
+            while (snrt_dma_completed_channel(c) < handle->txid[c])
+                ;
+        }
+    }
+}
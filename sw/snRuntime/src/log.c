@@ -0,0 +1,18 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+snrt_log_buffer_t snrt_log_buffers[SNRT_CLUSTER_NUM * SNRT_CLUSTER_CORE_NUM];
+
+extern void snrt_log_write(const char *fmt, const uint32_t *args, uint32_t n);
+
+extern void snrt_log_pack(uint32_t *words, uint32_t &n,
+                          unsigned long long arg);
+
+extern void snrt_log_pack(uint32_t *words, uint32_t &n, long long arg);
+
+extern void snrt_log_pack(uint32_t *words, uint32_t &n, double arg);
+
+extern void snrt_log_pack(uint32_t *words, uint32_t &n, float arg);
+
+extern void snrt_log_pack_all(uint32_t *words, uint32_t &n);
@@ -0,0 +1,150 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file
+ * @brief Deferred binary logging.
+ *
+ * `SNRT_LOG(fmt, ...)` records the address of its format string, the value of
+ * `mcycle` and its raw arguments in a per-hart ring buffer in L3. Unlike
+ * `printf`, it neither formats the message nor synchronizes with the host or
+ * the other harts, so it barely perturbs the timing of the code under test.
+ * The records are formatted on the host by `util/trace/snrt_log.py`, which
+ * looks up the format strings in the binary.
+ *
+ * Arguments are stored as 32-bit words, except for 64-bit integers and
+ * floating-point values (promoted to double), which take two words. Strings
+ * can only be decoded if they are stored in the binary.
+ */
+
+#pragma once
+
+/**
+ * @brief Capacity of each hart's ring buffer, in 32-bit words. When the buffer
+ * is full, the oldest records are overwritten.
+ */
+#ifndef SNRT_LOG_BUF_LEN
+#define SNRT_LOG_BUF_LEN 256
+#endif
+
+/**
+ * @brief Number of words preceding the arguments of a record: the address of
+ * the format string, `mcycle` and the number of argument words.
+ */
+#define SNRT_LOG_HDR_LEN 3
+
+/**
+ * @brief Ring buffer of a hart. `head` and `tail` count the words written
+ * since the start of the program, up to the end of the newest record and from
+ * the start of the oldest one, respectively.
+ */
+typedef struct {
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    uint32_t len;
+    volatile uint32_t dropped;
+    uint32_t data[SNRT_LOG_BUF_LEN];
+} snrt_log_buffer_t;
+
+/**
+ * @brief Ring buffers of all harts, indexed by `snrt_global_core_idx()`.
+ */
+extern snrt_log_buffer_t
+    snrt_log_buffers[SNRT_CLUSTER_NUM * SNRT_CLUSTER_CORE_NUM];
+
+/**
+ * @brief Append a record to the ring buffer of the calling hart.
+ *
+ * @param fmt The format string.
+ * @param args The argument words.
+ * @param n The number of argument words.
+ */
+inline void snrt_log_write(const char *fmt, const uint32_t *args, uint32_t n) {
+    snrt_log_buffer_t *buf = &snrt_log_buffers[snrt_global_core_idx()];
+    uint32_t head = buf->head;
+    uint32_t size = SNRT_LOG_HDR_LEN + n;
+    if (size > SNRT_LOG_BUF_LEN) return;
+
+    // Make room, dropping the oldest records
+    uint32_t tail = buf->tail;
+    while (head + size - tail > SNRT_LOG_BUF_LEN) {
+        tail += SNRT_LOG_HDR_LEN + buf->data[(tail + 2) % SNRT_LOG_BUF_LEN];
+        buf->dropped++;
+    }
+    buf->tail = tail;
+    buf->len = SNRT_LOG_BUF_LEN;
+
+    buf->data[head % SNRT_LOG_BUF_LEN] = (uint32_t)fmt;
+    buf->data[(head + 1) % SNRT_LOG_BUF_LEN] = snrt_mcycle();
+    buf->data[(head + 2) % SNRT_LOG_BUF_LEN] = n;
+    for (uint32_t i = 0; i < n; i++)
+        buf->data[(head + SNRT_LOG_HDR_LEN + i) % SNRT_LOG_BUF_LEN] = args[i];
+    // Publish the record to hosts reading the buffer during the run
+    __atomic_store_n(&buf->head, head + size, __ATOMIC_RELEASE);
+}
+
+template <typename T>
+inline void snrt_log_pack(uint32_t *words, uint32_t &n, T arg) {
+    words[n++] = (uint32_t)arg;
+}
+
+template <typename T>
+inline void snrt_log_pack(uint32_t *words, uint32_t &n, T *arg) {
+    words[n++] = (uint32_t)arg;
+}
+
+inline void snrt_log_pack(uint32_t *words, uint32_t &n,
+                          unsigned long long arg) {
+    words[n++] = (uint32_t)arg;
+    words[n++] = (uint32_t)(arg >> 32);
+}
+
+inline void snrt_log_pack(uint32_t *words, uint32_t &n, long long arg) {
+    snrt_log_pack(words, n, (unsigned long long)arg);
+}
+
+inline void snrt_log_pack(uint32_t *words, uint32_t &n, double arg) {
+    unsigned long long bits;
+    __builtin_memcpy(&bits, &arg, sizeof(bits));
+    snrt_log_pack(words, n, bits);
+}
+
+inline void snrt_log_pack(uint32_t *words, uint32_t &n, float arg) {
+    snrt_log_pack(words, n, (double)arg);
+}
+
+inline void snrt_log_pack_all(uint32_t *words, uint32_t &n) {}
+
+template <typename T, typename... Args>
+inline void snrt_log_pack_all(uint32_t *words, uint32_t &n, T arg,
+                              Args... args) {
+    snrt_log_pack(words, n, arg);
+    snrt_log_pack_all(words, n, args...);
+}
+
+/**
+ * @brief Pack the arguments of a log record and append it to the ring buffer
+ * of the calling hart. Use through `SNRT_LOG()`, which places the format
+ * string where the host decoder expects it.
+ */
+template <typename... Args>
+inline void snrt_log(const char *fmt, Args... args) {
+    uint32_t words[2 * sizeof...(Args) + 1];
+    uint32_t n = 0;
+    snrt_log_pack_all(words, n, args...);
+    snrt_log_write(fmt, words, n);
+}
+
+/**
+ * @brief Log a message, with `printf` syntax, to be formatted on the host.
+ *
+ * The format string must be a literal. It is stored in the `.rodata.snrt_log`
+ * section, and its address identifies the message.
+ */
+#define SNRT_LOG(fmt, ...)                                                 \
+    do {                                                                   \
+        static const char _snrt_log_fmt[]                                  \
+            __attribute__((section(".rodata.snrt_log"), used)) = fmt;      \
+        snrt_log(_snrt_log_fmt, ##__VA_ARGS__);                            \
+    } while (0)
@@ -3,7 +3,6 @@
 // SPDX-License-Identifier: Apache-2.0
 
 __thread volatile eu_t *eu_p;
-volatile eu_t *volatile eu_p_global;
 
 extern void eu_init(void);
 extern void eu_exit(uint32_t core_idx);
@@ -16,8 +16,9 @@
  * @brief Define EU_USE_GLOBAL_CLINT to use the cluster-shared CLINT based SW
  * interrupt system for synchronization. If not defined, the harts use the
  * cluster-local CLINT to syncrhonize which is faster but only works for
- * cluster-local synchronization which is sufficient at the moment since the
- * OpenMP runtime is single cluster only.
+ * cluster-local synchronization. This is sufficient since a team spanning
+ * multiple clusters is forked and joined by the first core of each cluster,
+ * which synchronizes with the cores of its own cluster only.
  *
  */
 // #define EU_USE_GLOBAL_CLINT
@@ -51,12 +52,6 @@
  */
 extern __thread volatile eu_t *eu_p;
 
-/**
- * @brief Pointer to where the DM struct in TCDM is located
- *
- */
-extern volatile eu_t *volatile eu_p_global;
-
 //================================================================================
 // Functions
 //================================================================================
@@ -169,12 +164,12 @@ inline void eu_init(void) {
         // Allocate the eu struct in L1 for fast access
         eu_p = (eu_t *)snrt_l1_alloc(sizeof(eu_t));
         memset((void *)eu_p, 0, sizeof(eu_t));
-        // store copy of eu_p on shared memory
-        eu_p_global = eu_p;
+        // publish eu_p to the other cores of the cluster
+        cls()->eu_p = (void *)eu_p;
     } else {
-        while (!eu_p_global)
+        while (!cls()->eu_p)
             ;
-        eu_p = eu_p_global;
+        eu_p = (volatile eu_t *)cls()->eu_p;
     }
 }
 
@@ -19,15 +19,6 @@ extern "C" {
 typedef void (*__task_type32)(_kmp_ptr32, _kmp_ptr32, _kmp_ptr32);
 typedef void (*__task_type64)(_kmp_ptr64, _kmp_ptr64, _kmp_ptr64);
 
-/**
- * @brief Usually the arguments passed to __kmpc_fork_call would do a malloc
- * with the amount of arguments passed. This is too slow for our case and thus
- * we reserve a chunk of arguments in TCDM and use it. This limits the maximum
- * number of arguments
- *
- */
-_kmp_ptr32 *kmpc_args;
-
 static void __microtask_wrapper(void *arg, uint32_t argc) {
     kmp_int32 id = omp_get_thread_num();
     kmp_int32 *id_addr = (kmp_int32 *)(&id);
@@ -93,6 +84,9 @@ static void __microtask_wrapper(void *arg, uint32_t argc) {
                p_argv[10], p_argv[11]);
             break;
     }
+    // Complete the tasks of the region before leaving it. Cores done with
+    // their part steal pending tasks instead of going to sleep.
+    omp_task_drain();
     // for performance tracking in traces
     cycle = read_csr(mcycle);
 }
@@ -115,21 +109,21 @@ will be a unique thread identifier among all the threads created by
 the OpenMP runtime (but the value cannot be defined in terms of
 OpenMP thread ids returned by omp_get_thread_num()).
 */
-// kmp_int32 __kmpc_global_thread_num(ident_t *loc) {
-//     (void)loc;
-//     // return csr value of hartware thread ID
-//     kmp_int32 gtid = read_csr(mhartid);
-//     KMP_PRINTF(10, "__kmpc_global_thread_num: T#%d\n", gtid);
-//     return gtid;
-// }
+kmp_int32 __kmpc_global_thread_num(ident_t *loc) {
+    (void)loc;
+    // Same thread number as passed to the microtasks, required by constructs
+    // outside of the lexical scope of a parallel region, e.g. tasks
+    kmp_int32 gtid = omp_get_thread_num();
+    KMP_PRINTF(10, "__kmpc_global_thread_num: T#%d\n", gtid);
+    return gtid;
+}
 
 void __kmpc_barrier(ident_t *loc, kmp_int32 tid) {
     (void)loc;
     (void)tid;
-    _OMP_T *_this = omp_getData();
-    uint32_t ret;
-    KMP_PRINTF(50, "barrier numThreads: %d\n", (uint32_t)_this->numThreads);
-    snrt_partial_barrier(_this->kmpc_barrier, (uint32_t)_this->numThreads);
+    KMP_PRINTF(50, "barrier numThreads: %d\n",
+               (uint32_t)omp_getData()->numThreads);
+    omp_team_barrier();
 }
 
 /*!
@@ -157,6 +151,78 @@ This call is only required if the parallel construct has a `num_threads` clause.
 // #endif
 // }
 
+#ifndef OMPSTATIC_NUMTHREADS
+/**
+ * @brief Prepare this cluster for a parallel region of a team spanning
+ * multiple clusters, some of which may not have taken part in the previous
+ * regions. Reductions resume from the sequence number `reduce_seq` of the
+ * first cluster in all clusters, and the cores resume the numbering of
+ * dynamically scheduled loops from the last loop of the team.
+ * @details The flags left in the reduction slots by the previous regions
+ * hold at most `reduce_seq`, so they are never mistaken for partials of this
+ * region, even if the first cluster reads them before this cluster is set up.
+ */
+static void __kmp_cluster_fork_setup(omp_t *omp, uint32_t reduce_seq) {
+    for (int i = 0; i < omp->numThreads; i++)
+        omp->reduce_slots[i].seq = reduce_seq;
+    int epoch = omp_get_team(omp)->loop_epoch;
+    for (int i = 0; i < omp->numThreads; i++)
+        omp->plainTeam.core_epoch[i] = epoch;
+}
+
+/**
+ * @brief Fork a parallel region across the clusters of the team, and join
+ * them.
+ */
+static void __kmp_fork_clusters(omp_t *omp, kmp_int32 argc) {
+    omp_global.argc = argc;
+    for (int i = 0; i <= argc; i++) omp_global.args[i] = omp->kmpc_args[i];
+    omp_global.join_count = 0;
+    // All cores of the first cluster take part in every reduction
+    omp_global.reduce_seq = omp->reduce_slots[0].seq;
+    __kmp_cluster_fork_setup(omp, omp_global.reduce_seq);
+
+    __atomic_add_fetch(&omp_global.fork_epoch, 1, __ATOMIC_RELEASE);
+    omp_wake_clusters(omp->num_clusters);
+    parallelRegion(argc, omp->kmpc_args, __microtask_wrapper, omp->numThreads);
+
+    while (__atomic_load_n(&omp_global.join_count, __ATOMIC_ACQUIRE) !=
+           omp->num_clusters - 1)
+        ;
+}
+
+/**
+ * @brief Serve the parallel regions forked by core 0 of cluster 0, on core 0
+ * of the other clusters, until omp_exit_clusters is called.
+ * @details The core sleeps until woken up through its cluster CLINT, and then
+ * runs the region with the cores of its cluster if the team spans it.
+ */
+void omp_cluster_loop(void) {
+    omp_t *omp = omp_getData();
+    uint32_t epoch = 0;
+
+    snrt_interrupt_enable(IRQ_M_CLUSTER);
+    while (1) {
+        snrt_wfi();
+        snrt_int_clr_mcip();
+        if (omp_global.exit_flag) break;
+        if (__atomic_load_n(&omp_global.fork_epoch, __ATOMIC_ACQUIRE) == epoch)
+            continue;
+        epoch = omp_global.fork_epoch;
+        if (omp->cluster_idx >= omp_global.num_clusters) continue;
+
+        omp->num_clusters = omp_global.num_clusters;
+        kmp_int32 argc = omp_global.argc;
+        for (int i = 0; i <= argc; i++) omp->kmpc_args[i] = omp_global.args[i];
+        __kmp_cluster_fork_setup(omp, omp_global.reduce_seq);
+        parallelRegion(argc, omp->kmpc_args, __microtask_wrapper,
+                       omp->numThreads);
+        __atomic_add_fetch(&omp_global.join_count, 1, __ATOMIC_RELEASE);
+    }
+    snrt_interrupt_disable(IRQ_M_CLUSTER);
+}
+#endif
+
 /*!
 @ingroup PARALLEL
 @param loc  source location information
@@ -176,6 +242,7 @@ void __kmpc_fork_call(ident_t *loc, kmp_int32 argc, kmpc_micro microtask, ...) {
     va_list vl;
     int arg_size = 0;
     arg_size = (argc + 1) * sizeof(_kmp_ptr32);
+    _kmp_ptr32 *kmpc_args = omp->kmpc_args;
 
     // Do not alloc for argument pointers but use the statically alllocated
     // kmpc_args
@@ -207,12 +274,35 @@ void __kmpc_fork_call(ident_t *loc, kmp_int32 argc, kmpc_micro microtask, ...) {
         (void)eu_dispatch_push(__microtask_wrapper, argc, kmpc_args,
                                omp->numThreads);
     } else {
+#ifndef OMPSTATIC_NUMTHREADS
+        // All threads of the previous regions are done with their loops. The
+        // count must match the size of this team, as the previous regions may
+        // have spanned a different number of clusters.
+        omp_get_team(omp)->loop_done = omp->numThreads * omp->num_clusters;
+        if (omp->num_clusters > 1) {
+            __kmp_fork_clusters(omp, argc);
+            return;
+        }
+#endif
         parallelRegion(argc, kmpc_args, __microtask_wrapper, omp->numThreads);
     }
 
     // rt_free(args);
 }
 
+/**
+ * @brief Split `size` iterations evenly into `parts` contiguous parts, and
+ * return the first iteration and the number of iterations of part `idx`.
+ */
+static inline void __kmp_static_split(kmp_uint32 size, kmp_uint32 parts,
+                                      kmp_uint32 idx, kmp_uint32 *first,
+                                      kmp_uint32 *count) {
+    kmp_uint32 base = size / parts;
+    kmp_uint32 leftOver = size - base * parts;
+    *count = base + (idx < leftOver);
+    *first = idx * base + (idx < leftOver ? idx : leftOver);
+}
+
 /*!
 @ingroup WORK_SHARING
 @param    loc       Source code location
@@ -271,23 +361,24 @@ void __kmpc_for_static_init_4(ident_t *loc, kmp_int32 gtid,
     // no specified chunk size
     else if (sched == kmp_sch_static) {
         KMP_PRINTF(50, "    sched: static\n");
-        chunk = loopSize / team->nbThreads;
-        int leftOver = loopSize - chunk * team->nbThreads;
-
-        // calculate precise chunk size and lower and upper bound
-        if ((int)threadNum < leftOver) {
-            chunk++;
-            *plower = *plower + threadNum * chunk * incr;
-        } else
-            *plower = *plower + threadNum * chunk * incr + leftOver;
+        // Split the iterations evenly among the clusters of the team, and the
+        // share of each cluster evenly among its threads, such that every
+        // cluster works on a contiguous range of iterations
+        kmp_uint32 clusterFirst, clusterSize, first, size;
+        __kmp_static_split(loopSize, omp->num_clusters, omp->cluster_idx,
+                           &clusterFirst, &clusterSize);
+        __kmp_static_split(clusterSize, omp->numThreads,
+                           snrt_cluster_core_idx(), &first, &size);
+        chunk = size;
+        *plower = *plower + (clusterFirst + first) * incr;
         *pupper = *plower + chunk * incr - incr;
 
         if (plastiter != NULL)
             *plastiter = (*pupper == globalUpper && *plower <= globalUpper);
         *pstride = loopSize;
 
-        KMP_PRINTF(50, "    team thds: %d chunk: %d leftOver: %d\n",
-                   team->nbThreads, chunk, leftOver);
+        KMP_PRINTF(50, "    team thds: %d clusters: %d chunk: %d\n",
+                   team->nbThreads, omp->num_clusters, chunk);
     }
 
     KMP_PRINTF(10,
@@ -384,12 +475,156 @@ void __kmpc_for_static_fini(ident_t *loc, kmp_int32 globaltid) {
 //                *plastiter, *plower, *pupper, incr, *pstride, chunk);
 // }
 
+//================================================================================
+// Reductions
+//================================================================================
+
+static void __kmp_reduce_combine(omp_reduce_slot_t *dst,
+                                 omp_reduce_slot_t *src) {
+    dst->func(dst->data, src->data);
+}
+
+/*!
+@ingroup SYNCHRONIZATION
+@param loc source location information.
+@param global_tid global thread number.
+@param num_vars number of items (variables) to be reduced
+@param reduce_size size of data in bytes to be reduced
+@param reduce_data pointer to data to be reduced
+@param reduce_func callback function providing reduction operation on two
+operands and returning result of reduction in lhs_data
+@param lck pointer to the unique lock data structure
+@result 1 for the master thread, 0 for all other team threads
+
+The nowait version is used for a reduce clause with the nowait argument.
+
+The private copies of all threads are combined in a tree in TCDM (see
+omp_reduce_tree), such that the master thread ends up with the reduction of
+all private copies, which the compiler-generated code then combines into the
+shared variables. The other threads return once their private copies have been
+consumed.
+*/
+kmp_int32 __kmpc_reduce_nowait(ident_t *loc, kmp_int32 global_tid,
+                               kmp_int32 num_vars, size_t reduce_size,
+                               void *reduce_data, kmp_reduce_func reduce_func,
+                               kmp_critical_name *lck) {
+    (void)loc;
+    (void)num_vars;
+    (void)reduce_size;
+    (void)lck;
+    _OMP_T *omp = omp_getData();
+    omp_reduce_slot_t *slot = &omp->reduce_slots[snrt_cluster_core_idx()];
+
+    KMP_PRINTF(10, "__kmpc_reduce_nowait gtid %d num_vars %d\n", global_tid,
+               num_vars);
+    slot->data = reduce_data;
+    slot->func = reduce_func;
+    return omp_reduce_tree(__kmp_reduce_combine, 1);
+}
+
+/*!
+@ingroup SYNCHRONIZATION
+@param loc source location information
+@param global_tid global thread id.
+@param lck pointer to the unique lock data structure
+
+Finish the execution of a reduce nowait.
+*/
+void __kmpc_end_reduce_nowait(ident_t *loc, kmp_int32 global_tid,
+                              kmp_critical_name *lck) {
+    (void)loc;
+    (void)global_tid;
+    (void)lck;
+}
+
+/*!
+@ingroup SYNCHRONIZATION
+@param loc source location information.
+@param global_tid global thread number.
+@param num_vars number of items (variables) to be reduced
+@param reduce_size size of data in bytes to be reduced
+@param reduce_data pointer to data to be reduced
+@param reduce_func callback function providing reduction operation on two
+operands and returning result of reduction in lhs_data
+@param lck pointer to the unique lock data structure
+@result 1 for the master thread, 0 for all other team threads
+
+A blocking reduce that includes an implicit barrier: the other threads only
+return once the master thread has updated the shared variables and called
+__kmpc_end_reduce.
+*/
+kmp_int32 __kmpc_reduce(ident_t *loc, kmp_int32 global_tid, kmp_int32 num_vars,
+                        size_t reduce_size, void *reduce_data,
+                        kmp_reduce_func reduce_func, kmp_critical_name *lck) {
+    kmp_int32 master = __kmpc_reduce_nowait(loc, global_tid, num_vars,
+                                            reduce_size, reduce_data,
+                                            reduce_func, lck);
+    if (!master) __kmpc_barrier(loc, global_tid);
+    return master;
+}
+
+/*!
+@ingroup SYNCHRONIZATION
+@param loc source location information
+@param global_tid global thread id.
+@param lck pointer to the unique lock data structure
+
+Finish the execution of a blocking reduce, releasing the other threads.
+*/
+void __kmpc_end_reduce(ident_t *loc, kmp_int32 global_tid,
+                       kmp_critical_name *lck) {
+    (void)lck;
+    __kmpc_barrier(loc, global_tid);
+}
+
 //================================================================================
 // Dynamic scheduling
 // Only available if not OMPSTATIC_NUMTHREADS
 //================================================================================
 #ifndef OMPSTATIC_NUMTHREADS
 
+/**
+ * @brief Wait until the loop with number `epoch` is set up, setting it up if
+ * this thread is the first of the team to encounter it.
+ *
+ * The thread setting up a loop first waits for all threads to run out of
+ * iterations in the previous loop, which they may still be executing if it
+ * had a `nowait` clause.
+ */
+static void __kmp_dispatch_setup(omp_team_t *team, int epoch,
+                                 enum sched_type schedule, kmp_int32 lb,
+                                 kmp_int32 ub, kmp_int32 st, kmp_int32 chunk) {
+    int expected = epoch - 1;
+    if (__atomic_compare_exchange_n(&team->loop_setup_epoch, &expected, epoch,
+                                    0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        if (epoch > 1) {
+            while ((uint32_t)__atomic_load_n(&team->loop_done,
+                                             __ATOMIC_ACQUIRE) !=
+                   team->nbThreads)
+                ;
+        }
+        team->loop_done = 0;
+        team->loop_next = 0;
+        team->loop_start = lb;
+        if ((st > 0 && ub < lb) || (st < 0 && ub > lb))
+            team->loop_trip = 0;
+        else
+            team->loop_trip = (ub - lb) / st + 1;
+        team->loop_incr = st;
+        team->loop_chunk = chunk > 0 ? chunk : 1;
+        team->loop_sched = schedule;
+        KMP_PRINTF(10,
+                   "__kmpc_dispatch_init_4 setup: epoch %d start %d trip %d "
+                   "incr %d chunk %d sched %d\n",
+                   epoch, team->loop_start, team->loop_trip, team->loop_incr,
+                   team->loop_chunk, team->loop_sched);
+        __atomic_store_n(&team->loop_epoch, epoch, __ATOMIC_RELEASE);
+    } else {
+        while (__atomic_load_n(&team->loop_epoch, __ATOMIC_ACQUIRE) != epoch)
+            ;
+    }
+}
+
 /*!
 @ingroup WORK_SHARING
 @{
@@ -404,50 +639,49 @@ void __kmpc_for_static_fini(ident_t *loc, kmp_int32 globaltid) {
 This function prepares the runtime to start a dynamically scheduled for loop,
 saving the loop arguments.
 These functions are all identical apart from the types of the arguments.
+
+Iterations are handed out from a counter in the team struct in TCDM, which is
+advanced with atomic memory operations. `schedule(dynamic, chunk)` hands out
+chunks of `chunk` iterations. `schedule(guided, chunk)` hands out chunks of
+half the remaining iterations divided by the number of threads, but no less
+than `chunk` iterations. Any other schedule is treated as dynamic.
 */
-// void __kmpc_dispatch_init_4(ident_t *loc, kmp_int32 gtid,
-//                             enum sched_type schedule, kmp_int32 lb,
-//                             kmp_int32 ub, kmp_int32 st, kmp_int32 chunk) {
-//     (void)loc;
-//     (void)gtid;
-//     (void)schedule;
-//     omp_team_t *team = omp_get_team(omp_getData());
-//     // dynLoopInitNoIter(team, lb, ub, st, chunk);
-//     // int core_id = omp_get_thread_num();
-//     eu_mutex_lock();
-//     // if (team->loop_epoch - team->core_epoch[core_id] != 0)
-//     // {
-//     //   eu_mutex_release();
-//     //   team->core_epoch[core_id]++;
-//     //   KMP_PRINTF(10, "__kmpc_dispatch_init_4 core_epoch[%d] =
-//     //   %d\n",core_id,team->core_epoch[core_id]); return;
-//     // }
-
-//     if (!team->loop_is_setup) {
-//         team->loop_is_setup = 1;
-//         team->loop_start = lb;
-//         team->loop_end = ub;
-//         team->loop_incr = st;
-//         team->loop_chunk = chunk;
-//         KMP_PRINTF(
-//             10,
-//             "__kmpc_dispatch_init_4 setup: start %d end %d incr %d chunk
-//             %d\n", team->loop_start, team->loop_end, team->loop_incr,
-//             team->loop_chunk);
-//     }
-//     eu_mutex_release();
-// }
+void __kmpc_dispatch_init_4(ident_t *loc, kmp_int32 gtid,
+                            enum sched_type schedule, kmp_int32 lb,
+                            kmp_int32 ub, kmp_int32 st, kmp_int32 chunk) {
+    (void)loc;
+    (void)gtid;
+    omp_t *omp = omp_getData();
+    omp_team_t *team = omp_get_team(omp);
+    // Loops are numbered per core in the core's own cluster
+    int *core_epoch = &omp->plainTeam.core_epoch[snrt_cluster_core_idx()];
+
+    schedule = SCHEDULE_WITHOUT_MODIFIERS(schedule);
+    if (schedule == kmp_sch_guided_chunked ||
+        schedule == kmp_sch_guided_iterative_chunked ||
+        schedule == kmp_sch_guided_analytical_chunked ||
+        schedule == kmp_sch_guided_simd)
+        schedule = kmp_sch_guided_chunked;
+    else
+        schedule = kmp_sch_dynamic_chunked;
+
+    KMP_PRINTF(10,
+               "__kmpc_dispatch_init_4 gtid %d sched %d [%d, %d] incr %d "
+               "chunk %d\n",
+               gtid, schedule, lb, ub, st, chunk);
+    __kmp_dispatch_setup(team, ++*core_epoch, schedule, lb, ub, st, chunk);
+}
 
 /*!
 See @ref __kmpc_dispatch_init_4
 */
-// void __kmpc_dispatch_init_4u(ident_t *loc, kmp_int32 gtid,
-//                              enum sched_type schedule, kmp_uint32 lb,
-//                              kmp_uint32 ub, kmp_int32 st, kmp_int32 chunk) {
-//     kmp_int32 ilb = (kmp_int32)lb;
-//     kmp_int32 iub = (kmp_int32)ub;
-//     __kmpc_dispatch_init_4(loc, gtid, schedule, ilb, iub, st, chunk);
-// }
+void __kmpc_dispatch_init_4u(ident_t *loc, kmp_int32 gtid,
+                             enum sched_type schedule, kmp_uint32 lb,
+                             kmp_uint32 ub, kmp_int32 st, kmp_int32 chunk) {
+    kmp_int32 ilb = (kmp_int32)lb;
+    kmp_int32 iub = (kmp_int32)ub;
+    __kmpc_dispatch_init_4(loc, gtid, schedule, ilb, iub, st, chunk);
+}
 
 /*!
 @param loc Source code location
@@ -462,60 +696,350 @@ otherwise
 Get the next dynamically allocated chunk of work for this thread.
 If there is no more work, then the lb,ub and stride need not be modified.
 */
-// int __kmpc_dispatch_next_4(ident_t *loc, kmp_int32 gtid, kmp_int32 *p_last,
-//                            kmp_int32 *p_lb, kmp_int32 *p_ub, kmp_int32 *p_st)
-//                            {
-//     (void)loc;
-//     (void)gtid;
+int __kmpc_dispatch_next_4(ident_t *loc, kmp_int32 gtid, kmp_int32 *p_last,
+                           kmp_int32 *p_lb, kmp_int32 *p_ub, kmp_int32 *p_st) {
+    (void)loc;
+    (void)gtid;
+    omp_team_t *team = omp_get_team(omp_getData());
+    int trip = team->loop_trip;
+    int chunk = team->loop_chunk;
+    int first;
 
-//     omp_team_t *team = omp_get_team(omp_getData());
+    if (team->loop_sched == kmp_sch_guided_chunked) {
+        // The chunk size depends on the remaining iterations, so claim it
+        // with a compare-and-swap.
+        first = __atomic_load_n(&team->loop_next, __ATOMIC_RELAXED);
+        do {
+            int remaining = trip - first;
+            if (remaining <= 0) break;
+            int size = remaining / (int)(2 * team->nbThreads);
+            if (size < team->loop_chunk) size = team->loop_chunk;
+            chunk = size < remaining ? size : remaining;
+        } while (!__atomic_compare_exchange_n(&team->loop_next, &first,
+                                              first + chunk, 1,
+                                              __ATOMIC_RELAXED,
+                                              __ATOMIC_RELAXED));
+    } else {
+        first = __atomic_fetch_add(&team->loop_next, chunk, __ATOMIC_RELAXED);
+    }
 
-//     // The stride is actually always 1
-//     *p_st = 1;
+    // No more work, signal that this thread is done with the loop
+    if (first >= trip) {
+        KMP_PRINTF(10, "__kmpc_dispatch_next_4 done\n");
+        __atomic_add_fetch(&team->loop_done, 1, __ATOMIC_RELEASE);
+        return 0;
+    }
 
-//     // int result = dynLoopIter(team, (int*) p_lb, (int*) p_ub, (int*)
-//     p_last); eu_mutex_lock();
+    int last = first + chunk >= trip ? trip - 1 : first + chunk - 1;
+    *p_lb = team->loop_start + first * team->loop_incr;
+    *p_ub = team->loop_start + last * team->loop_incr;
+    *p_st = team->loop_incr;
+    if (p_last != NULL) *p_last = last == trip - 1;
+    KMP_PRINTF(10, "__kmpc_dispatch_next_4 : last: %d [l %4d u %4d s %4d]\n",
+               last == trip - 1, *p_lb, *p_ub, *p_st);
+    return 1;
+}
 
-//     // have already iterated over all the iterations(no more work), return 0
-//     if (team->loop_start > team->loop_end) {
-//         team->loop_is_setup = 0;
-//         KMP_PRINTF(
-//             10, "__kmpc_dispatch_next_4 start > end: team->loop_is_setup
-//             %d\n", team->loop_is_setup);
-//         eu_mutex_release();
-//         return 0;
-//     }
+/*!
+See @ref __kmpc_dispatch_next_4
+*/
+int __kmpc_dispatch_next_4u(ident_t *loc, kmp_int32 gtid, kmp_int32 *p_last,
+                            kmp_uint32 *p_lb, kmp_uint32 *p_ub,
+                            kmp_int32 *p_st) {
+    kmp_int32 p_lbi = *p_lb;
+    kmp_int32 p_ubi = *p_ub;
+    int ret = __kmpc_dispatch_next_4(loc, gtid, p_last, &p_lbi, &p_ubi, p_st);
+    *p_lb = p_lbi;
+    *p_ub = p_ubi;
+    return ret;
+}
 
-//     *p_lb = team->loop_start;
-//     *p_ub = *p_lb + team->loop_chunk - 1;
-//     if (*p_ub >= team->loop_end) {
-//         *p_ub = team->loop_end;
-//         *p_last = 1;
-//     }
+/*!
+@param loc Source code location
+@param gtid Global thread id
 
-//     team->loop_start += team->loop_chunk;
-//     KMP_PRINTF(10,
-//                "__kmpc_dispatch_next_4 : last: %d [l %4d u %4d s %4d] "
-//                "team->loop_start %d\n",
-//                *p_last, *p_lb, *p_ub, *p_st, team->loop_start);
-//     eu_mutex_release();
-//     return 1;
-// }
+Mark the end of a dynamically scheduled chunk of an ordered loop. Ordered
+loops are not supported, so there is nothing to do.
+*/
+void __kmpc_dispatch_fini_4(ident_t *loc, kmp_int32 gtid) {
+    (void)loc;
+    (void)gtid;
+}
 
 /*!
-See @ref __kmpc_dispatch_next_4
+See @ref __kmpc_dispatch_fini_4
 */
-// int __kmpc_dispatch_next_4u(ident_t *loc, kmp_int32 gtid, kmp_int32 *p_last,
-//                             kmp_uint32 *p_lb, kmp_uint32 *p_ub,
-//                             kmp_int32 *p_st) {
-//     kmp_int32 p_lbi = *p_lb;
-//     kmp_int32 p_ubi = *p_ub;
-//     int ret = __kmpc_dispatch_next_4(loc, gtid, p_last, &p_lbi, &p_ubi,
-//     p_st); *p_lb = p_lbi; *p_ub = p_ubi; return ret;
-// }
+void __kmpc_dispatch_fini_4u(ident_t *loc, kmp_int32 gtid) {
+    __kmpc_dispatch_fini_4(loc, gtid);
+}
+/*! @} */
 
 #endif  // #ifndef OMPSTATIC_NUMTHREADS
 
+//================================================================================
+// Master and single constructs
+//================================================================================
+
+/*!
+@ingroup WORK_SHARING
+@param loc  source location information.
+@param global_tid  global thread number.
+@return 1 if this thread should execute the <tt>master</tt> block, 0 otherwise.
+*/
+kmp_int32 __kmpc_master(ident_t *loc, kmp_int32 global_tid) {
+    (void)loc;
+    (void)global_tid;
+    return omp_get_thread_num() == 0;
+}
+
+void __kmpc_end_master(ident_t *loc, kmp_int32 global_tid) {
+    (void)loc;
+    (void)global_tid;
+}
+
+/*!
+@ingroup WORK_SHARING
+@param loc  source location information
+@param global_tid  global thread number
+@return One if this thread should execute the single construct, zero otherwise.
+
+The <tt>single</tt> block is executed by thread 0, which spares the team an
+election. The compiler emits the barrier following the construct.
+*/
+kmp_int32 __kmpc_single(ident_t *loc, kmp_int32 global_tid) {
+    return __kmpc_master(loc, global_tid);
+}
+
+void __kmpc_end_single(ident_t *loc, kmp_int32 global_tid) {
+    (void)loc;
+    (void)global_tid;
+}
+
+//================================================================================
+// Tasking
+//================================================================================
+
+/**
+ * @brief Drop a reference to a task descriptor, returning it to the pool
+ * when the task and all its children have completed.
+ */
+static inline void __kmp_task_release(omp_tasking_t *tasking,
+                                      omp_task_desc_t *desc) {
+    if (!__atomic_sub_fetch(&desc->refs, 1, __ATOMIC_ACQ_REL))
+        omp_task_desc_free(tasking, desc);
+}
+
+/**
+ * @brief Execute a task on the calling core, as a child of the task it is
+ * currently executing, and complete it.
+ */
+static void __kmp_task_run(omp_tasking_t *tasking, omp_task_desc_t *desc,
+                           kmp_int32 gtid) {
+    omp_task_desc_t **current = &tasking->current[snrt_cluster_core_idx()];
+    omp_task_desc_t *encountering = *current;
+    *current = desc;
+    desc->task.routine(gtid, &desc->task);
+    if (desc->flags & KMP_TASK_FLAG_DESTRUCTORS)
+        desc->task.data1.destructors(gtid, &desc->task);
+    *current = encountering;
+
+    omp_task_desc_t *parent = desc->parent;
+    __kmp_task_release(tasking, desc);
+    __kmp_task_release(tasking, parent);
+}
+
+/**
+ * @brief Execute one task, popped from the calling core's deque or, if
+ * empty, stolen from the deque of another core of the cluster.
+ * @return 1 if a task was executed, 0 if none was found
+ */
+static int __kmp_task_schedule(omp_tasking_t *tasking, kmp_int32 gtid) {
+    unsigned core_idx = snrt_cluster_core_idx();
+    unsigned n = omp_getData()->numThreads;
+    omp_task_desc_t *desc = omp_task_deque_pop(&tasking->deque[core_idx]);
+    for (unsigned i = 1; !desc && i < n; i++)
+        desc = omp_task_deque_steal(&tasking->deque[(core_idx + i) % n]);
+    if (!desc) return 0;
+
+    __kmp_task_run(tasking, desc, gtid);
+    __atomic_sub_fetch(&tasking->pending, 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/**
+ * @brief Execute tasks until no task of the cluster is pending, e.g. at a
+ * barrier. Tasks are counted as pending before their parent completes, so
+ * the count only drops to zero once all tasks have completed.
+ */
+void omp_task_drain(void) {
+    omp_tasking_t *tasking = omp_getData()->tasking;
+    kmp_int32 gtid = omp_get_thread_num();
+    while (__atomic_load_n(&tasking->pending, __ATOMIC_ACQUIRE))
+        __kmp_task_schedule(tasking, gtid);
+}
+
+/*!
+@ingroup TASKING
+@param loc_ref  source location information
+@param gtid  global thread number
+@param flags  tasking flags, see KMP_TASK_FLAG_*
+@param sizeof_kmp_task_t  size of the task structure, including the private
+variables
+@param sizeof_shareds  size of the shared variable pointers
+@param task_entry  compiler-generated entry point of the task
+@return the task structure, to be filled in by the compiler
+
+Allocate a task descriptor from the cluster's pool in TCDM. The task is a
+child of the task the calling core is executing.
+*/
+kmp_task_t *__kmpc_omp_task_alloc(ident_t *loc_ref, kmp_int32 gtid,
+                                  kmp_int32 flags, size_t sizeof_kmp_task_t,
+                                  size_t sizeof_shareds,
+                                  kmp_routine_entry_t task_entry) {
+    (void)loc_ref;
+    (void)gtid;
+    omp_tasking_t *tasking = omp_getData()->tasking;
+    unsigned core_idx = snrt_cluster_core_idx();
+    size_t shareds_offset = (sizeof_kmp_task_t + 7) & ~7;
+    size_t size = __builtin_offsetof(omp_task_desc_t, task) + shareds_offset +
+                  sizeof_shareds;
+    if (size > OMP_TASK_DESC_SIZE) {
+        KMP_PRINTF(0, "error: task of %d bytes exceeds OMP_TASK_DESC_SIZE\n",
+                   size);
+        snrt_exit(-1);
+    }
+    omp_task_desc_t *desc = omp_task_desc_alloc(tasking, core_idx);
+    if (!desc) {
+        KMP_PRINTF(0, "error: out of task descriptors\n");
+        snrt_exit(-1);
+    }
+
+    // Descendants of final tasks are final
+    omp_task_desc_t *parent = tasking->current[core_idx];
+    __atomic_add_fetch(&parent->refs, 1, __ATOMIC_RELAXED);
+    desc->parent = parent;
+    desc->refs = 1;
+    desc->size = size;
+    desc->flags = flags | (parent->flags & KMP_TASK_FLAG_FINAL);
+    desc->task.shareds =
+        sizeof_shareds ? (uint8_t *)&desc->task + shareds_offset : 0;
+    desc->task.routine = task_entry;
+    desc->task.part_id = 0;
+    return &desc->task;
+}
+
+/*!
+@ingroup TASKING
+@param loc_ref  source location information
+@param gtid  global thread number
+@param new_task  task allocated by __kmpc_omp_task_alloc
+@return 0
+
+Push the task to the calling core's deque, from where it is executed by this
+core at its next task scheduling point or stolen by an idle core. Tasks are
+executed immediately if their parent is final or the deque is full.
+
+Tasks in a spare descriptor are executed from a copy on the stack, such that
+the spare descriptor can be reused by the tasks they create. The copy
+outlives the task's children, which refer to it as their parent.
+*/
+kmp_int32 __kmpc_omp_task(ident_t *loc_ref, kmp_int32 gtid,
+                          kmp_task_t *new_task) {
+    (void)loc_ref;
+    omp_tasking_t *tasking = omp_getData()->tasking;
+    omp_task_desc_t *desc = omp_task_desc_of(new_task);
+    unsigned core_idx = snrt_cluster_core_idx();
+
+    if (omp_task_desc_is_spare(tasking, desc)) {
+        uint64_t copy[OMP_TASK_DESC_SIZE / 8];
+        memcpy(copy, desc, desc->size);
+        omp_task_desc_t *undeferred = (omp_task_desc_t *)copy;
+        if (new_task->shareds)
+            undeferred->task.shareds =
+                (uint8_t *)copy +
+                ((uint8_t *)new_task->shareds - (uint8_t *)desc);
+        omp_task_desc_free(tasking, desc);
+
+        // Keep a reference until the children completed
+        undeferred->refs++;
+        __kmp_task_run(tasking, undeferred, gtid);
+        while (__atomic_load_n(&undeferred->refs, __ATOMIC_ACQUIRE) != 1)
+            __kmp_task_schedule(tasking, gtid);
+        return 0;
+    }
+
+    if (!(desc->parent->flags & KMP_TASK_FLAG_FINAL)) {
+        __atomic_add_fetch(&tasking->pending, 1, __ATOMIC_RELAXED);
+        if (omp_task_deque_push(&tasking->deque[core_idx], desc)) return 0;
+        __atomic_sub_fetch(&tasking->pending, 1, __ATOMIC_RELAXED);
+    }
+    __kmp_task_run(tasking, desc, gtid);
+    return 0;
+}
+
+/*!
+@ingroup TASKING
+@param loc_ref  source location information
+@param gtid  global thread number
+@param task  task allocated by __kmpc_omp_task_alloc
+
+Start the execution of an undeferred task, e.g. with an <tt>if(0)</tt>
+clause, which the compiler calls directly.
+*/
+void __kmpc_omp_task_begin_if0(ident_t *loc_ref, kmp_int32 gtid,
+                               kmp_task_t *task) {
+    (void)loc_ref;
+    (void)gtid;
+    omp_tasking_t *tasking = omp_getData()->tasking;
+    tasking->current[snrt_cluster_core_idx()] = omp_task_desc_of(task);
+}
+
+/*!
+@ingroup TASKING
+Complete an undeferred task started with __kmpc_omp_task_begin_if0.
+*/
+void __kmpc_omp_task_complete_if0(ident_t *loc_ref, kmp_int32 gtid,
+                                  kmp_task_t *task) {
+    (void)loc_ref;
+    (void)gtid;
+    omp_tasking_t *tasking = omp_getData()->tasking;
+    omp_task_desc_t *desc = omp_task_desc_of(task);
+    omp_task_desc_t *parent = desc->parent;
+    tasking->current[snrt_cluster_core_idx()] = parent;
+    __kmp_task_release(tasking, desc);
+    __kmp_task_release(tasking, parent);
+}
+
+/*!
+@ingroup TASKING
+@param loc_ref  source location information
+@param gtid  global thread number
+@return 0
+
+Wait for the children of the current task to complete, executing pending
+tasks in the meantime.
+*/
+kmp_int32 __kmpc_omp_taskwait(ident_t *loc_ref, kmp_int32 gtid) {
+    (void)loc_ref;
+    omp_tasking_t *tasking = omp_getData()->tasking;
+    omp_task_desc_t *current = tasking->current[snrt_cluster_core_idx()];
+    while (__atomic_load_n(&current->refs, __ATOMIC_ACQUIRE) != 1)
+        __kmp_task_schedule(tasking, gtid);
+    return 0;
+}
+
+/*!
+@ingroup TASKING
+Execute a pending task, if any.
+*/
+kmp_int32 __kmpc_omp_taskyield(ident_t *loc_ref, kmp_int32 gtid,
+                               int end_part) {
+    (void)loc_ref;
+    (void)end_part;
+    __kmp_task_schedule(omp_getData()->tasking, gtid);
+    return 0;
+}
+
 #ifdef __cplusplus
 }
 #endif
\ No newline at end of file
@@ -177,11 +177,50 @@ enum sched_type : kmp_int32 {
 
 typedef void (*kmpc_micro)(kmp_int32 *global_tid, kmp_int32 *bound_tid, ...);
 
-////////////////////////////////////////////////////////////////////////////////
-// data
-////////////////////////////////////////////////////////////////////////////////
+/*!
+ * Lock used by the compiler-generated code around the critical combine of a
+ * reduction. Unused, as reductions are combined in a tree.
+ */
+typedef kmp_int32 kmp_critical_name[8];
+
+/*!
+ * Compiler-generated function combining the private copies of the reduction
+ * variables in the list `rhs_data` into those in the list `lhs_data`.
+ */
+typedef void (*kmp_reduce_func)(void *lhs_data, void *rhs_data);
+
+/*!
+ * Compiler-generated entry point of an explicit task, and the task structure
+ * it receives. The compiler appends the task's private variables to the
+ * structure.
+ */
+typedef kmp_int32 (*kmp_routine_entry_t)(kmp_int32, void *);
+
+typedef union kmp_cmplrdata {
+    kmp_int32 priority; /**< priority specified by user for the task */
+    kmp_routine_entry_t
+        destructors; /* pointer to function to invoke deconstructors of
+                        firstprivate C++ objects */
+} kmp_cmplrdata_t;
+
+typedef struct kmp_task {
+    void *shareds;               /**< pointer to block of pointers to shared
+                                    vars */
+    kmp_routine_entry_t routine; /**< pointer to routine to call for executing
+                                    task */
+    kmp_int32 part_id;           /**< part id for the task */
+    kmp_cmplrdata_t data1;       /* Two known optional additions: destructors
+                                    and priority */
+    kmp_cmplrdata_t data2;       /* Process destructors first, priority
+                                    second */
+} kmp_task_t;
 
-extern _kmp_ptr32 *kmpc_args;
+/*!
+ * Flags passed to __kmpc_omp_task_alloc, a subset of kmp_tasking_flags_t.
+ */
+#define KMP_TASK_FLAG_TIED 0x1
+#define KMP_TASK_FLAG_FINAL 0x2
+#define KMP_TASK_FLAG_DESTRUCTORS 0x8
 
 #ifdef __cplusplus
 }
@@ -8,23 +8,9 @@
 
 #include "dm.h"
 
-//================================================================================
-// settings
-//================================================================================
-/**
- * @brief Usually the arguments passed to __kmpc_fork_call would to a malloc
- * with the amount of arguments passed. This is too slow for our case and thus
- * we reserve a chunk of arguments in TCDM and use it. This limits the maximum
- * number of arguments
- *
- */
-#define KMP_FORK_MAX_NARGS 12
-
 //================================================================================
 // data
 //================================================================================
-static volatile omp_t *volatile omp_p_global;
-
 #ifndef OMPSTATIC_NUMTHREADS
 __thread omp_t volatile *omp_p;
 #else
@@ -35,6 +21,8 @@ omp_t omp_p = {
 };
 #endif
 
+volatile omp_global_t omp_global;
+
 #ifdef OMP_PROF
 omp_prof_t *omp_prof;
 #endif
@@ -50,8 +38,8 @@ static inline void initTeam(omp_t *_this, omp_team_t *team) {
 void omp_init(void) {
     if (snrt_cluster_core_idx() == 0) {
         // allocate space for kmp arguments
-        kmpc_args = (_kmp_ptr32 *)snrt_l1_alloc(sizeof(_kmp_ptr32) *
-                                                KMP_FORK_MAX_NARGS);
+        _kmp_ptr32 *kmpc_args = (_kmp_ptr32 *)snrt_l1_alloc(
+            sizeof(_kmp_ptr32) * KMP_FORK_MAX_NARGS);
 #ifndef OMPSTATIC_NUMTHREADS
         omp_p = (omp_t *)snrt_l1_alloc(sizeof(omp_t));
         unsigned int nbCores = snrt_cluster_compute_core_num();
@@ -60,7 +48,8 @@ void omp_init(void) {
 
         omp_p->plainTeam.nbThreads = nbCores;
         omp_p->plainTeam.loop_epoch = 0;
-        omp_p->plainTeam.loop_is_setup = 0;
+        omp_p->plainTeam.loop_setup_epoch = 0;
+        omp_p->plainTeam.loop_done = 0;
 
         for (int i = 0; i < sizeof(omp_p->plainTeam.core_epoch) /
                                 sizeof(omp_p->plainTeam.core_epoch[0]);
@@ -68,28 +57,47 @@ void omp_init(void) {
             omp_p->plainTeam.core_epoch[i] = 0;
 
         initTeam((omp_t *)omp_p, (omp_team_t *)&omp_p->plainTeam);
+        omp_p->team = (omp_team_t *)&omp_p->plainTeam;
         omp_p->kmpc_barrier =
             (snrt_barrier_t *)snrt_l1_alloc(sizeof(snrt_barrier_t));
         memset(omp_p->kmpc_barrier, 0, sizeof(snrt_barrier_t));
-        // Exchange omp pointer with other cluster cores
-        omp_p_global = omp_p;
 #else
         omp_p.kmpc_barrier =
             (snrt_barrier_t *)snrt_l1_alloc(sizeof(snrt_barrier_t));
         memset(omp_p.kmpc_barrier, 0, sizeof(snrt_barrier_t));
-        // Exchange omp pointer with other cluster cores
-        omp_p_global = &omp_p;
 #endif
 
+        omp_t *omp = (omp_t *)omp_getData();
+        omp->kmpc_args = kmpc_args;
+        // The team is local to the cluster, unless set up otherwise by
+        // snrt_omp_bootstrap_multi_cluster
+        omp->num_clusters = 1;
+        omp->cluster_idx = 0;
+        omp->thread_offset = 0;
+
+        // Allocate the reduction partials, one per compute core
+        size_t slots_size =
+            sizeof(omp_reduce_slot_t) * snrt_cluster_compute_core_num();
+        omp->reduce_slots = (omp_reduce_slot_t *)snrt_l1_alloc(slots_size);
+        memset(omp->reduce_slots, 0, slots_size);
+        omp->reduce_result =
+            (omp_reduce_value_t *)snrt_l1_alloc(2 * sizeof(omp_reduce_value_t));
+
+        // Allocate the task deques and descriptors
+        omp->tasking = (omp_tasking_t *)snrt_l1_alloc(sizeof(omp_tasking_t));
+        omp_tasking_init(omp->tasking);
+
 #ifdef OPENMP_PROFILE
         omp_prof = (omp_prof_t *)snrt_l1_alloc(sizeof(omp_prof_t));
 #endif
 
+        // Exchange omp pointer with other cluster cores
+        cls()->omp_p = omp;
     } else {
-        while (!omp_p_global)
+        while (!cls()->omp_p)
             ;
 #ifndef OMPSTATIC_NUMTHREADS
-        omp_p = omp_p_global;
+        omp_p = (omp_t *)cls()->omp_p;
 #endif
     }
 
@@ -130,6 +138,67 @@ unsigned __attribute__((noinline)) snrt_omp_bootstrap(uint32_t core_idx) {
     }
 }
 
+#ifndef OMPSTATIC_NUMTHREADS
+/**
+ * @brief Bootstrap the system for OpenMP teams spanning all clusters
+ * Bootstrap: Like snrt_omp_bootstrap, but only core 0 of cluster 0 returns to
+ * run the application. Core 0 of the other clusters serves the parallel
+ * regions forked by it (see omp_cluster_loop) until it calls
+ * __snrt_omp_destroy, and then terminates its cluster's workers and DM core.
+ *
+ * Use: __snrt_omp_bootstrap_multi_cluster(core_idx);
+ *
+ * @param core_idx cluster-local core-index
+ */
+unsigned __attribute__((noinline))
+snrt_omp_bootstrap_multi_cluster(uint32_t core_idx) {
+    if (snrt_omp_bootstrap(core_idx)) return 1;
+
+    // All clusters run the same allocations, so the first cluster's team is
+    // at the same offset in its TCDM
+    omp_t *omp = omp_getData();
+    uint32_t cluster_idx = snrt_cluster_idx();
+    omp->cluster_idx = cluster_idx;
+    omp->thread_offset = cluster_idx * snrt_cluster_compute_core_num();
+    omp->team =
+        (omp_team_t *)snrt_remote_l1_ptr(&omp->plainTeam, cluster_idx, 0);
+
+    if (cluster_idx == 0) {
+        omp_global.max_clusters = snrt_cluster_num();
+        omp_set_num_clusters(snrt_cluster_num());
+        return 0;
+    }
+    omp_cluster_loop();
+    eu_exit(core_idx);
+    dm_exit();
+    return 1;
+}
+
+/**
+ * @brief Set the number of clusters spanned by the teams of the following
+ * parallel regions. Clamped to the clusters set up by
+ * snrt_omp_bootstrap_multi_cluster. Must be called by core 0 of cluster 0
+ * outside of parallel regions.
+ */
+void omp_set_num_clusters(uint32_t num_clusters) {
+    uint32_t max_clusters = omp_global.max_clusters;
+    if (num_clusters > max_clusters) num_clusters = max_clusters;
+    if (num_clusters < 1) num_clusters = 1;
+    omp_global.num_clusters = num_clusters;
+    omp_getData()->num_clusters = num_clusters;
+}
+#endif
+
+/**
+ * @brief Terminate the serving loops of the other clusters, if set up by
+ * snrt_omp_bootstrap_multi_cluster
+ */
+void omp_exit_clusters(void) {
+    if (!omp_global.max_clusters || snrt_cluster_idx() != 0) return;
+    omp_global.exit_flag = 1;
+    omp_wake_clusters(omp_global.max_clusters);
+}
+
 void omp_print_prof(void) {
 #ifdef OPENMP_PROFILE
     printf("%-20s %d\n", "fork_oh", omp_prof->fork_oh);
@@ -8,6 +8,7 @@
 
 #include "eu.h"
 #include "kmp.h"
+#include "task.h"
 
 //================================================================================
 // debug
@@ -60,31 +61,87 @@
             return 0;                      \
     } while (0)
 
+/**
+ * @brief Bootstrap macro for openmp applications whose parallel regions span
+ * all clusters
+ */
+#define __snrt_omp_bootstrap_multi_cluster(core_idx)     \
+    if (snrt_omp_bootstrap_multi_cluster(core_idx)) do { \
+            snrt_cluster_hw_barrier();                   \
+            return 0;                                    \
+    } while (0)
+
 /**
  * @brief Destroy an OpenMP session so all cores exit cleanly
  */
 #define __snrt_omp_destroy(core_idx) \
+    omp_exit_clusters();             \
     eu_exit(core_idx);               \
     dm_exit();                       \
     snrt_cluster_hw_barrier();
 
+/**
+ * @brief Maximum number of arguments passed to a parallel region
+ */
+#define KMP_FORK_MAX_NARGS 12
+
 //================================================================================
 // types
 //================================================================================
 
 typedef struct {
-    char nbThreads;
+    // Number of threads of the team, across all of its clusters
+    uint32_t nbThreads;
 #ifndef OMPSTATIC_NUMTHREADS
+    // Dynamically scheduled loops are numbered in the order the team
+    // encounters them. `loop_epoch` is the last loop whose state below is set
+    // up, `loop_setup_epoch` the last loop claimed for setup by a thread.
     int loop_epoch;
+    int loop_setup_epoch;
+    // Shared iteration counter, advanced with AMOs by `__kmpc_dispatch_next`
+    int loop_next;
+    // Number of threads which have run out of iterations in the current loop
+    int loop_done;
     int loop_start;
-    int loop_end;
+    int loop_trip;
     int loop_incr;
     int loop_chunk;
-    int loop_is_setup;
-    int core_epoch[16];  // for dynamic scheduling
+    int loop_sched;
+    // Last loop encountered by each core of the cluster
+    int core_epoch[SNRT_CLUSTER_CORE_NUM];
 #endif
 } omp_team_t;
 
+typedef union {
+    double f64;
+    float f32;
+    int32_t i32;
+} omp_reduce_value_t;
+
+/**
+ * @brief Partial result of a core in a reduction
+ */
+typedef struct {
+    /**
+     * @brief List of pointers to the core's private copies of the reduction
+     * variables, and the function combining two such lists
+     */
+    void *data;
+    kmp_reduce_func func;
+    /**
+     * @brief Private value of the core in a typed reduction
+     */
+    omp_reduce_value_t value;
+    /**
+     * @brief Number of reductions the core has taken part in, and sequence
+     * numbers of the last reduction in which the core's partial was published
+     * resp. combined into its parent's partial
+     */
+    uint32_t seq;
+    uint32_t ready;
+    uint32_t consumed;
+} omp_reduce_slot_t;
+
 typedef struct {
 #ifndef OMPSTATIC_NUMTHREADS
     omp_team_t plainTeam;
@@ -108,8 +165,69 @@ typedef struct {
      * maximum number of arguments
      */
     _kmp_ptr32 *kmpc_args;
+    /**
+     * @brief Partials of each core in a reduction, laid out as by
+     * snrt_l1_alloc_compute_core_local, and the results of the last two typed
+     * reductions.
+     */
+    omp_reduce_slot_t *reduce_slots;
+    omp_reduce_value_t *reduce_result;
+    /**
+     * @brief Number of clusters spanned by the team, index of this cluster in
+     * the team and number of the first thread of this cluster. Threads are
+     * numbered cluster-major, starting from the first cluster.
+     */
+    uint32_t num_clusters;
+    uint32_t cluster_idx;
+    uint32_t thread_offset;
+#ifndef OMPSTATIC_NUMTHREADS
+    /**
+     * @brief Team state shared by all threads. In a team spanning multiple
+     * clusters, this is the plainTeam of the first cluster.
+     */
+    omp_team_t *team;
+#endif
+    /**
+     * @brief Task deques and descriptor pool of the cluster
+     */
+    omp_tasking_t *tasking;
 } omp_t;
 
+/**
+ * @brief State of a team spanning multiple clusters, in L3. The first core of
+ * cluster 0 forks a parallel region by publishing its arguments, bumping
+ * `fork_epoch` and waking up the first core of the other clusters, which
+ * run the region with the cores of their cluster. Clusters join by
+ * incrementing `join_count`.
+ */
+typedef struct {
+    /**
+     * @brief Number of clusters set up by snrt_omp_bootstrap_multi_cluster,
+     * zero if the runtime only runs cluster-local teams
+     */
+    uint32_t max_clusters;
+    /**
+     * @brief Number of clusters spanned by the next team
+     */
+    uint32_t num_clusters;
+    uint32_t fork_epoch;
+    uint32_t join_count;
+    /**
+     * @brief Sequence number of the last reduction of the first cluster,
+     * from which all clusters number the reductions of the next team
+     */
+    uint32_t reduce_seq;
+    uint32_t exit_flag;
+    /**
+     * @brief Barrier among the first cores of the clusters in the team
+     */
+    snrt_barrier_t barrier;
+    uint32_t argc;
+    _kmp_ptr32 args[KMP_FORK_MAX_NARGS];
+} omp_global_t;
+
+extern volatile omp_global_t omp_global;
+
 #ifdef OPENMP_PROFILE
 typedef struct {
     uint32_t fork_oh;
@@ -129,6 +247,11 @@ extern omp_t omp_p;
 
 void omp_init(void);
 unsigned snrt_omp_bootstrap(uint32_t core_idx);
+unsigned snrt_omp_bootstrap_multi_cluster(uint32_t core_idx);
+void omp_set_num_clusters(uint32_t num_clusters);
+void omp_cluster_loop(void);
+void omp_exit_clusters(void);
+void omp_task_drain(void);
 void partialParallelRegion(int32_t argc, void *data,
                            void (*fn)(void *, uint32_t), int num_threads);
 
@@ -143,9 +266,7 @@ extern omp_prof_t *omp_prof;
 
 #ifndef OMPSTATIC_NUMTHREADS
 static inline omp_t *omp_getData() { return (omp_t *)omp_p; }
-static inline omp_team_t *omp_get_team(omp_t *_this) {
-    return &_this->plainTeam;
-}
+static inline omp_team_t *omp_get_team(omp_t *_this) { return _this->team; }
 #else
 static inline const omp_t *omp_getData() { return &omp_p; }
 static inline const omp_team_t *omp_get_team(const omp_t *_this) {
@@ -154,18 +275,63 @@ static inline const omp_team_t *omp_get_team(const omp_t *_this) {
 #endif
 
 static inline unsigned omp_get_thread_num(void) {
-    return snrt_cluster_core_idx();
+    return omp_getData()->thread_offset + snrt_cluster_core_idx();
 }
 
 static inline unsigned omp_get_num_threads(void) {
-    return snrt_cluster_compute_core_num();
+    return snrt_cluster_compute_core_num() * omp_getData()->num_clusters;
+}
+
+/**
+ * @brief Translate a pointer to this cluster's TCDM to the same variable in
+ * the first cluster of the team, which holds the team-wide results.
+ */
+static inline void *omp_team_leader_ptr(void *ptr) {
+    _OMP_T *omp = omp_getData();
+    if (omp->num_clusters == 1) return ptr;
+    return snrt_remote_l1_ptr(ptr, snrt_cluster_idx(), 0);
+}
+
+/**
+ * @brief Wake up core 0 of the clusters 1 to `num_clusters - 1` through their
+ * cluster CLINT.
+ */
+static inline void omp_wake_clusters(uint32_t num_clusters) {
+    if (num_clusters == snrt_cluster_num()) {
+        snrt_wake_all(1);
+        return;
+    }
+    for (uint32_t i = 1; i < num_clusters; i++) {
+        *(volatile uint32_t *)snrt_remote_l1_ptr(snrt_cluster_clint_set_ptr(),
+                                                 snrt_cluster_idx(), i) = 1;
+    }
+}
+
+/**
+ * @brief Synchronize all threads of the team.
+ * @details Threads first execute the pending tasks of their cluster, and
+ * then synchronize with a software barrier within their cluster.
+ * In a team spanning multiple clusters, the first core of each cluster then
+ * synchronizes with the other clusters through a barrier in L3, before
+ * releasing its cluster with a second cluster-local barrier.
+ */
+static inline void omp_team_barrier(void) {
+    _OMP_T *omp = omp_getData();
+    omp_task_drain();
+    snrt_partial_barrier(omp->kmpc_barrier, (uint32_t)omp->numThreads);
+    if (omp->num_clusters > 1) {
+        if (snrt_cluster_core_idx() == 0)
+            snrt_partial_barrier((snrt_barrier_t *)&omp_global.barrier,
+                                 omp->num_clusters);
+        snrt_partial_barrier(omp->kmpc_barrier, (uint32_t)omp->numThreads);
+    }
 }
 
 static inline void parallelRegion(int32_t argc, void *data,
                                   void (*fn)(void *, uint32_t),
                                   int num_threads) {
 #ifndef OMPSTATIC_NUMTHREADS
-    omp_p->plainTeam.nbThreads = num_threads;
+    omp_p->plainTeam.nbThreads = num_threads * omp_p->num_clusters;
 #endif
 
     OMP_PRINTF(10, "num_threads=%d nbThreads=%d omp_p->numThreads=%d\n",
@@ -176,3 +342,124 @@ static inline void parallelRegion(int32_t argc, void *data,
 
     eu_run_empty(snrt_cluster_core_idx());
 }
+
+//================================================================================
+// Reductions
+//================================================================================
+
+/**
+ * @brief Combine the partials of `n` participants in a binary tree.
+ * @details At level `l` of the tree, every participant whose index is a
+ * multiple of `2^(l+1)` waits for the partial of the participant `2^l`
+ * positions above and combines it into its own. Participants publish their
+ * partial at the level where they have a parent, and leave the tree. Partials
+ * are published and consumed through flags holding the sequence number `seq`
+ * of the reduction, so participants only wait for their children.
+ *
+ * @param slot0 Address of the slot of participant 0
+ * @param pitch Distance between the slots of consecutive participants
+ * @param me Index of the calling participant
+ * @param n Number of participants
+ * @param seq Sequence number of the reduction
+ * @param combine Function combining the partial `src` into `dst`
+ * @param wait_consumed Wait for the parent to consume the partial before
+ * returning, if the partial lives in the participant's private memory.
+ * @return 1 on participant 0, which holds the combined partial, 0 on the
+ * others
+ */
+static inline unsigned omp_reduce_tree_level(
+    uintptr_t slot0, uintptr_t pitch, unsigned me, unsigned n, uint32_t seq,
+    void (*combine)(omp_reduce_slot_t *dst, omp_reduce_slot_t *src),
+    int wait_consumed) {
+    omp_reduce_slot_t *own = (omp_reduce_slot_t *)(slot0 + me * pitch);
+    for (unsigned stride = 1; stride < n; stride *= 2) {
+        if (me & stride) {
+            __atomic_store_n(&own->ready, seq, __ATOMIC_RELEASE);
+            if (wait_consumed) {
+                while (__atomic_load_n(&own->consumed, __ATOMIC_ACQUIRE) != seq)
+                    ;
+            }
+            return 0;
+        }
+        if (me + stride < n) {
+            omp_reduce_slot_t *child =
+                (omp_reduce_slot_t *)(slot0 + (me + stride) * pitch);
+            while (__atomic_load_n(&child->ready, __ATOMIC_ACQUIRE) != seq)
+                ;
+            combine(own, child);
+            __atomic_store_n(&child->consumed, seq, __ATOMIC_RELEASE);
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Combine the partials of all threads in the team.
+ * @details The partials of the threads in each cluster are combined in a tree
+ * into the slot of the cluster's first core. In a team spanning multiple
+ * clusters, these are combined in a second tree across clusters, whose flags
+ * are those of the first cores' slots, unused in the first tree.
+ *
+ * @param combine Function combining the partial `src` into `dst`
+ * @param wait_consumed Wait for the parent to consume the partial before
+ * returning, if the partial lives in the thread's private memory.
+ * @return 1 on the first thread, which holds the combined partial, 0 on the
+ * others
+ */
+static inline unsigned omp_reduce_tree(
+    void (*combine)(omp_reduce_slot_t *dst, omp_reduce_slot_t *src),
+    int wait_consumed) {
+    _OMP_T *omp = omp_getData();
+    unsigned me = snrt_cluster_core_idx();
+    omp_reduce_slot_t *slots = omp->reduce_slots;
+    uint32_t seq = ++slots[me].seq;
+
+    if (!omp_reduce_tree_level((uintptr_t)slots, sizeof(omp_reduce_slot_t),
+                               me, omp->numThreads, seq, combine,
+                               wait_consumed))
+        return 0;
+    if (omp->num_clusters == 1) return 1;
+    return omp_reduce_tree_level((uintptr_t)omp_team_leader_ptr(slots),
+                                 SNRT_CLUSTER_OFFSET, omp->cluster_idx,
+                                 omp->num_clusters, seq, combine,
+                                 wait_consumed);
+}
+
+#define OMP_REDUCE_SUM(a, b) ((a) + (b))
+#define OMP_REDUCE_MIN(a, b) ((b) < (a) ? (b) : (a))
+#define OMP_REDUCE_MAX(a, b) ((b) > (a) ? (b) : (a))
+
+/**
+ * @brief Define a typed reduction `omp_reduce_<name>(x)`, which must be called
+ * by all threads in a parallel region and returns the reduction of their `x`
+ * to all of them. It avoids the indirect calls of the generic reduction
+ * clause. Results alternate between two buffers in the first cluster, such that
+ * the next reduction cannot overwrite a result before all threads have read
+ * it, and a single team barrier suffices.
+ */
+#define OMP_DEFINE_TYPED_REDUCTION(name, type, field, op)                      \
+    static inline void omp_reduce_combine_##name(omp_reduce_slot_t *dst,       \
+                                                 omp_reduce_slot_t *src) {     \
+        dst->value.field = op(dst->value.field, src->value.field);             \
+    }                                                                          \
+    static inline type omp_reduce_##name(type x) {                             \
+        _OMP_T *omp = omp_getData();                                           \
+        omp_reduce_slot_t *slot = &omp->reduce_slots[snrt_cluster_core_idx()]; \
+        omp_reduce_value_t *result = &omp->reduce_result[slot->seq & 1];       \
+        result = (omp_reduce_value_t *)omp_team_leader_ptr(result);            \
+        slot->value.field = x;                                                 \
+        if (omp_reduce_tree(omp_reduce_combine_##name, 0))                     \
+            result->field = slot->value.field;                                 \
+        omp_team_barrier();                                                    \
+        return result->field;                                                  \
+    }
+
+OMP_DEFINE_TYPED_REDUCTION(sum_f64, double, f64, OMP_REDUCE_SUM)
+OMP_DEFINE_TYPED_REDUCTION(min_f64, double, f64, OMP_REDUCE_MIN)
+OMP_DEFINE_TYPED_REDUCTION(max_f64, double, f64, OMP_REDUCE_MAX)
+OMP_DEFINE_TYPED_REDUCTION(sum_f32, float, f32, OMP_REDUCE_SUM)
+OMP_DEFINE_TYPED_REDUCTION(min_f32, float, f32, OMP_REDUCE_MIN)
+OMP_DEFINE_TYPED_REDUCTION(max_f32, float, f32, OMP_REDUCE_MAX)
+OMP_DEFINE_TYPED_REDUCTION(sum_i32, int32_t, i32, OMP_REDUCE_SUM)
+OMP_DEFINE_TYPED_REDUCTION(min_i32, int32_t, i32, OMP_REDUCE_MIN)
+OMP_DEFINE_TYPED_REDUCTION(max_i32, int32_t, i32, OMP_REDUCE_MAX)
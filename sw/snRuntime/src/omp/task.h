@@ -0,0 +1,238 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include "kmp.h"
+
+//================================================================================
+// settings
+//================================================================================
+/**
+ * @brief Size in bytes of a task descriptor. A descriptor holds the
+ * runtime's bookkeeping, the compiler's task structure with the task's
+ * private variables, and the pointers to the task's shared variables.
+ */
+#ifndef OMP_TASK_DESC_SIZE
+#define OMP_TASK_DESC_SIZE 128
+#endif
+
+/**
+ * @brief Number of task descriptors in the pool of a cluster, a multiple of
+ * 32
+ */
+#ifndef OMP_TASK_POOL_SIZE
+#define OMP_TASK_POOL_SIZE 64
+#endif
+
+/**
+ * @brief Capacity of the task deque of each core, a power of two
+ */
+#ifndef OMP_TASK_DEQUE_SIZE
+#define OMP_TASK_DEQUE_SIZE 32
+#endif
+
+//================================================================================
+// types
+//================================================================================
+
+/**
+ * @brief Descriptor of an explicit or implicit task
+ */
+typedef struct omp_task_desc {
+    /**
+     * @brief Task which created this task
+     */
+    struct omp_task_desc *parent;
+    /**
+     * @brief One reference held by the task until it completes, plus one per
+     * child which has not completed yet. The descriptor is returned to the
+     * pool when the count drops to zero.
+     */
+    uint32_t refs;
+    /**
+     * @brief Bytes used in the descriptor, and KMP_TASK_FLAG_* flags
+     */
+    uint32_t size;
+    kmp_int32 flags;
+    /**
+     * @brief Task structure passed to the compiler-generated entry point,
+     * followed by the private variables and the shared variable pointers
+     */
+    kmp_task_t task;
+} omp_task_desc_t;
+
+/**
+ * @brief Chase-Lev work-stealing deque of a core. The owner pushes and pops
+ * tasks at the bottom, other cores steal them from the top.
+ */
+typedef struct {
+    int32_t top;
+    int32_t bottom;
+    omp_task_desc_t *buf[OMP_TASK_DEQUE_SIZE];
+} omp_task_deque_t;
+
+/**
+ * @brief Tasking state of a cluster, in TCDM
+ */
+typedef struct {
+    omp_task_deque_t deque[SNRT_CLUSTER_CORE_NUM];
+    /**
+     * @brief Implicit task of each core, the parent of the tasks it creates
+     * outside of explicit tasks, and the task each core is executing
+     */
+    omp_task_desc_t implicit[SNRT_CLUSTER_CORE_NUM];
+    omp_task_desc_t *current[SNRT_CLUSTER_CORE_NUM];
+    /**
+     * @brief Number of tasks pushed to the deques which did not complete yet
+     */
+    uint32_t pending;
+    /**
+     * @brief Set bits mark the free descriptors of the pool
+     */
+    uint32_t free_mask[OMP_TASK_POOL_SIZE / 32];
+    uint64_t pool[OMP_TASK_POOL_SIZE][OMP_TASK_DESC_SIZE / 8];
+    /**
+     * @brief One descriptor per core to fall back to when the pool is
+     * exhausted. Tasks in a spare descriptor are executed immediately.
+     */
+    uint32_t spare_busy[SNRT_CLUSTER_CORE_NUM];
+    uint64_t spare[SNRT_CLUSTER_CORE_NUM][OMP_TASK_DESC_SIZE / 8];
+} omp_tasking_t;
+
+//================================================================================
+// descriptors
+//================================================================================
+
+static inline omp_task_desc_t *omp_task_desc_of(kmp_task_t *task) {
+    return (omp_task_desc_t *)((uintptr_t)task -
+                               __builtin_offsetof(omp_task_desc_t, task));
+}
+
+static inline int omp_task_desc_is_spare(omp_tasking_t *tasking,
+                                         omp_task_desc_t *desc) {
+    return (uintptr_t)desc >= (uintptr_t)tasking->spare &&
+           (uintptr_t)desc < (uintptr_t)tasking->spare + sizeof(tasking->spare);
+}
+
+/**
+ * @brief Initialize the tasking state of the cluster
+ */
+static inline void omp_tasking_init(omp_tasking_t *tasking) {
+    memset(tasking, 0, sizeof(omp_tasking_t));
+    for (unsigned i = 0; i < OMP_TASK_POOL_SIZE / 32; i++)
+        tasking->free_mask[i] = ~0u;
+    for (unsigned i = 0; i < SNRT_CLUSTER_CORE_NUM; i++) {
+        tasking->implicit[i].refs = 1;
+        tasking->current[i] = &tasking->implicit[i];
+    }
+}
+
+/**
+ * @brief Allocate a task descriptor from the pool, or the spare descriptor of
+ * core `core_idx` if the pool is exhausted.
+ * @details Descriptors are claimed by clearing their bit in the free mask
+ * with an AMO. Each core starts searching at a different word of the mask.
+ * @return the descriptor, or 0 if the spare descriptor is also in use
+ */
+static inline omp_task_desc_t *omp_task_desc_alloc(omp_tasking_t *tasking,
+                                                   unsigned core_idx) {
+    const unsigned words = OMP_TASK_POOL_SIZE / 32;
+    for (unsigned i = 0; i < words; i++) {
+        unsigned w = (core_idx + i) % words;
+        uint32_t mask = __atomic_load_n(&tasking->free_mask[w],
+                                        __ATOMIC_RELAXED);
+        while (mask) {
+            uint32_t bit = 1u << __builtin_ctz(mask);
+            mask = __atomic_fetch_and(&tasking->free_mask[w], ~bit,
+                                      __ATOMIC_ACQUIRE);
+            if (mask & bit)
+                return (omp_task_desc_t *)tasking->pool[w * 32 +
+                                                        __builtin_ctz(bit)];
+        }
+    }
+    if (tasking->spare_busy[core_idx]) return 0;
+    tasking->spare_busy[core_idx] = 1;
+    return (omp_task_desc_t *)tasking->spare[core_idx];
+}
+
+/**
+ * @brief Return a task descriptor to the pool, or release a spare descriptor.
+ * Descriptors outside of both are ignored.
+ */
+static inline void omp_task_desc_free(omp_tasking_t *tasking,
+                                      omp_task_desc_t *desc) {
+    uintptr_t offset = (uintptr_t)desc - (uintptr_t)tasking->pool;
+    if (offset < sizeof(tasking->pool)) {
+        uint32_t idx = offset / OMP_TASK_DESC_SIZE;
+        __atomic_fetch_or(&tasking->free_mask[idx / 32], 1u << (idx % 32),
+                          __ATOMIC_RELEASE);
+    } else if (omp_task_desc_is_spare(tasking, desc)) {
+        offset = (uintptr_t)desc - (uintptr_t)tasking->spare;
+        __atomic_store_n(&tasking->spare_busy[offset / OMP_TASK_DESC_SIZE], 0,
+                         __ATOMIC_RELEASE);
+    }
+}
+
+//================================================================================
+// deques
+//================================================================================
+
+/**
+ * @brief Push a task to the bottom of the calling core's deque
+ * @return 1 on success, 0 if the deque is full
+ */
+static inline int omp_task_deque_push(omp_task_deque_t *dq,
+                                      omp_task_desc_t *desc) {
+    int32_t b = dq->bottom;
+    int32_t t = __atomic_load_n(&dq->top, __ATOMIC_ACQUIRE);
+    if (b - t >= OMP_TASK_DEQUE_SIZE) return 0;
+    dq->buf[b & (OMP_TASK_DEQUE_SIZE - 1)] = desc;
+    __atomic_store_n(&dq->bottom, b + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+/**
+ * @brief Pop a task from the bottom of the calling core's deque. Races with
+ * thieves for the last task with a compare-and-swap on `top`.
+ * @return the task, or 0 if the deque is empty
+ */
+static inline omp_task_desc_t *omp_task_deque_pop(omp_task_deque_t *dq) {
+    int32_t b = dq->bottom - 1;
+    __atomic_store_n(&dq->bottom, b, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int32_t t = __atomic_load_n(&dq->top, __ATOMIC_RELAXED);
+    if (t > b) {
+        __atomic_store_n(&dq->bottom, b + 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    omp_task_desc_t *desc = dq->buf[b & (OMP_TASK_DEQUE_SIZE - 1)];
+    if (t == b) {
+        if (!__atomic_compare_exchange_n(&dq->top, &t, t + 1, 0,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+            desc = 0;
+        __atomic_store_n(&dq->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+    return desc;
+}
+
+/**
+ * @brief Steal a task from the top of another core's deque
+ * @return the task, or 0 if the deque is empty or another core won the race
+ * for its top task
+ */
+static inline omp_task_desc_t *omp_task_deque_steal(omp_task_deque_t *dq) {
+    int32_t t = __atomic_load_n(&dq->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int32_t b = __atomic_load_n(&dq->bottom, __ATOMIC_ACQUIRE);
+    if (t >= b) return 0;
+    omp_task_desc_t *desc = dq->buf[t & (OMP_TASK_DEQUE_SIZE - 1)];
+    if (!__atomic_compare_exchange_n(&dq->top, &t, t + 1, 0, __ATOMIC_SEQ_CST,
+                                     __ATOMIC_RELAXED))
+        return 0;
+    return desc;
+}
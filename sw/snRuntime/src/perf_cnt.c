@@ -2,7 +2,11 @@
 // Licensed under the Apache License, Version 2.0, see LICENSE for details.
 // SPDX-License-Identifier: Apache-2.0
 
-extern void perf_regs_t* snrt_perf_counters();
+snrt_perf_dump_t snrt_perf_dump[SNRT_CLUSTER_NUM * SNRT_CLUSTER_CORE_NUM];
+
+__thread snrt_perf_buffer_t* snrt_perf_buffer;
+
+extern perf_regs_t* snrt_perf_counters();
 
 extern void snrt_cfg_perf_counter(uint32_t perf_cnt, uint16_t metric,
                                   uint16_t hart);
@@ -14,3 +18,19 @@ extern void snrt_stop_perf_counter(uint32_t perf_cnt);
 extern void snrt_reset_perf_counter(uint32_t perf_cnt);
 
 extern uint32_t snrt_get_perf_counter(uint32_t perf_cnt);
+
+extern snrt_perf_dump_t* snrt_perf_dump_of(uint32_t core_idx);
+
+extern uint32_t snrt_perf_dump_reserve(snrt_perf_dump_t* dump, uint32_t n);
+
+extern void snrt_perf_region_init();
+
+extern void snrt_perf_region_spill();
+
+extern void snrt_perf_region_flush();
+
+extern void snrt_perf_region_record(uint32_t id);
+
+extern void snrt_perf_region_begin(uint32_t id);
+
+extern void snrt_perf_region_end(uint32_t id);
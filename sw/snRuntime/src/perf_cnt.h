@@ -83,3 +83,198 @@ inline void snrt_reset_perf_counter(uint32_t perf_cnt) {
 inline uint32_t snrt_get_perf_counter(uint32_t perf_cnt) {
     return snrt_perf_counters()->perf_counter[perf_cnt].value;
 }
+
+//================================================================================
+// Region profiling
+//================================================================================
+
+/**
+ * @brief Number of performance counters snapshotted at the boundaries of a
+ * region, starting from counter 0. Each snapshot costs one load from the
+ * cluster peripherals.
+ */
+#ifndef SNRT_PERF_REGION_NUM_CNTS
+#define SNRT_PERF_REGION_NUM_CNTS 4
+#endif
+
+/**
+ * @brief Number of records buffered in TCDM by each core, before they have to
+ * be flushed to L3.
+ */
+#ifndef SNRT_PERF_REGION_BUF_LEN
+#define SNRT_PERF_REGION_BUF_LEN 16
+#endif
+
+/**
+ * @brief Number of records stored in L3 for each core. Further records are
+ * dropped, and counted as such.
+ */
+#ifndef SNRT_PERF_DUMP_LEN
+#define SNRT_PERF_DUMP_LEN 64
+#endif
+
+/**
+ * @brief Flag marking the records taken at the end of a region.
+ */
+#define SNRT_PERF_REGION_END 0x80000000
+
+/**
+ * @brief Snapshot of `mcycle` and the performance counters, taken at the
+ * beginning or end of a region.
+ */
+typedef struct {
+    uint32_t id;
+    uint32_t mcycle;
+    uint32_t cnt[SNRT_PERF_REGION_NUM_CNTS];
+} snrt_perf_record_t;
+
+/**
+ * @brief Records of a core not yet flushed to L3.
+ */
+typedef struct {
+    uint32_t fill;
+    snrt_perf_record_t records[SNRT_PERF_REGION_BUF_LEN];
+} snrt_perf_buffer_t;
+
+/**
+ * @brief Records of a core in L3, as decoded by `util/bench/perf_regions.py`.
+ *
+ * The header holds the hart ID, the number of counters per record, the
+ * capacity of the dump, the number of valid and dropped records, and the
+ * counter selection at the time of the last flush.
+ */
+typedef struct {
+    uint32_t hartid;
+    uint32_t num_cnts;
+    uint32_t len;
+    uint32_t count;
+    uint32_t dropped;
+    uint32_t select[SNRT_PERF_REGION_NUM_CNTS];
+    snrt_perf_record_t records[SNRT_PERF_DUMP_LEN];
+} snrt_perf_dump_t;
+
+extern snrt_perf_dump_t
+    snrt_perf_dump[SNRT_CLUSTER_NUM * SNRT_CLUSTER_CORE_NUM];
+
+extern __thread snrt_perf_buffer_t* snrt_perf_buffer;
+
+/**
+ * @brief Get the L3 dump of a core of the current cluster.
+ *
+ * @param core_idx The index of the core in the cluster.
+ */
+inline snrt_perf_dump_t* snrt_perf_dump_of(uint32_t core_idx) {
+    return &snrt_perf_dump[snrt_cluster_idx() * snrt_cluster_core_num() +
+                           core_idx];
+}
+
+/**
+ * @brief Reserve space in the L3 dump of a core for the records of its buffer,
+ * and update the header.
+ *
+ * @param dump The L3 dump of the core.
+ * @param n The number of records to copy.
+ * @return The number of records which fit in the dump.
+ */
+inline uint32_t snrt_perf_dump_reserve(snrt_perf_dump_t* dump, uint32_t n) {
+    uint32_t space = dump->len - dump->count;
+    uint32_t fit = n < space ? n : space;
+    dump->dropped += n - fit;
+    for (uint32_t i = 0; i < SNRT_PERF_REGION_NUM_CNTS; i++)
+        dump->select[i] = snrt_perf_counters()->select[i].value;
+    return fit;
+}
+
+/**
+ * @brief Set up region profiling. Must be called by all cores of the cluster,
+ * as it allocates the buffers of all cores in L1.
+ */
+inline void snrt_perf_region_init() {
+    snrt_perf_buffer_t* buffers =
+        (snrt_perf_buffer_t*)snrt_l1_alloc_cluster_local(
+            snrt_cluster_core_num() * sizeof(snrt_perf_buffer_t),
+            sizeof(uint32_t));
+    snrt_perf_buffer = &buffers[snrt_cluster_core_idx()];
+    snrt_perf_buffer->fill = 0;
+
+    snrt_perf_dump_t* dump = snrt_perf_dump_of(snrt_cluster_core_idx());
+    dump->hartid = snrt_hartid();
+    dump->num_cnts = SNRT_PERF_REGION_NUM_CNTS;
+    dump->len = SNRT_PERF_DUMP_LEN;
+    dump->count = 0;
+    dump->dropped = 0;
+
+    if (snrt_is_dm_core()) cls()->perf_regions = buffers;
+}
+
+/**
+ * @brief Copy the records of the calling core to L3, when its buffer is full.
+ */
+inline void snrt_perf_region_spill() {
+    snrt_perf_dump_t* dump = snrt_perf_dump_of(snrt_cluster_core_idx());
+    uint32_t n = snrt_perf_dump_reserve(dump, snrt_perf_buffer->fill);
+    for (uint32_t i = 0; i < n; i++)
+        dump->records[dump->count + i] = snrt_perf_buffer->records[i];
+    dump->count += n;
+    snrt_perf_buffer->fill = 0;
+}
+
+/**
+ * @brief Copy the records of all cores in the cluster to L3 with the DMA.
+ *
+ * Must be called by the DM core while the other cores do not record, e.g.
+ * between two cluster barriers. It is a no-op if region profiling was not set
+ * up.
+ */
+inline void snrt_perf_region_flush() {
+    snrt_perf_buffer_t* buffers = (snrt_perf_buffer_t*)cls()->perf_regions;
+    if (!buffers) return;
+    for (uint32_t c = 0; c < snrt_cluster_core_num(); c++) {
+        snrt_perf_dump_t* dump = snrt_perf_dump_of(c);
+        uint32_t n = snrt_perf_dump_reserve(dump, buffers[c].fill);
+        if (n)
+            snrt_dma_start_1d(&dump->records[dump->count], buffers[c].records,
+                              n * sizeof(snrt_perf_record_t));
+        dump->count += n;
+        buffers[c].fill = 0;
+    }
+    snrt_dma_wait_all();
+}
+
+/**
+ * @brief Snapshot `mcycle` and the performance counters into the buffer of
+ * the calling core.
+ *
+ * @param id The region ID, with `SNRT_PERF_REGION_END` set for the end of a
+ * region.
+ */
+inline void snrt_perf_region_record(uint32_t id) {
+    snrt_perf_buffer_t* buffer = snrt_perf_buffer;
+    if (!buffer) return;
+    if (buffer->fill == SNRT_PERF_REGION_BUF_LEN) snrt_perf_region_spill();
+    snrt_perf_record_t* record = &buffer->records[buffer->fill];
+    record->id = id;
+    record->mcycle = snrt_mcycle();
+    for (uint32_t i = 0; i < SNRT_PERF_REGION_NUM_CNTS; i++)
+        record->cnt[i] = snrt_get_perf_counter(i);
+    buffer->fill++;
+}
+
+/**
+ * @brief Mark the beginning of a profiled region.
+ *
+ * Regions may nest, and regions with the same ID may repeat. They are matched
+ * and turned into ROI JSON by `util/bench/perf_regions.py`.
+ *
+ * @param id The region ID, below `SNRT_PERF_REGION_END`.
+ */
+inline void snrt_perf_region_begin(uint32_t id) { snrt_perf_region_record(id); }
+
+/**
+ * @brief Mark the end of a profiled region.
+ *
+ * @param id The region ID, as passed to `snrt_perf_region_begin()`.
+ */
+inline void snrt_perf_region_end(uint32_t id) {
+    snrt_perf_region_record(id | SNRT_PERF_REGION_END);
+}
@@ -184,6 +184,8 @@ EXTERN_C void snrt_main() {
 
 #ifdef SNRT_CRT0_POST_BARRIER
     snrt_cluster_hw_barrier();
+    // All cores are done, flush the profiled regions before exiting
+    if (snrt_is_dm_core()) snrt_perf_region_flush();
 #endif
 
 #ifdef SNRT_CRT0_CALLBACK7
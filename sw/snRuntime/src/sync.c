@@ -9,6 +9,8 @@
 volatile uint32_t _snrt_mutex;
 volatile snrt_barrier_t _snrt_barrier;
 volatile uint32_t _reduction_result;
+__thread uint32_t _snrt_reduction_calls;
+__thread uint32_t _snrt_reduction_chunks;
 
 //================================================================================
 // Functions
@@ -28,8 +30,28 @@ extern void snrt_global_barrier();
 
 extern void snrt_partial_barrier(snrt_barrier_t *barr, uint32_t n);
 
-extern void snrt_global_reduction_dma(double *dst_buffer, double *src_buffer,
-                                      size_t len);
+extern snrt_cluster_group_t snrt_cluster_group_all(uint32_t barrier_idx);
+
+extern uint32_t snrt_cluster_group_size(const snrt_cluster_group_t *group);
+
+extern uint32_t snrt_cluster_group_rank(const snrt_cluster_group_t *group,
+                                        uint32_t cluster_idx);
+
+extern uint32_t snrt_cluster_group_member(const snrt_cluster_group_t *group,
+                                          uint32_t rank);
+
+extern volatile snrt_cluster_barrier_t *snrt_cluster_barrier_state(
+    const snrt_cluster_group_t *group, uint32_t cluster_idx);
+
+extern uint32_t snrt_cluster_group_mcast_mask(
+    const snrt_cluster_group_t *group);
+
+extern void snrt_inter_cluster_tree_barrier(const snrt_cluster_group_t *group);
+
+extern void snrt_inter_cluster_dissemination_barrier(
+    const snrt_cluster_group_t *group);
+
+extern void snrt_cluster_group_barrier(const snrt_cluster_group_t *group);
 
 extern uint32_t snrt_global_all_to_all_reduction(uint32_t value);
 
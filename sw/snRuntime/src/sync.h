@@ -78,7 +78,7 @@ inline void snrt_mutex_release(volatile uint32_t *pmtx) {
 //================================================================================
 
 inline void snrt_wake_all(uint32_t core_mask) {
-#ifdef SNRT_SUPPORTS_MULTICAST
+#if SNRT_SUPPORTS_MULTICAST
     // Multicast cluster interrupt to every other cluster's core
     // Note: we need to address another cluster's address space
     //       because the cluster XBAR has not been extended to support
@@ -148,8 +148,10 @@ static inline void snrt_inter_cluster_barrier() {
 inline void snrt_global_barrier() {
     snrt_cluster_hw_barrier();
 
-    // Synchronize all DM cores in software
+    // Synchronize all DM cores in software, and flush the profiled regions
+    // while the compute cores wait
     if (snrt_is_dm_core()) {
+        snrt_perf_region_flush();
         snrt_inter_cluster_barrier();
     }
     // Synchronize cores in a cluster with the HW barrier
@@ -179,6 +181,187 @@ inline void snrt_partial_barrier(snrt_barrier_t *barr, uint32_t n) {
     }
 }
 
+//================================================================================
+// Cluster group functions
+//================================================================================
+
+/**
+ * @brief Get the group of all clusters.
+ * @param barrier_idx The barrier state used by the group.
+ */
+inline snrt_cluster_group_t snrt_cluster_group_all(uint32_t barrier_idx = 0) {
+    uint32_t num = snrt_cluster_num();
+    snrt_cluster_group_t group = {num < 32 ? (1u << num) - 1 : ~0u,
+                                  barrier_idx};
+    return group;
+}
+
+/**
+ * @brief Get the number of clusters in a group.
+ */
+inline uint32_t snrt_cluster_group_size(const snrt_cluster_group_t *group) {
+    return __builtin_popcount(group->mask);
+}
+
+/**
+ * @brief Get the rank of a cluster within a group, i.e. the number of
+ *        clusters in the group with a lower index.
+ */
+inline uint32_t snrt_cluster_group_rank(const snrt_cluster_group_t *group,
+                                        uint32_t cluster_idx) {
+    return __builtin_popcount(group->mask & ((1u << cluster_idx) - 1));
+}
+
+/**
+ * @brief Get the index of the cluster with a given rank within a group.
+ */
+inline uint32_t snrt_cluster_group_member(const snrt_cluster_group_t *group,
+                                          uint32_t rank) {
+    uint32_t mask = group->mask;
+    while (rank--) mask &= mask - 1;
+    return __builtin_ctz(mask);
+}
+
+/**
+ * @brief Get a pointer to the barrier state of a group in a cluster's TCDM.
+ */
+inline volatile snrt_cluster_barrier_t *snrt_cluster_barrier_state(
+    const snrt_cluster_group_t *group, uint32_t cluster_idx) {
+    return (volatile snrt_cluster_barrier_t *)snrt_remote_l1_ptr(
+        &cls()->cluster_barrier[group->barrier_idx], snrt_cluster_idx(),
+        cluster_idx);
+}
+
+/**
+ * @brief Get the multicast mask addressing all clusters in a group.
+ * @return The mask, or 0 if multicast is not supported or the clusters do
+ *         not form an aligned block of a power-of-two number of clusters.
+ */
+inline uint32_t snrt_cluster_group_mcast_mask(
+    const snrt_cluster_group_t *group) {
+#if SNRT_SUPPORTS_MULTICAST
+    uint32_t num = snrt_cluster_group_size(group);
+    uint32_t first = __builtin_ctz(group->mask);
+    uint32_t block = group->mask >> first;
+    if (num > 1 && !(num & (num - 1)) && !(first & (num - 1)) &&
+        !(block & (block + 1)))
+        return (num - 1) * SNRT_CLUSTER_OFFSET;
+#endif
+    return 0;
+}
+
+/**
+ * @brief Synchronize one core from every cluster of a group, through a
+ *        tree barrier.
+ * @details Clusters are arranged in a binomial tree over their rank in the
+ *          group. Every cluster waits for its children to arrive, then
+ *          signals its parent, by writing to a flag in the parent's TCDM.
+ *          Once the root has gathered all clusters, it releases them through
+ *          a multicast write if the group supports it (see
+ *          @ref snrt_cluster_group_mcast_mask), or else through the tree, in
+ *          which every cluster releases its children. Cores only poll flags
+ *          in their own cluster's TCDM, and every cluster writes to at most
+ *          `log2(n)` other clusters.
+ * @param group The group of clusters to synchronize.
+ * @note One core from every cluster in the group must invoke this function,
+ *       or the calling cores will stall indefinitely.
+ */
+inline void snrt_inter_cluster_tree_barrier(const snrt_cluster_group_t *group) {
+    volatile snrt_cluster_barrier_t *state =
+        &cls()->cluster_barrier[group->barrier_idx];
+    uint32_t num = snrt_cluster_group_size(group);
+    uint32_t rank = snrt_cluster_group_rank(group, snrt_cluster_idx());
+    uint32_t mcast_mask = snrt_cluster_group_mcast_mask(group);
+    uint32_t epoch = state->epoch + 1;
+    state->epoch = epoch;
+
+    // Levels of the tree at which this cluster has a child
+    uint32_t num_levels = 0;
+    while (!(rank & (1 << num_levels)) && rank + (1 << num_levels) < num)
+        num_levels++;
+
+    // Gather the children, and signal the parent
+    for (uint32_t l = 0; l < num_levels; l++)
+        while (__atomic_load_n(&state->arrived[l], __ATOMIC_ACQUIRE) < epoch)
+            ;
+    if (rank) {
+        uint32_t level = __builtin_ctz(rank);
+        uint32_t parent = snrt_cluster_group_member(group, rank - (1 << level));
+        volatile snrt_cluster_barrier_t *parent_state =
+            snrt_cluster_barrier_state(group, parent);
+        __atomic_store_n(&parent_state->arrived[level], epoch,
+                         __ATOMIC_RELEASE);
+        while (__atomic_load_n(&state->released, __ATOMIC_ACQUIRE) < epoch)
+            ;
+    } else if (mcast_mask) {
+        // Address another cluster than the calling one, see snrt_wake_all
+        uint32_t dst = snrt_cluster_group_member(group, 1);
+        volatile uint32_t *released =
+            &snrt_cluster_barrier_state(group, dst)->released;
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        snrt_enable_multicast(mcast_mask);
+        *released = epoch;
+        snrt_disable_multicast();
+    }
+
+    // Release the children, starting from the largest subtree
+    if (!mcast_mask) {
+        for (uint32_t l = num_levels; l-- > 0;) {
+            uint32_t child = snrt_cluster_group_member(group, rank + (1 << l));
+            volatile snrt_cluster_barrier_t *child_state =
+                snrt_cluster_barrier_state(group, child);
+            __atomic_store_n(&child_state->released, epoch, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+/**
+ * @brief Synchronize one core from every cluster of a group, through a
+ *        dissemination barrier.
+ * @details The barrier proceeds in `ceil(log2(n))` rounds. In round `k`,
+ *          the cluster of rank `r` signals the cluster of rank
+ *          `(r + 2^k) mod n`, and waits for the signal of the cluster of rank
+ *          `(r - 2^k) mod n`. No cluster gathers or releases the others, so
+ *          no wakeup phase is needed, at the cost of `n` writes per round.
+ * @param group The group of clusters to synchronize.
+ * @note One core from every cluster in the group must invoke this function,
+ *       or the calling cores will stall indefinitely.
+ */
+inline void snrt_inter_cluster_dissemination_barrier(
+    const snrt_cluster_group_t *group) {
+    volatile snrt_cluster_barrier_t *state =
+        &cls()->cluster_barrier[group->barrier_idx];
+    uint32_t num = snrt_cluster_group_size(group);
+    uint32_t rank = snrt_cluster_group_rank(group, snrt_cluster_idx());
+    uint32_t epoch = state->epoch + 1;
+    state->epoch = epoch;
+
+    for (uint32_t k = 0; (1u << k) < num; k++) {
+        uint32_t partner =
+            snrt_cluster_group_member(group, (rank + (1 << k)) % num);
+        volatile snrt_cluster_barrier_t *partner_state =
+            snrt_cluster_barrier_state(group, partner);
+        __atomic_store_n(&partner_state->signaled[k], epoch, __ATOMIC_RELEASE);
+        while (__atomic_load_n(&state->signaled[k], __ATOMIC_ACQUIRE) < epoch)
+            ;
+    }
+}
+
+/**
+ * @brief Synchronize all Snitch cores of a group of clusters.
+ * @details Within a cluster, cores are synchronized through the hardware
+ *          barrier. The DM cores of the clusters are synchronized through
+ *          @ref snrt_inter_cluster_tree_barrier.
+ * @param group The group of clusters to synchronize.
+ * @note Every Snitch core of the clusters in the group must invoke this
+ *       function, or the calling cores will stall indefinitely.
+ */
+inline void snrt_cluster_group_barrier(const snrt_cluster_group_t *group) {
+    snrt_cluster_hw_barrier();
+    if (snrt_is_dm_core()) snrt_inter_cluster_tree_barrier(group);
+    snrt_cluster_hw_barrier();
+}
+
 //================================================================================
 // Reduction functions
 //================================================================================
@@ -214,71 +397,336 @@ inline uint32_t snrt_global_all_to_all_reduction(uint32_t value) {
 }
 
 /**
- * @brief Perform a sum reduction among clusters, blocking.
- * @details The reduction is performed in a logarithmic fashion. Half of the
- *          clusters active in every level of the binary-tree participate as
- *          as senders, the other half as receivers. Senders use the DMA to
- *          send their data to the respective receiver's destination buffer.
- *          The receiver then reduces each element in its destination buffer
- *          with the respective element in its source buffer. The result is
- *          stored in the source buffer. It then proceeds to the next level in
- *          the binary tree.
- * @param dst_buffer The pointer to the calling cluster's destination buffer.
- * @param src_buffer The pointer to the calling cluster's source buffer.
- * @param len The amount of data in each buffer.
- * @note The destination buffers must lie at the same offset in every cluster's
- *       TCDM.
+ * @brief Size in bytes of the chunks in which the buffers of a cross-cluster
+ * reduction are reduced and sent, see @ref snrt_global_reduction_dma.
+ */
+#ifndef SNRT_REDUCTION_CHUNK_SIZE
+#define SNRT_REDUCTION_CHUNK_SIZE 1024
+#endif
+
+/**
+ * @brief Reduction operators for @ref snrt_global_reduction_dma.
+ */
+struct snrt_reduction_add {
+    template <typename T>
+    T operator()(T a, T b) const {
+        return a + b;
+    }
+};
+
+struct snrt_reduction_max {
+    template <typename T>
+    T operator()(T a, T b) const {
+        return a > b ? a : b;
+    }
+};
+
+struct snrt_reduction_min {
+    template <typename T>
+    T operator()(T a, T b) const {
+        return a < b ? a : b;
+    }
+};
+
+/**
+ * @brief Number of cross-cluster reductions the calling core took part in,
+ * and total number of chunks in these reductions. As all clusters invoke all
+ * reductions, the cumulative counters in snrt_reduction_dma_state_t are
+ * consistent across clusters.
  */
-inline void snrt_global_reduction_dma(double *dst_buffer, double *src_buffer,
-                                      size_t len) {
-    // If we have a single cluster, no reduction has to be done
-    if (snrt_cluster_num() > 1) {
-        // Iterate levels in the binary reduction tree
-        int num_levels = ceil(log2(snrt_cluster_num()));
-        for (unsigned int level = 0; level < num_levels; level++) {
-            // Determine whether the current cluster is an active cluster.
-            // An active cluster is a cluster that participates in the current
-            // level of the reduction tree. Every second cluster among the
-            // active ones is a sender.
-            uint32_t is_active = (snrt_cluster_idx() % (1 << level)) == 0;
-            uint32_t is_sender = (snrt_cluster_idx() % (1 << (level + 1))) != 0;
-
-            // If the cluster is a sender, it sends the data in its source
-            // buffer to the respective receiver's destination buffer
-            if (is_active && is_sender) {
-                if (!snrt_is_compute_core()) {
-                    uint64_t dst = (uint64_t)dst_buffer -
-                                   (1 << level) * SNRT_CLUSTER_OFFSET;
-                    snrt_dma_start_1d(dst, (uint64_t)src_buffer,
-                                      len * sizeof(double));
-                    snrt_dma_wait_all();
+extern __thread uint32_t _snrt_reduction_calls;
+extern __thread uint32_t _snrt_reduction_chunks;
+
+// Implementation of the cross-cluster reductions. In decoupled reductions,
+// see snrt_cluster_group_reduction_dma_decoupled, the DM and compute cores
+// do not synchronize with each other.
+template <typename T, typename Op>
+inline void _snrt_cluster_group_reduction_dma(T *dst_buffer, T *src_buffer,
+                                              size_t len, size_t chunk_len,
+                                              const snrt_cluster_group_t *group,
+                                              int allreduce, int decoupled,
+                                              Op op) {
+    volatile snrt_reduction_dma_state_t *state = &cls()->reduction_dma;
+    uint32_t cluster_idx = snrt_cluster_idx();
+    uint32_t num_cores = snrt_cluster_compute_core_num();
+    uint32_t num_chunks = (len + chunk_len - 1) / chunk_len;
+    uint32_t calls = _snrt_reduction_calls;
+    uint32_t base = _snrt_reduction_chunks;
+    _snrt_reduction_calls = calls + 1;
+    _snrt_reduction_chunks = base + num_chunks;
+
+    uint32_t member = (group->mask >> cluster_idx) & 1;
+    uint32_t num = snrt_cluster_group_size(group);
+    uint32_t rank = snrt_cluster_group_rank(group, cluster_idx);
+
+    // Levels of the tree at which this cluster receives from a child
+    uint32_t num_levels = 0;
+    while (num_levels < SNRT_REDUCTION_MAX_LEVELS &&
+           !(rank & (1 << num_levels)) && rank + (1 << num_levels) < num)
+        num_levels++;
+    // Clusters not taking part only advance their counters
+    if (!member) num_levels = 0;
+
+    // Signal that the destination buffer is free. In decoupled reductions,
+    // the DM core signals it on behalf of the compute cores.
+    if (decoupled && !snrt_is_compute_core())
+        __atomic_add_fetch(&state->entered, num_cores, __ATOMIC_RELEASE);
+
+    if (snrt_is_compute_core()) {
+        uint32_t core_idx = snrt_cluster_core_idx();
+        if (!decoupled)
+            __atomic_add_fetch(&state->entered, 1, __ATOMIC_RELEASE);
+        for (uint32_t c = 0; c < num_chunks && num_levels; c++) {
+            // Slice of the chunk reduced by this core
+            uint32_t size = c == num_chunks - 1 ? len - c * chunk_len
+                                                : chunk_len;
+            uint32_t slice = size / num_cores;
+            uint32_t left = size - slice * num_cores;
+            uint32_t first = c * chunk_len + core_idx * slice +
+                             (core_idx < left ? core_idx : left);
+            uint32_t last = first + slice + (core_idx < left);
+
+            for (uint32_t l = 0; l < num_levels; l++) {
+                while (__atomic_load_n(&state->received[l], __ATOMIC_ACQUIRE) <
+                       base + c + 1)
+                    ;
+                for (uint32_t i = first; i < last; i++)
+                    src_buffer[i] = op(src_buffer[i], dst_buffer[i]);
+                __atomic_add_fetch(&state->consumed[l], 1, __ATOMIC_RELEASE);
+            }
+            __atomic_add_fetch(&state->reduced, 1, __ATOMIC_RELEASE);
+        }
+        // Account for the chunks and levels this cluster did not receive
+        if (!num_levels) __atomic_add_fetch(&state->reduced, num_chunks,
+                                            __ATOMIC_RELEASE);
+        for (uint32_t l = num_levels; l < SNRT_REDUCTION_MAX_LEVELS; l++)
+            __atomic_add_fetch(&state->consumed[l], num_chunks,
+                               __ATOMIC_RELEASE);
+    } else if (member) {
+        // Send the reduced chunks to the parent
+        if (rank) {
+            uint32_t level = __builtin_ctz(rank);
+            uint32_t parent =
+                snrt_cluster_group_member(group, rank - (1 << level));
+            volatile snrt_reduction_dma_state_t *parent_state =
+                (volatile snrt_reduction_dma_state_t *)snrt_remote_l1_ptr(
+                    (void *)state, cluster_idx, parent);
+            T *parent_dst =
+                (T *)snrt_remote_l1_ptr(dst_buffer, cluster_idx, parent);
+            snrt_dma_txid_t prev_txid = 0;
+            for (uint32_t c = 0; c < num_chunks; c++) {
+                uint32_t size = c == num_chunks - 1 ? len - c * chunk_len
+                                                    : chunk_len;
+                // In decoupled reductions, the chunks of clusters without
+                // children are final, and can be sent right away
+                while ((num_levels || !decoupled) &&
+                       __atomic_load_n(&state->reduced, __ATOMIC_ACQUIRE) <
+                           (base + c + 1) * num_cores)
+                    ;
+                // Publish the previous chunk, which was transferred while
+                // this chunk was reduced
+                if (c) {
+                    snrt_dma_wait(prev_txid);
+                    parent_state->received[level] = base + c;
+                }
+                // The parent's destination chunk must be free: the parent
+                // must have entered the reduction, and consumed the chunk
+                // from its child at the previous level.
+                if (level == 0) {
+                    while (__atomic_load_n(&parent_state->entered,
+                                           __ATOMIC_ACQUIRE) <
+                           (calls + 1) * num_cores)
+                        ;
+                } else {
+                    while (__atomic_load_n(&parent_state->consumed[level - 1],
+                                           __ATOMIC_ACQUIRE) <
+                           (base + c + 1) * num_cores)
+                        ;
                 }
+                prev_txid = snrt_dma_start_1d(
+                    (uint64_t)(parent_dst + c * chunk_len),
+                    (uint64_t)(src_buffer + c * chunk_len), size * sizeof(T));
             }
+            snrt_dma_wait(prev_txid);
+            parent_state->received[level] = base + num_chunks;
+        }
 
-            // Synchronize senders and receivers
-            snrt_global_barrier();
-
-            // Every cluster which is not a sender performs the reduction
-            if (is_active && !is_sender) {
-                // Computation is parallelized over the compute cores
-                if (snrt_is_compute_core()) {
-                    uint32_t items_per_core =
-                        len / snrt_cluster_compute_core_num();
-                    uint32_t core_offset =
-                        snrt_cluster_core_idx() * items_per_core;
-                    for (uint32_t i = 0; i < items_per_core; i++) {
-                        uint32_t abs_i = core_offset + i;
-                        src_buffer[abs_i] += dst_buffer[abs_i];
-                    }
+        // Broadcast the result chunks as they are reduced
+        if (allreduce && !rank) {
+            uint32_t mcast_mask = snrt_cluster_group_mcast_mask(group);
+            for (uint32_t c = 0; c < num_chunks; c++) {
+                uint32_t size = c == num_chunks - 1 ? len - c * chunk_len
+                                                    : chunk_len;
+                T *chunk = src_buffer + c * chunk_len;
+                while (__atomic_load_n(&state->reduced, __ATOMIC_ACQUIRE) <
+                       (base + c + 1) * num_cores)
+                    ;
+                if (mcast_mask) {
+                    // Address another cluster than the calling one, see
+                    // snrt_wake_all
+                    snrt_dma_start_1d_mcast(
+                        (uint64_t)snrt_remote_l1_ptr(
+                            chunk, cluster_idx,
+                            snrt_cluster_group_member(group, 1)),
+                        (uint64_t)chunk, size * sizeof(T), mcast_mask);
+                    continue;
+                }
+                for (uint32_t i = 1; i < num; i++) {
+                    snrt_dma_start_1d(
+                        (uint64_t)snrt_remote_l1_ptr(
+                            chunk, cluster_idx,
+                            snrt_cluster_group_member(group, i)),
+                        (uint64_t)chunk, size * sizeof(T));
                 }
             }
-
-            // Synchronize compute and DM cores for next tree level
-            snrt_cluster_hw_barrier();
+            snrt_dma_wait_all();
+            for (uint32_t i = 1; i < num; i++) {
+                volatile snrt_reduction_dma_state_t *remote_state =
+                    (volatile snrt_reduction_dma_state_t *)snrt_remote_l1_ptr(
+                        (void *)state, cluster_idx,
+                        snrt_cluster_group_member(group, i));
+                remote_state->broadcast = base + num_chunks;
+            }
+        } else if (allreduce) {
+            while (__atomic_load_n(&state->broadcast, __ATOMIC_ACQUIRE) <
+                   base + num_chunks)
+                ;
         }
     }
 }
 
+/**
+ * @brief Perform a reduction among a group of clusters, blocking.
+ * @details The reduction is performed in a binary tree over the ranks of the
+ *          clusters in the group. At level `l` of the tree, the cluster of
+ *          rank `i + 2^l` sends its partial to the cluster of rank `i`, for
+ *          every `i` multiple of `2^(l+1)`. The receiver reduces each element
+ *          of its destination buffer into the respective element of its
+ *          source buffer, so that the first cluster of the group ends up with
+ *          the result in its source buffer.
+ *
+ *          The buffers are processed in chunks of @p chunk_len elements, so
+ *          that the levels of the tree are pipelined: a cluster sends a chunk
+ *          as soon as it has reduced it, and the transfer overlaps with the
+ *          reduction of the next chunk. Clusters synchronize through
+ *          cumulative counters in their cluster-local storage, so that each
+ *          cluster only waits for its children and parent.
+ *
+ *          Within a cluster, the compute cores reduce disjoint slices of each
+ *          chunk, while the DM core sends the chunks to the parent.
+ *
+ * @param dst_buffer The pointer to the calling cluster's destination buffer.
+ * @param src_buffer The pointer to the calling cluster's source buffer.
+ * @param len The number of elements in each buffer.
+ * @param chunk_len The number of elements in a chunk.
+ * @param group The group of clusters taking part in the reduction. Its
+ *              barrier state is not used.
+ * @param allreduce If set, the first cluster broadcasts the result to the
+ *                  source buffers of the other clusters, with a multicast
+ *                  transfer if the group supports it (see
+ *                  @ref snrt_cluster_group_mcast_mask).
+ * @param op The reduction operator, e.g. @ref snrt_reduction_add.
+ * @note Every Snitch core must invoke this function, including the cores of
+ *       the clusters not taking part in the reduction, which return
+ *       immediately. Disjoint groups may reduce concurrently, as long as all
+ *       clusters invoke the same sequence of reductions with the same
+ *       number of chunks.
+ * @note The buffers must lie at the same offset in every cluster's TCDM.
+ */
+template <typename T, typename Op>
+inline void snrt_cluster_group_reduction_dma_chunked(
+    T *dst_buffer, T *src_buffer, size_t len, size_t chunk_len,
+    const snrt_cluster_group_t *group, int allreduce, Op op) {
+    _snrt_cluster_group_reduction_dma(dst_buffer, src_buffer, len, chunk_len,
+                                      group, allreduce, 0, op);
+
+    // Synchronize compute and DM cores
+    snrt_cluster_hw_barrier();
+}
+
+/**
+ * @brief Perform a reduction among the first @p num_clusters clusters,
+ *        blocking.
+ * @see snrt_cluster_group_reduction_dma_chunked
+ */
+template <typename T, typename Op>
+inline void snrt_global_reduction_dma_chunked(T *dst_buffer, T *src_buffer,
+                                              size_t len, size_t chunk_len,
+                                              uint32_t num_clusters,
+                                              int allreduce, Op op) {
+    snrt_cluster_group_t group = {
+        num_clusters < 32 ? (1u << num_clusters) - 1 : ~0u, 0};
+    snrt_cluster_group_reduction_dma_chunked(dst_buffer, src_buffer, len,
+                                             chunk_len, &group, allreduce, op);
+}
+
+/**
+ * @brief Perform a reduction among a group of clusters, blocking. The result
+ *        is stored in the source buffer of the first cluster of the group.
+ * @see snrt_cluster_group_reduction_dma_chunked
+ */
+template <typename T, typename Op = snrt_reduction_add>
+inline void snrt_cluster_group_reduction_dma(T *dst_buffer, T *src_buffer,
+                                             size_t len,
+                                             const snrt_cluster_group_t *group,
+                                             Op op = Op()) {
+    snrt_cluster_group_reduction_dma_chunked(
+        dst_buffer, src_buffer, len, SNRT_REDUCTION_CHUNK_SIZE / sizeof(T),
+        group, 0, op);
+}
+
+/**
+ * @brief Perform a reduction among a group of clusters, in which the DM and
+ *        compute cores of a cluster enter independently. The result is
+ *        stored in the source buffer of the first cluster of the group.
+ * @details Unlike in @ref snrt_cluster_group_reduction_dma_chunked, the DM
+ *          core does not wait for the compute cores of its cluster, so it may
+ *          enter while they are still busy with other work, e.g. computing
+ *          the next partial result. The clusters which do not receive from
+ *          any child send their partial to their parent right away, so that
+ *          the transfer overlaps with that work.
+ * @note The source buffer must hold the final partial result, and the
+ *       destination buffer must be free, by the time the DM core enters.
+ *       The cores are not synchronized on return: they must be synchronized,
+ *       e.g. with @ref snrt_cluster_hw_barrier, before the result is used,
+ *       and before the next reduction.
+ * @see snrt_cluster_group_reduction_dma_chunked
+ */
+template <typename T, typename Op = snrt_reduction_add>
+inline void snrt_cluster_group_reduction_dma_decoupled(
+    T *dst_buffer, T *src_buffer, size_t len,
+    const snrt_cluster_group_t *group, Op op = Op()) {
+    _snrt_cluster_group_reduction_dma(dst_buffer, src_buffer, len,
+                                      SNRT_REDUCTION_CHUNK_SIZE / sizeof(T),
+                                      group, 0, 1, op);
+}
+
+/**
+ * @brief Perform a reduction among all clusters, blocking. The result is
+ *        stored in cluster 0's source buffer.
+ * @see snrt_global_reduction_dma_chunked
+ */
+template <typename T, typename Op = snrt_reduction_add>
+inline void snrt_global_reduction_dma(T *dst_buffer, T *src_buffer, size_t len,
+                                      Op op = Op()) {
+    snrt_global_reduction_dma_chunked(
+        dst_buffer, src_buffer, len, SNRT_REDUCTION_CHUNK_SIZE / sizeof(T),
+        snrt_cluster_num(), 0, op);
+}
+
+/**
+ * @brief Perform a reduction among all clusters, blocking. The result is
+ *        stored in the source buffer of every cluster.
+ * @see snrt_global_reduction_dma_chunked
+ */
+template <typename T, typename Op = snrt_reduction_add>
+inline void snrt_global_allreduction_dma(T *dst_buffer, T *src_buffer,
+                                         size_t len, Op op = Op()) {
+    snrt_global_reduction_dma_chunked(
+        dst_buffer, src_buffer, len, SNRT_REDUCTION_CHUNK_SIZE / sizeof(T),
+        snrt_cluster_num(), 1, op);
+}
+
 //================================================================================
 // Memory consistency
 //================================================================================
@@ -0,0 +1,52 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Check scoped L1 allocations, the placement of bank groups in disjoint
+// banks, and the high-water mark of the L1 allocator.
+
+#include "snrt.h"
+
+#define SIZE 256
+
+// Index of the bank `ptr` lies in, within its hyperbank
+static uint32_t bank_of(void *ptr) {
+    return ((uintptr_t)ptr % SNRT_TCDM_HYPERBANK_WIDTH) / SNRT_TCDM_BANK_WIDTH;
+}
+
+int main() {
+    uint32_t errs = 0;
+
+    // Released allocations are reused
+    snrt_l1_mark_t mark = snrt_l1_mark();
+    void *a = snrt_l1_alloc_cluster_local(SIZE, sizeof(double));
+    snrt_l1_mark_t inner = snrt_l1_mark();
+    void *b = snrt_l1_alloc_cluster_local(SIZE, sizeof(double));
+    snrt_l1_release(inner);
+    errs += snrt_l1_alloc_cluster_local(SIZE, sizeof(double)) != b;
+    snrt_l1_release(mark);
+    errs += snrt_l1_alloc_cluster_local(SIZE, sizeof(double)) != a;
+    snrt_l1_release(mark);
+
+    // The high-water mark survives the release
+    errs += snrt_l1_high_water_mark() < 2 * SIZE;
+
+    // The buffers of a group are assigned disjoint banks, and the allocations
+    // following the group do not overlap with it
+    uint32_t num_banks = SNRT_TCDM_BANK_PER_HYPERBANK_NUM / 4;
+    snrt_l1_bank_group_t group;
+    snrt_l1_bank_group_begin(&group);
+    void *x = snrt_l1_bank_group_alloc(&group, SIZE, num_banks, 0);
+    void *y = snrt_l1_bank_group_alloc(&group, SIZE, num_banks, 0);
+    void *z = snrt_l1_bank_group_alloc(&group, 4 * SIZE, num_banks, 0);
+    snrt_l1_bank_group_end(&group);
+    void *w = snrt_l1_alloc_cluster_local(SIZE, sizeof(double));
+    errs += bank_of(x) != 0;
+    errs += bank_of(y) != num_banks;
+    errs += bank_of(z) != 2 * num_banks;
+    uint32_t lines = 4 * SIZE / (num_banks * SNRT_TCDM_BANK_WIDTH);
+    errs += (uintptr_t)w < (uintptr_t)x + lines * SNRT_TCDM_HYPERBANK_WIDTH;
+    snrt_l1_release(mark);
+
+    return errs;
+}
@@ -0,0 +1,63 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Measure the latency of the inter-cluster barriers against the number of
+// clusters, and check that no cluster leaves a barrier before all clusters
+// entered it.
+
+#include "snrt.h"
+
+#define REPS 16
+
+// Shared by all clusters, so they live in L3
+static volatile uint32_t arrivals;
+static volatile uint32_t errors;
+
+enum { CENTRAL, TREE, DISSEMINATION };
+
+static const char *barrier_names[] = {"central", "tree", "dissemination"};
+
+// Run REPS barriers of the given kind among the first `num` clusters, on the
+// DM cores, and return the average latency
+static uint32_t __attribute__((noinline))
+run(uint32_t kind, const snrt_cluster_group_t *group, uint32_t num) {
+    uint32_t errs = 0;
+    uint32_t start = snrt_mcycle();
+    for (uint32_t r = 0; r < REPS; r++) {
+        __atomic_add_fetch(&arrivals, 1, __ATOMIC_RELAXED);
+        if (kind == CENTRAL)
+            snrt_inter_cluster_barrier();
+        else if (kind == TREE)
+            snrt_inter_cluster_tree_barrier(group);
+        else
+            snrt_inter_cluster_dissemination_barrier(group);
+        errs += arrivals < (r + 1) * num;
+    }
+    uint32_t cycles = (snrt_mcycle() - start) / REPS;
+    __atomic_add_fetch(&errors, errs, __ATOMIC_RELAXED);
+    return cycles;
+}
+
+int main() {
+    uint32_t cluster_idx = snrt_cluster_idx();
+
+    if (snrt_global_core_idx() == 0) printf("barrier, clusters, cycles\n");
+    for (uint32_t n = 1; n <= snrt_cluster_num(); n++) {
+        snrt_cluster_group_t group = {(1u << n) - 1, 0};
+        for (uint32_t kind = CENTRAL; kind <= DISSEMINATION; kind++) {
+            // The central barrier always spans all clusters
+            if (kind == CENTRAL && n < snrt_cluster_num()) continue;
+            if (snrt_is_dm_core() && cluster_idx == 0) arrivals = 0;
+            snrt_global_barrier();
+            if (snrt_is_dm_core() && cluster_idx < n) {
+                uint32_t cycles = run(kind, &group, n);
+                if (cluster_idx == 0)
+                    printf("%s, %u, %u\n", barrier_names[kind], n, cycles);
+            }
+            snrt_global_barrier();
+        }
+    }
+
+    return snrt_global_core_idx() == 0 ? errors : 0;
+}
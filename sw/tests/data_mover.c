@@ -6,6 +6,15 @@
 
 volatile static uint32_t sum = 0;
 
+// Handshake of the multi-producer test, between core 0 and the other compute
+// cores
+static uint32_t *volatile mp_buf = 0;
+volatile static uint32_t mp_done = 0;
+volatile static uint32_t mp_errs = 0;
+
+#define MP_N_ELEM 16
+#define MP_N_REQ 8
+
 uint32_t compare(uint32_t *a, uint32_t *b, uint32_t n) {
     uint32_t mismatch = 0;
     for (uint32_t i = 0; i < n; ++i) {
@@ -32,7 +41,22 @@ int main() {
         dm_main();
         return 0;
     } else {
-        // all other cores exit, this is a single-hart test
+        // all other cores only take part in the multi-producer test
+        uint32_t *buf;
+        while (!(buf = mp_buf))
+            ;
+        // copy this core's source chunk to all its destination chunks
+        uint32_t *src = buf + core_idx * (MP_N_REQ + 1) * MP_N_ELEM;
+        dm_token_t token;
+        for (uint32_t r = 0; r < MP_N_REQ; r++)
+            token = dm_memcpy_async(src + (r + 1) * MP_N_ELEM, src,
+                                    MP_N_ELEM * sizeof(uint32_t));
+        dm_wait_token(token);
+        mismatch = 0;
+        for (uint32_t r = 0; r < MP_N_REQ; r++)
+            mismatch += compare(src, src + (r + 1) * MP_N_ELEM, MP_N_ELEM);
+        __atomic_add_fetch(&mp_errs, mismatch, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&mp_done, 1, __ATOMIC_RELAXED);
         return 0;
     }
 
@@ -96,6 +120,40 @@ int main() {
         err |= 1 << 4;
     }
 
+    printf("-- Test 5: Tokens, more requests than queue slots\n");
+    const uint32_t n_req = 2 * DM_TASK_QUEUE_SIZE, chunk = n_elem / n_req;
+    dm_token_t first, last;
+    for (uint32_t i = 0; i < n_elem; ++i) l1_a[i] = i + 5;
+    for (uint32_t r = 0; r < n_req; ++r) {
+        dm_token_t token = dm_memcpy_async(l1_b + r * chunk, l1_a + r * chunk,
+                                           chunk * sizeof(uint32_t));
+        if (r == 0) first = token;
+        last = token;
+    }
+    dm_wait_token(first);
+    mismatch = compare(l1_a, l1_b, chunk);
+    dm_wait_token(last);
+    mismatch += !dm_test_token(first);
+    mismatch += compare(l1_a, l1_b, n_req * chunk);
+    if (mismatch) {
+        printf("  failed with %d mismatches\n", mismatch);
+        err |= 1 << 5;
+    }
+
+    printf("-- Test 6: Multiple producers\n");
+    uint32_t n_prod = snrt_cluster_compute_core_num() - 1;
+    uint32_t *l1_mp = (uint32_t *)snrt_l1_alloc(
+        (n_prod + 1) * (MP_N_REQ + 1) * MP_N_ELEM * sizeof(uint32_t));
+    for (uint32_t i = 0; i < (n_prod + 1) * (MP_N_REQ + 1) * MP_N_ELEM; ++i)
+        l1_mp[i] = i + 6;
+    mp_buf = l1_mp;
+    while (mp_done != n_prod)
+        ;
+    if (mp_errs) {
+        printf("  failed with %d mismatches\n", mp_errs);
+        err |= 1 << 6;
+    }
+
     // exit
     dm_exit();
     return err;
@@ -0,0 +1,39 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Check the records of the deferred log of every hart, also once the oldest
+// records are overwritten, and measure the cost of logging a message.
+
+#include "snrt.h"
+
+// Records with four words of arguments, enough to wrap around the buffer
+#define RECORD_LEN (SNRT_LOG_HDR_LEN + 4)
+#define NUM_RECORDS (SNRT_LOG_BUF_LEN / RECORD_LEN + 4)
+
+int main() {
+    uint32_t errs = 0;
+    uint32_t core_idx = snrt_cluster_core_idx();
+    snrt_log_buffer_t *buf = &snrt_log_buffers[snrt_global_core_idx()];
+
+    uint32_t start = snrt_mcycle();
+    for (uint32_t i = 0; i < NUM_RECORDS; i++)
+        SNRT_LOG("core %u record %u: %f\n", core_idx, i, (double)i / 2);
+    uint32_t cycles = (snrt_mcycle() - start) / NUM_RECORDS;
+
+    // All records have the same size, so the newest ones are kept intact
+    uint32_t kept = SNRT_LOG_BUF_LEN / RECORD_LEN;
+    errs += buf->head != NUM_RECORDS * RECORD_LEN;
+    errs += buf->tail != (NUM_RECORDS - kept) * RECORD_LEN;
+    errs += buf->dropped != NUM_RECORDS - kept;
+    for (uint32_t i = NUM_RECORDS - kept; i < NUM_RECORDS; i++) {
+        uint32_t pos = i * RECORD_LEN;
+        errs += buf->data[(pos + 2) % SNRT_LOG_BUF_LEN] != 4;
+        errs += buf->data[(pos + 3) % SNRT_LOG_BUF_LEN] != core_idx;
+        errs += buf->data[(pos + 4) % SNRT_LOG_BUF_LEN] != i;
+    }
+
+    if (snrt_global_core_idx() == 0) printf("cycles per message: %u\n", cycles);
+
+    return errs;
+}
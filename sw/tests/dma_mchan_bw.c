@@ -0,0 +1,71 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Measure the L3 to TCDM bandwidth achieved by transfers striped over an
+// increasing number of DMA channels, for an increasing transfer size, and
+// check the transferred data.
+
+#include <snrt.h>
+
+#define MAX_TRANSFER_SIZE 32768
+#define NUM_ROWS 64
+
+uint8_t buffer_src_l3[MAX_TRANSFER_SIZE];
+
+static const uint32_t transfer_sizes[] = {256, 1024, 4096, 16384, 32768};
+
+// Check that `size` bytes at `dst` match the source buffer, and clear them.
+static uint32_t check(uint8_t *dst, size_t size) {
+    uint32_t errors = 0;
+    for (uint32_t i = 0; i < size; i++) {
+        errors += dst[i] != buffer_src_l3[i];
+        dst[i] = 0;
+    }
+    return errors;
+}
+
+int main() {
+    if (!snrt_is_dm_core() || snrt_cluster_idx() != 0) return 0;
+    uint32_t errors = 0;
+
+    uint8_t *buffer_dst_l1 = (uint8_t *)snrt_l1_alloc(MAX_TRANSFER_SIZE);
+    for (uint32_t i = 0; i < MAX_TRANSFER_SIZE; i++) {
+        buffer_src_l3[i] = i * 7 + 1;
+        buffer_dst_l1[i] = 0;
+    }
+
+    printf("size [B], channels, 1D [cycles], 2D [cycles]\n");
+    for (uint32_t s = 0; s < sizeof(transfer_sizes) / sizeof(uint32_t); s++) {
+        uint32_t size = transfer_sizes[s];
+        for (uint32_t n = 1; n <= SNRT_DMA_NUM_CHANNELS; n++) {
+            // 1D transfer
+            uint32_t start = snrt_mcycle();
+            snrt_dma_handle_t handle = snrt_dma_start_1d_striped(
+                buffer_dst_l1, buffer_src_l3, size, n);
+            snrt_dma_wait_handle(&handle);
+            uint32_t cycles_1d = snrt_mcycle() - start;
+            errors += check(buffer_dst_l1, size);
+
+            // 2D transfer of the same size, as `NUM_ROWS` rows
+            start = snrt_mcycle();
+            handle = snrt_dma_start_2d_striped(
+                buffer_dst_l1, buffer_src_l3, size / NUM_ROWS, size / NUM_ROWS,
+                size / NUM_ROWS, NUM_ROWS, n);
+            snrt_dma_wait_handle(&handle);
+            uint32_t cycles_2d = snrt_mcycle() - start;
+            errors += check(buffer_dst_l1, size);
+
+            printf("%u, %u, %u, %u\n", size, n, cycles_1d, cycles_2d);
+        }
+    }
+
+    // All parts of a striped transfer must have completed.
+    snrt_dma_handle_t handle = snrt_dma_start_1d_striped(
+        buffer_dst_l1, buffer_src_l3, MAX_TRANSFER_SIZE, SNRT_DMA_NUM_CHANNELS);
+    snrt_dma_wait_handle(&handle);
+    errors += !snrt_dma_handle_done(&handle);
+    errors += check(buffer_dst_l1, MAX_TRANSFER_SIZE);
+
+    return errors;
+}
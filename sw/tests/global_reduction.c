@@ -0,0 +1,90 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Measure the cross-cluster reduction and allreduction against the number of
+// clusters and the buffer size, with and without pipelining, and check their
+// results. The grouped variant splits the clusters into groups of the given
+// size, which reduce concurrently. In the decoupled variant, the DM cores do
+// not wait for the compute cores of their cluster.
+
+#include "snrt.h"
+
+#define MAX_LEN 2048
+
+static const uint32_t lens[] = {64, 512, MAX_LEN};
+
+// Shared by all clusters, so it lives in L3
+static volatile uint32_t errors;
+
+enum { PIPELINED, UNPIPELINED, ALLREDUCE, GROUPED, DECOUPLED };
+
+static const char *variant_names[] = {"pipelined", "unpipelined", "allreduce",
+                                      "grouped", "decoupled"};
+
+static void __attribute__((noinline))
+run(double *dst, double *src, uint32_t len, uint32_t num_clusters,
+    uint32_t variant) {
+    uint32_t cluster_idx = snrt_cluster_idx();
+    uint32_t chunk_len = SNRT_REDUCTION_CHUNK_SIZE / sizeof(double);
+
+    if (snrt_cluster_core_idx() == 0)
+        for (uint32_t i = 0; i < len; i++) src[i] = (cluster_idx + 1) * i;
+    snrt_global_barrier();
+
+    // Clusters taking part in the reduction of the calling cluster. Grouped
+    // clusters are split into blocks of `num_clusters` clusters, the last of
+    // which may be smaller.
+    uint32_t first = 0;
+    if (variant == GROUPED) first = cluster_idx / num_clusters * num_clusters;
+    uint32_t last = first + num_clusters;
+    if (last > snrt_cluster_num()) last = snrt_cluster_num();
+
+    snrt_cluster_group_t group = {((1u << (last - first)) - 1) << first, 0};
+    uint32_t start = snrt_mcycle();
+    if (variant == GROUPED) {
+        snrt_cluster_group_reduction_dma_chunked(
+            dst, src, len, chunk_len, &group, 0, snrt_reduction_add());
+    } else if (variant == DECOUPLED) {
+        snrt_cluster_group_reduction_dma_decoupled(dst, src, len, &group);
+        snrt_cluster_hw_barrier();
+    } else {
+        snrt_global_reduction_dma_chunked(
+            dst, src, len, variant == UNPIPELINED ? len : chunk_len,
+            num_clusters, variant == ALLREDUCE, snrt_reduction_add());
+    }
+    uint32_t cycles = snrt_mcycle() - start;
+
+    // Each cluster contributes (cluster_idx + 1) * i to element i
+    if (snrt_cluster_core_idx() == 0 && cluster_idx < last &&
+        (cluster_idx == first || variant == ALLREDUCE)) {
+        uint32_t errs = 0;
+        double factor = (last * (last + 1) - first * (first + 1)) / 2;
+        for (uint32_t i = 0; i < len; i++) errs += src[i] != factor * i;
+        __atomic_add_fetch(&errors, errs, __ATOMIC_RELAXED);
+    }
+    if (snrt_global_core_idx() == 0)
+        printf("%s, %u, %u, %u\n", variant_names[variant], num_clusters,
+               len * (uint32_t)sizeof(double), cycles);
+}
+
+int main() {
+    // At the same offset in every cluster's TCDM
+    double *dst = (double *)snrt_l1_next();
+    double *src = dst + MAX_LEN;
+
+    if (snrt_global_core_idx() == 0)
+        printf("variant, clusters, size [B], cycles\n");
+    for (uint32_t n = 1; n <= snrt_cluster_num(); n++) {
+        for (uint32_t i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+            run(dst, src, lens[i], n, PIPELINED);
+            run(dst, src, lens[i], n, UNPIPELINED);
+            run(dst, src, lens[i], n, ALLREDUCE);
+            run(dst, src, lens[i], n, GROUPED);
+            run(dst, src, lens[i], n, DECOUPLED);
+        }
+    }
+
+    snrt_global_barrier();
+    return snrt_global_core_idx() == 0 ? errors : 0;
+}
@@ -0,0 +1,88 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Compare the static, dynamic and guided loop schedules on workloads whose
+// cost per iteration is skewed, and check the results of each schedule.
+
+#include "snrt.h"
+
+#define N 256
+
+// Workloads: cost in inner iterations of each loop iteration
+enum { FRONT_LOADED, TRIANGULAR, SPARSE, NUM_WORKLOADS };
+
+static const char *workload_names[NUM_WORKLOADS] = {"front-loaded",
+                                                    "triangular", "sparse"};
+
+static uint32_t cost(uint32_t workload, uint32_t i) {
+    switch (workload) {
+        case FRONT_LOADED:
+            return i < N / 8 ? 64 : 2;
+        case TRIANGULAR:
+            return (N - i) / 4 + 1;
+        default:
+            // A few heavy iterations, as for the rows of a sparse matrix
+            return i % 37 == 0 ? 160 : 4;
+    }
+}
+
+static uint32_t work(uint32_t workload, uint32_t i) {
+    uint32_t x = i;
+    for (uint32_t k = 0; k < cost(workload, i); k++) x = x * 1103515245 + 12345;
+    return x;
+}
+
+// One function per schedule, as the schedule clause must be a literal
+#define DEFINE_SCHEDULE(name, clause)                          \
+    uint32_t __attribute__((noinline))                         \
+    run_##name(uint32_t workload, volatile uint32_t *result) { \
+        uint32_t start = snrt_mcycle();                        \
+        _Pragma("omp parallel") {                              \
+            _Pragma(clause) for (uint32_t i = 0; i < N; i++) { \
+                result[i] = work(workload, i);                 \
+            }                                                  \
+        }                                                      \
+        return snrt_mcycle() - start;                          \
+    }
+
+DEFINE_SCHEDULE(static, "omp for schedule(static)")
+DEFINE_SCHEDULE(dynamic_1, "omp for schedule(dynamic)")
+DEFINE_SCHEDULE(dynamic_4, "omp for schedule(dynamic, 4)")
+DEFINE_SCHEDULE(guided, "omp for schedule(guided)")
+
+typedef uint32_t (*schedule_fn_t)(uint32_t, volatile uint32_t *);
+
+static const schedule_fn_t schedules[] = {run_static, run_dynamic_1,
+                                          run_dynamic_4, run_guided};
+static const char *schedule_names[] = {"static", "dynamic,1", "dynamic,4",
+                                       "guided"};
+
+int main() {
+    unsigned core_idx = snrt_cluster_core_idx();
+    unsigned err = 0;
+
+    // Only core 0 executes the statements below this function
+    __snrt_omp_bootstrap(core_idx);
+
+    volatile uint32_t *result =
+        (volatile uint32_t *)snrt_l1_alloc(N * sizeof(uint32_t));
+
+    printf("workload, schedule, cycles\n");
+    for (uint32_t w = 0; w < NUM_WORKLOADS; w++) {
+        for (uint32_t s = 0; s < sizeof(schedules) / sizeof(schedules[0]);
+             s++) {
+            for (uint32_t i = 0; i < N; i++) result[i] = 0;
+            uint32_t cycles = schedules[s](w, result);
+            for (uint32_t i = 0; i < N; i++) err += result[i] != work(w, i);
+            printf("%s, %s, %u\n", workload_names[w], schedule_names[s],
+                   cycles);
+        }
+    }
+
+    if (err) printf("Error [dynamic_schedule]: %d mismatches\n", err);
+
+    // exit
+    __snrt_omp_destroy(core_idx);
+    return err;
+}
@@ -0,0 +1,115 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Run OpenMP teams spanning an increasing number of clusters. Measure the
+// fork/join and barrier overheads, and check worksharing and reductions
+// across the clusters of the team, and dynamically scheduled loops after a
+// change in the number of clusters.
+
+#include "snrt.h"
+
+#define N 1024
+#define REPS 8
+
+// Shared by all clusters, so it lives in L3
+static volatile uint32_t result[N];
+
+static uint32_t __attribute__((noinline)) fork_join_cycles(void) {
+    uint32_t start = snrt_mcycle();
+    for (uint32_t r = 0; r < REPS; r++) {
+#pragma omp parallel
+        { (void)omp_get_thread_num(); }
+    }
+    return (snrt_mcycle() - start) / REPS;
+}
+
+static uint32_t __attribute__((noinline)) barrier_cycles(void) {
+    static volatile uint32_t cycles;
+#pragma omp parallel
+    {
+        uint32_t start = snrt_mcycle();
+        for (uint32_t r = 0; r < REPS; r++) {
+#pragma omp barrier
+        }
+        if (omp_get_thread_num() == 0) cycles = (snrt_mcycle() - start) / REPS;
+    }
+    return cycles;
+}
+
+static uint32_t __attribute__((noinline)) check_worksharing(void) {
+    uint32_t errs = 0;
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < N; i++) result[i] = 0;
+#pragma omp parallel
+    {
+        if (omp_get_thread_num() == 0) n = omp_get_num_threads();
+#pragma omp for schedule(static)
+        for (uint32_t i = 0; i < N; i++) result[i] = 3 * i + 1;
+    }
+    for (uint32_t i = 0; i < N; i++) errs += result[i] != 3 * i + 1;
+    return errs + (n != snrt_cluster_compute_core_num() *
+                            omp_getData()->num_clusters);
+}
+
+static uint32_t __attribute__((noinline)) check_reduction(void) {
+    static volatile uint32_t errs;
+    errs = 0;
+    int32_t sum = 0;
+#pragma omp parallel for reduction(+ : sum)
+    for (int32_t i = 0; i < N; i++) sum += i;
+#pragma omp parallel
+    {
+        int32_t me = omp_get_thread_num();
+        int32_t n = omp_get_num_threads();
+        uint32_t e = omp_reduce_sum_i32(me) != n * (n - 1) / 2;
+        e += omp_reduce_max_f64((double)me) != (double)(n - 1);
+        __atomic_add_fetch(&errs, e, __ATOMIC_RELAXED);
+    }
+    return errs + (sum != N * (N - 1) / 2);
+}
+
+static uint32_t __attribute__((noinline)) check_dynamic(void) {
+    uint32_t errs = 0;
+    for (uint32_t i = 0; i < N; i++) result[i] = 0;
+#pragma omp parallel
+    {
+#pragma omp for schedule(dynamic, 4)
+        for (uint32_t i = 0; i < N; i++) result[i] += 2 * i;
+#pragma omp for schedule(guided)
+        for (uint32_t i = 0; i < N; i++) result[i] += 1;
+    }
+    for (uint32_t i = 0; i < N; i++) errs += result[i] != 2 * i + 1;
+    return errs;
+}
+
+int main() {
+    unsigned core_idx = snrt_cluster_core_idx();
+    unsigned err = 0;
+
+    // Only core 0 of cluster 0 executes the statements below this function
+    __snrt_omp_bootstrap_multi_cluster(core_idx);
+
+    printf("clusters, threads, fork/join [cycles], barrier [cycles]\n");
+    for (uint32_t n = 1; n <= snrt_cluster_num(); n++) {
+        omp_set_num_clusters(n);
+        uint32_t fork_join = fork_join_cycles();
+        uint32_t barrier = barrier_cycles();
+        err += check_worksharing();
+        err += check_reduction();
+        err += check_dynamic();
+        printf("%u, %u, %u, %u\n", n, n * snrt_cluster_compute_core_num(),
+               fork_join, barrier);
+    }
+
+    // Dynamically scheduled loops of a single-cluster team, after the loops
+    // of a team spanning all clusters
+    omp_set_num_clusters(1);
+    err += check_dynamic();
+
+    if (err) printf("Error [multi_cluster]: %d mismatches\n", err);
+
+    // exit
+    __snrt_omp_destroy(core_idx);
+    return err;
+}
@@ -0,0 +1,103 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Check reductions through the OpenMP reduction clause and the typed
+// reduction functions of the runtime, and compare their cost with an
+// accumulation under a mutex.
+
+#include "snrt.h"
+
+#define N 256
+
+static double x[N];
+
+static unsigned __attribute__((noinline)) reduction_clause(void) {
+    double sum = 0, max = -1;
+    int32_t isum = 0, imin = N;
+
+    uint32_t start = snrt_mcycle();
+#pragma omp parallel for reduction(+ : sum, isum) reduction(max : max) \
+    reduction(min : imin)
+    for (unsigned i = 0; i < N; i++) {
+        sum += x[i];
+        isum += i;
+        max = x[i] > max ? x[i] : max;
+        imin = (int32_t)i < imin ? (int32_t)i : imin;
+    }
+    printf("reduction clause: %u cycles\n", snrt_mcycle() - start);
+
+    // The sum of 0.5 * i is exact in double precision
+    return (sum != 0.25 * N * (N - 1)) + (isum != N * (N - 1) / 2) +
+           (max != 0.5 * (N - 1)) + (imin != 0);
+}
+
+static unsigned __attribute__((noinline)) reduction_nowait(void) {
+    double sum = 0;
+    unsigned errs = 0;
+
+#pragma omp parallel
+    {
+#pragma omp for reduction(+ : sum) nowait
+        for (unsigned i = 0; i < N; i++) sum += x[i];
+#pragma omp barrier
+        if (omp_get_thread_num() == 0) errs += sum != 0.25 * N * (N - 1);
+    }
+    return errs;
+}
+
+static unsigned __attribute__((noinline)) typed_reduction(void) {
+    static volatile uint32_t errs;
+    errs = 0;
+
+    uint32_t start = snrt_mcycle();
+#pragma omp parallel
+    {
+        int32_t me = omp_get_thread_num();
+        int32_t n = omp_get_num_threads();
+        uint32_t e = omp_reduce_sum_f64(x[me]) != 0.25 * n * (n - 1);
+        e += omp_reduce_min_i32(me - 3) != -3;
+        e += omp_reduce_max_f32((float)me) != (float)(n - 1);
+        __atomic_add_fetch(&errs, e, __ATOMIC_RELAXED);
+    }
+    printf("typed reductions: %u cycles\n", snrt_mcycle() - start);
+    return errs;
+}
+
+static unsigned __attribute__((noinline)) mutex_reduction(void) {
+    static volatile double sum;
+    sum = 0;
+
+    uint32_t start = snrt_mcycle();
+#pragma omp parallel
+    {
+        double partial = 0;
+#pragma omp for
+        for (unsigned i = 0; i < N; i++) partial += x[i];
+        snrt_mutex_acquire(snrt_mutex());
+        sum += partial;
+        snrt_mutex_release(snrt_mutex());
+    }
+    printf("mutex reduction: %u cycles\n", snrt_mcycle() - start);
+    return sum != 0.25 * N * (N - 1);
+}
+
+int main() {
+    unsigned core_idx = snrt_cluster_core_idx();
+    unsigned err = 0;
+
+    // Only core 0 executes the statements below this function
+    __snrt_omp_bootstrap(core_idx);
+
+    for (unsigned i = 0; i < N; i++) x[i] = 0.5 * i;
+
+    err += reduction_clause();
+    err += reduction_nowait();
+    err += typed_reduction();
+    err += mutex_reduction();
+    if (err) printf("Error [reduction]: %d mismatches\n", err);
+
+    // exit
+    __snrt_omp_destroy(core_idx);
+    return err;
+}
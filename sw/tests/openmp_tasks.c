@@ -0,0 +1,119 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Measure the task throughput of the OpenMP runtime, and check recursive
+// and irregular task workloads, whose tasks are balanced by work stealing.
+
+#include "snrt.h"
+
+#define N 64
+// Below this argument, fib recurses without creating tasks. This bounds the
+// nesting of tasks, as each core's stack is small.
+#define FIB_N 12
+#define FIB_CUTOFF 8
+
+static const uint32_t num_tasks[] = {16, 64, 256};
+
+static uint32_t fib_serial(uint32_t n) {
+    return n < 2 ? n : fib_serial(n - 1) + fib_serial(n - 2);
+}
+
+static uint32_t fib(uint32_t n) {
+    if (n < FIB_CUTOFF) return fib_serial(n);
+    uint32_t a, b;
+#pragma omp task shared(a)
+    a = fib(n - 1);
+#pragma omp task shared(b)
+    b = fib(n - 2);
+#pragma omp taskwait
+    return a + b;
+}
+
+// Cost of item i, skewed as for the rows of a sparse matrix
+static uint32_t work(uint32_t i) {
+    uint32_t x = i;
+    uint32_t cost = i % 13 == 0 ? 400 : 20;
+    for (uint32_t k = 0; k < cost; k++) x = x * 1103515245 + 12345;
+    return x;
+}
+
+static uint32_t __attribute__((noinline)) empty_tasks(uint32_t n) {
+    static volatile uint32_t count;
+    count = 0;
+    uint32_t start = snrt_mcycle();
+#pragma omp parallel
+    {
+#pragma omp single
+        {
+            for (uint32_t i = 0; i < n; i++) {
+#pragma omp task
+                __atomic_add_fetch(&count, 1, __ATOMIC_RELAXED);
+            }
+        }
+    }
+    uint32_t cycles = snrt_mcycle() - start;
+    printf("empty, %u, %u\n", n, cycles);
+    return count != n;
+}
+
+static uint32_t __attribute__((noinline)) recursive_tasks(void) {
+    uint32_t result;
+    uint32_t start = snrt_mcycle();
+#pragma omp parallel
+    {
+#pragma omp single
+        result = fib(FIB_N);
+    }
+    uint32_t cycles = snrt_mcycle() - start;
+    printf("fib(%u), -, %u\n", FIB_N, cycles);
+    return result != fib_serial(FIB_N);
+}
+
+static uint32_t __attribute__((noinline)) irregular_tasks(void) {
+    volatile uint32_t *result =
+        (volatile uint32_t *)snrt_l1_alloc(N * sizeof(uint32_t));
+    uint32_t errs = 0;
+
+    // Reference: all items on a single core
+    uint32_t start = snrt_mcycle();
+    for (uint32_t i = 0; i < N; i++) result[i] = work(i);
+    printf("irregular serial, %u, %u\n", N, snrt_mcycle() - start);
+
+    for (uint32_t i = 0; i < N; i++) result[i] = 0;
+    start = snrt_mcycle();
+#pragma omp parallel
+    {
+#pragma omp single
+        {
+            for (uint32_t i = 0; i < N; i++) {
+#pragma omp task firstprivate(i)
+                result[i] = work(i);
+            }
+        }
+    }
+    printf("irregular, %u, %u\n", N, snrt_mcycle() - start);
+
+    for (uint32_t i = 0; i < N; i++) errs += result[i] != work(i);
+    return errs;
+}
+
+int main() {
+    unsigned core_idx = snrt_cluster_core_idx();
+    unsigned err = 0;
+
+    // Only core 0 executes the statements below this function
+    __snrt_omp_bootstrap(core_idx);
+
+    printf("benchmark, tasks, cycles\n");
+    for (uint32_t i = 0; i < sizeof(num_tasks) / sizeof(num_tasks[0]); i++)
+        err += empty_tasks(num_tasks[i]);
+    err += recursive_tasks();
+    err += irregular_tasks();
+
+    if (err) printf("Error [tasks]: %d mismatches\n", err);
+
+    // exit
+    __snrt_omp_destroy(core_idx);
+    return err;
+}
@@ -0,0 +1,57 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Licensed under the Apache License, Version 2.0, see LICENSE for details.
+// SPDX-License-Identifier: Apache-2.0
+
+// Check that the profiled regions of all cores are flushed to L3, including
+// those spilled by a core whose buffer is full, and measure the overhead of
+// recording a region.
+
+#include "snrt.h"
+
+// More than fit in the TCDM buffer of a core
+#define NUM_REGIONS (SNRT_PERF_REGION_BUF_LEN + 4)
+
+int main() {
+    uint32_t errs = 0;
+
+    snrt_perf_region_init();
+
+    // Count the retired instructions of the first cores
+    if (snrt_cluster_core_idx() == 0) {
+        uint16_t metric =
+            SNITCH_CLUSTER_PERIPHERAL_PERF_CNT_SEL_0_METRIC_0_VALUE_RETIRED_INSTR;
+        for (uint32_t i = 0; i < SNRT_PERF_REGION_NUM_CNTS; i++) {
+            snrt_cfg_perf_counter(i, metric, i);
+            snrt_start_perf_counter(i);
+        }
+    }
+    snrt_cluster_hw_barrier();
+
+    uint32_t start = snrt_mcycle();
+    for (uint32_t i = 0; i < NUM_REGIONS / 2; i++) {
+        snrt_perf_region_begin(i);
+        snrt_perf_region_begin(NUM_REGIONS + i);
+        snrt_perf_region_end(NUM_REGIONS + i);
+        snrt_perf_region_end(i);
+    }
+    uint32_t cycles = (snrt_mcycle() - start) / (2 * NUM_REGIONS);
+
+    // Flushes the buffers to L3
+    snrt_global_barrier();
+
+    snrt_perf_dump_t *dump = snrt_perf_dump_of(snrt_cluster_core_idx());
+    errs += dump->hartid != snrt_hartid();
+    errs += dump->count != 2 * NUM_REGIONS;
+    errs += dump->dropped != 0;
+    for (uint32_t i = 0; i < NUM_REGIONS / 2; i++) {
+        snrt_perf_record_t *r = &dump->records[4 * i];
+        errs += r[0].id != i;
+        errs += r[3].id != (i | SNRT_PERF_REGION_END);
+        errs += r[3].mcycle <= r[0].mcycle;
+    }
+
+    if (snrt_global_core_idx() == 0)
+        printf("cycles per record: %u\n", cycles);
+
+    return errs;
+}
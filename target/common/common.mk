@@ -6,6 +6,7 @@
 DEBUG    ?= OFF  # ON to turn on wave logging
 PL_SIM   ?= 0    # 1 for post-layout simulation
 VCD_DUMP ?= 0    # 1 to dump VCD traces
+BIN_TRACE ?= 0   # 1 to write compressed binary instead of textual traces
 
 # Directories
 SIM_DIR      ?= $(shell pwd)
@@ -62,6 +63,10 @@ RISCV_MC_FLAGS          ?= -disassemble -mcpu=snitch
 ANNOTATE_FLAGS          ?= -q --keep-time --addr2line=$(ADDR2LINE)
 LAYOUT_EVENTS_FLAGS     ?= --cfg=$(CFG)
 
+ifeq ($(BIN_TRACE), 1)
+COMMON_BENDER_FLAGS += -D SNITCH_BINARY_TRACE
+endif
+
 #################
 # Prerequisites #
 #################
@@ -129,14 +134,31 @@ $(1): $(2)/$(4).f $(SN_GEN_RTL_SRCS) | $(2)
 	    -e ':a; s/(^|[[:space:]])$(subst /,\/,$(VLT_BIN))($|[[:space:]])/\1\2/g; ta' $$@
 endef
 
+########################
+# Testbench benchmarks #
+########################
+
+# Standalone microbenchmark of the testbench memory model, built with the
+# host compiler and independent of any RTL simulator.
+MEM_BENCH = $(SN_BIN_DIR)/mem_bench
+
+$(MEM_BENCH): $(TB_DIR)/mem_bench.cc $(TB_DIR)/tb_lib.hh | $(SN_BIN_DIR)
+	$(CXX) -std=c++14 -O2 -I$(TB_DIR) -o $@ $< -lpthread
+
+.PHONY: mem-bench clean-mem-bench
+mem-bench: $(MEM_BENCH)
+	$(MEM_BENCH)
+clean-mem-bench:
+	rm -f $(MEM_BENCH)
+
 ##########
 # Traces #
 ##########
 
-SNITCH_DASM_TRACES      = $(shell (ls $(LOGS_DIR)/trace_hart_*.dasm 2>/dev/null))
-SNITCH_TXT_TRACES       = $(shell (echo $(SNITCH_DASM_TRACES) | sed 's/\.dasm/\.txt/g'))
-SNITCH_ANNOTATED_TRACES = $(shell (echo $(SNITCH_DASM_TRACES) | sed 's/\.dasm/\.s/g'))
-SNITCH_PERF_DUMPS       = $(shell (echo $(SNITCH_DASM_TRACES) | sed 's/trace_hart/hart/g' | sed 's/.dasm/_perf.json/g'))
+SNITCH_DASM_TRACES      = $(shell (ls $(LOGS_DIR)/trace_hart_*.dasm $(LOGS_DIR)/trace_hart_*.bin 2>/dev/null))
+SNITCH_TXT_TRACES       = $(shell (echo $(SNITCH_DASM_TRACES) | sed -E 's/\.(dasm|bin)/\.txt/g'))
+SNITCH_ANNOTATED_TRACES = $(shell (echo $(SNITCH_DASM_TRACES) | sed -E 's/\.(dasm|bin)/\.s/g'))
+SNITCH_PERF_DUMPS       = $(shell (echo $(SNITCH_DASM_TRACES) | sed 's/trace_hart/hart/g' | sed -E 's/\.(dasm|bin)/_perf.json/g'))
 DMA_PERF_DUMPS          = $(LOGS_DIR)/dma_*_perf.json
 
 TXT_TRACES       += $(SNITCH_TXT_TRACES)
@@ -165,6 +187,10 @@ clean-visual-trace:
 $(addprefix $(LOGS_DIR)/,trace_hart_%.txt hart_%_perf.json dma_%_perf.json): $(LOGS_DIR)/trace_hart_%.dasm $(GENTRACE_PY) $(SN_GENTRACE_SRC)
 	$(GENTRACE_PY) $< --mc-exec $(RISCV_MC) --mc-flags "$(RISCV_MC_FLAGS)" --dma-trace $(SIM_DIR)/dma_trace_$*_00000.log --dump-hart-perf $(LOGS_DIR)/hart_$*_perf.json --dump-dma-perf $(LOGS_DIR)/dma_$*_perf.json -o $(LOGS_DIR)/trace_hart_$*.txt
 
+# Binary traces (BIN_TRACE=1) are decoded by the same script
+$(addprefix $(LOGS_DIR)/,trace_hart_%.txt hart_%_perf.json dma_%_perf.json): $(LOGS_DIR)/trace_hart_%.bin $(GENTRACE_PY) $(SN_GENTRACE_SRC) $(UTIL_DIR)/trace/bintrace.py
+	$(GENTRACE_PY) $< --mc-exec $(RISCV_MC) --mc-flags "$(RISCV_MC_FLAGS)" --dma-trace $(SIM_DIR)/dma_trace_$*_00000.log --dump-hart-perf $(LOGS_DIR)/hart_$*_perf.json --dump-dma-perf $(LOGS_DIR)/dma_$*_perf.json -o $(LOGS_DIR)/trace_hart_$*.txt
+
 # Generate source-code interleaved traces for all harts. Reads the binary from
 # the logs/.rtlbinary file that is written at start of simulation in the vsim script
 BINARY ?= $(shell cat $(SIM_DIR)/.rtlbinary)
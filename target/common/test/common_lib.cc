@@ -2,8 +2,16 @@
 // Solderpad Hardware License, Version 0.51, see LICENSE for details.
 // SPDX-License-Identifier: SHL-0.51
 
+#include <elf.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <iostream>
 
+#include "mem_profile.hh"
 #include "sim.hh"
 #include "tb_lib.hh"
 
@@ -18,9 +26,211 @@ extern const uint8_t tb_bootrom_end;
 // The global memory all memory ports write into.
 GlobalMemory MEM;
 
+// Host ranges of the `cow` file mappings, reverted by `Sim::reset_memory`.
+static std::vector<std::pair<void *, size_t>> cow_mappings;
+
+// Copy the `PT_LOAD` segments of a mapped ELF image into the global memory,
+// zeroing the part of each segment not backed by the file (e.g. `.bss`).
+// Returns the loaded address ranges.
+template <typename Ehdr, typename Phdr>
+static std::vector<std::pair<addr_t, size_t>> load_segments(const uint8_t *buf,
+                                                            size_t size) {
+    std::vector<std::pair<addr_t, size_t>> loaded;
+    auto eh = reinterpret_cast<const Ehdr *>(buf);
+    if (size < sizeof(Ehdr) ||
+        size < eh->e_phoff + (size_t)eh->e_phnum * sizeof(Phdr)) {
+        return loaded;
+    }
+    auto ph = reinterpret_cast<const Phdr *>(buf + eh->e_phoff);
+    for (unsigned i = 0; i < eh->e_phnum; i++) {
+        if (ph[i].p_type != PT_LOAD || ph[i].p_memsz == 0) continue;
+        if (ph[i].p_offset + ph[i].p_filesz > size) continue;
+        MEM.write(ph[i].p_paddr, ph[i].p_filesz, buf + ph[i].p_offset,
+                  nullptr);
+        MEM.clear(ph[i].p_paddr + ph[i].p_filesz,
+                  ph[i].p_memsz - ph[i].p_filesz);
+        loaded.emplace_back(ph[i].p_paddr, ph[i].p_memsz);
+    }
+    return loaded;
+}
+
+// Look up the address of symbol `name` in the symbol table of a mapped ELF
+// image. Returns zero if there is no such symbol.
+template <typename Ehdr, typename Shdr, typename Sym>
+static addr_t find_symbol(const uint8_t *buf, size_t size, const char *name) {
+    auto eh = reinterpret_cast<const Ehdr *>(buf);
+    if (size < sizeof(Ehdr) ||
+        size < eh->e_shoff + (size_t)eh->e_shnum * sizeof(Shdr)) {
+        return 0;
+    }
+    auto sh = reinterpret_cast<const Shdr *>(buf + eh->e_shoff);
+    for (unsigned i = 0; i < eh->e_shnum; i++) {
+        if (sh[i].sh_type != SHT_SYMTAB || sh[i].sh_link >= eh->e_shnum) {
+            continue;
+        }
+        const Shdr &strtab = sh[sh[i].sh_link];
+        if (sh[i].sh_offset + sh[i].sh_size > size ||
+            strtab.sh_offset + strtab.sh_size > size) {
+            continue;
+        }
+        auto syms = reinterpret_cast<const Sym *>(buf + sh[i].sh_offset);
+        auto strs = reinterpret_cast<const char *>(buf + strtab.sh_offset);
+        for (size_t j = 0; j < sh[i].sh_size / sizeof(Sym); j++) {
+            if (syms[j].st_name < strtab.sh_size &&
+                strncmp(strs + syms[j].st_name, name,
+                        strtab.sh_size - syms[j].st_name) == 0) {
+                return syms[j].st_value;
+            }
+        }
+    }
+    return 0;
+}
+
+void Sim::scan_elf(const std::string &path) {
+    auto start = std::chrono::steady_clock::now();
+    int fd = open(path.c_str(), O_RDONLY);
+    // Leave anything we cannot handle to the `fesvr` loader.
+    if (fd < 0) return;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < EI_NIDENT) {
+        close(fd);
+        return;
+    }
+    size_t size = st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return;
+    auto buf = static_cast<const uint8_t *>(map);
+    if (memcmp(buf, ELFMAG, SELFMAG) != 0 || buf[EI_DATA] != ELFDATA2LSB) {
+        munmap(map, size);
+        return;
+    }
+    bool is_64 = buf[EI_CLASS] == ELFCLASS64;
+    if (is_64) {
+        htif_tohost_addr =
+            find_symbol<Elf64_Ehdr, Elf64_Shdr, Elf64_Sym>(buf, size, "tohost");
+    } else {
+        htif_tohost_addr =
+            find_symbol<Elf32_Ehdr, Elf32_Shdr, Elf32_Sym>(buf, size, "tohost");
+    }
+    if (disable_preloading) {
+        munmap(map, size);
+        return;
+    }
+    if (is_64) {
+        preloaded = load_segments<Elf64_Ehdr, Elf64_Phdr>(buf, size);
+    } else {
+        preloaded = load_segments<Elf32_Ehdr, Elf32_Phdr>(buf, size);
+    }
+    munmap(map, size);
+    auto end = std::chrono::steady_clock::now();
+    size_t bytes = 0;
+    for (const auto &r : preloaded) bytes += r.second;
+    printf("[TB] Preloaded %zu bytes in %zu segments from `%s` in %.3f ms\n",
+           bytes, preloaded.size(), path.c_str(),
+           std::chrono::duration<double, std::milli>(end - start).count());
+}
+
+Sim::~Sim() {
+    for (int handle : watchpoints) MEM.remove_watchpoint(handle);
+    MEM_PROFILE.finish();
+}
+
+void Sim::reset_memory() {
+    MEM.reset();
+    // Drop the private copies of written pages, which are then faulted in
+    // from the file again.
+    for (const auto &m : cow_mappings) {
+        madvise(m.first, m.second, MADV_DONTNEED);
+    }
+}
+
+void Sim::map_files(int argc, char **argv) {
+    static constexpr char MAP_FILE_FLAG[11] = "--map-file";
+    // Files are mapped once per process, even if several binaries are run.
+    static bool mapped = false;
+    if (mapped) return;
+    mapped = true;
+    for (int i = 1; i < argc; i++) {
+        const char *spec = nullptr;
+        if (strcmp(argv[i], MAP_FILE_FLAG) == 0 && i + 1 < argc) {
+            spec = argv[++i];
+        } else if (strncmp(argv[i], MAP_FILE_FLAG, strlen(MAP_FILE_FLAG)) ==
+                       0 &&
+                   argv[i][strlen(MAP_FILE_FLAG)] == '=') {
+            spec = argv[i] + strlen(MAP_FILE_FLAG) + 1;
+        }
+        if (spec) map_file(spec);
+    }
+}
+
+void Sim::map_file(const std::string &spec) {
+    // Parse `<path>@<addr>[,ro|rw|cow]`
+    auto at = spec.rfind('@');
+    if (at == std::string::npos) {
+        fprintf(stderr, "[TB] Invalid --map-file `%s`\n", spec.c_str());
+        exit(1);
+    }
+    std::string path = spec.substr(0, at);
+    char *end;
+    addr_t base = strtoull(spec.c_str() + at + 1, &end, 0);
+    std::string mode = *end == ',' ? end + 1 : "cow";
+    int prot = PROT_READ, flags = MAP_PRIVATE, oflags = O_RDONLY;
+    if (mode == "rw") {
+        prot |= PROT_WRITE;
+        flags = MAP_SHARED;
+        oflags = O_RDWR;
+    } else if (mode == "cow") {
+        prot |= PROT_WRITE;
+    }
+    if ((*end != '\0' && *end != ',') ||
+        (mode != "ro" && mode != "rw" && mode != "cow")) {
+        fprintf(stderr, "[TB] Invalid --map-file `%s`\n", spec.c_str());
+        exit(1);
+    }
+
+    int fd = open(path.c_str(), oflags);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        fprintf(stderr, "[TB] Cannot open `%s`: %s\n", path.c_str(),
+                strerror(errno));
+        exit(1);
+    }
+    size_t size = st.st_size;
+    // Pages are only faulted in as the target touches them, so even very
+    // large inputs are mapped instantly.
+    void *map = size ? mmap(NULL, size, prot, flags, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "[TB] Cannot map `%s`: %s\n", path.c_str(),
+                size ? strerror(errno) : "empty file");
+        exit(1);
+    }
+    if (!MEM.add_mapping({base, size, (uint8_t *)map, mode != "ro"})) {
+        fprintf(stderr, "[TB] Mapping of `%s` overlaps another mapping\n",
+                path.c_str());
+        exit(1);
+    }
+    if (mode == "cow") cow_mappings.emplace_back(map, size);
+    printf("[TB] Mapped `%s` (%s) to [0x%lx, 0x%lx)\n", path.c_str(),
+           mode.c_str(), base, base + size);
+}
+
+bool Sim::is_bulk_preloaded(addr_t taddr, size_t len) const {
+    for (const auto &r : preloaded) {
+        if (taddr >= r.first && taddr + len <= r.first + r.second) return true;
+    }
+    return false;
+}
+
 // Override HTIF to populate bootloader with system specification and entry
-// symbol.
-void Sim::start() { htif_t::start(); }
+// symbol. Unless preloading is disabled altogether, the binary's segments are
+// copied into memory up front, and `fesvr` only parses the ELF for its
+// symbols.
+void Sim::start() {
+    if (!target_args().empty()) scan_elf(target_args()[0]);
+    htif_t::start();
+}
 
 void Sim::read_chunk(addr_t taddr, size_t len, void *dst) {
     MEM.read(taddr, len, reinterpret_cast<uint8_t *>(dst));
@@ -5,8 +5,39 @@
 // Paul Scheffler <paulsc@iis.ee.ethz.ch>
 
 #include "ipc.hh"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "mem_profile.hh"
 #include "tb_lib.hh"
 
+// Block until the masked 32b word at `addr` differs from the masked
+// `expected` value, and return the last word read. The thread sleeps on a
+// memory watchpoint rather than polling, and is woken up by the write.
+uint32_t IpcIface::poll(uint64_t addr, uint32_t mask, uint32_t expected) {
+    return sim::MEM.wait_for_change(addr, mask, expected);
+}
+
+// Control the memory profiler. Returns zero on success.
+uint32_t IpcIface::profile(uint64_t action) {
+    switch (action) {
+        case ProfileStop:
+            sim::MEM_PROFILE.stop();
+            return 0;
+        case ProfileStart:
+            sim::MEM_PROFILE.start();
+            return 0;
+        case ProfileDump:
+            return sim::MEM_PROFILE.dump() ? 0 : 1;
+        default:
+            return 1;
+    }
+}
+
 void* IpcIface::ipc_thread_handle(void* in) {
     ipc_targs_t* targs = (ipc_targs_t*)in;
     // Open FIFOs
@@ -58,24 +89,25 @@ void* IpcIface::ipc_thread_handle(void* in) {
                     fread(buf_data, op.len, 1, tx);
                     sim::MEM.write(op.addr, op.len, buf_data, buf_strb);
                     break;
-                case Poll:
+                case Poll: {
                     // Unpack 32b checking mask and expected value from length
                     uint32_t mask = op.len & 0xFFFFFFFF;
                     uint32_t expected = (op.len >> 32) & 0xFFFFFFFF;
                     printf("[IPC] Poll on 0x%x mask 0x%x expected 0x%x ...\n",
                            op.addr, mask, expected);
-                    uint32_t read;
-                    do {
-                        sim::MEM.read(op.addr, sizeof(uint32_t),
-                                      (uint8_t*)(void*)&read);
-                        nanosleep(
-                            (const struct timespec[]){{0, IPC_POLL_PERIOD_NS}},
-                            NULL);
-                    } while ((read & mask) == (expected & mask));
+                    uint32_t read = poll(op.addr, mask, expected);
                     // Send back read 32b word
                     fwrite(&read, sizeof(uint32_t), 1, rx);
                     fflush(rx);
                     break;
+                }
+                case Profile: {
+                    printf("[IPC] Memory profile action %d ...\n", op.addr);
+                    uint32_t status = profile(op.addr);
+                    fwrite(&status, sizeof(uint32_t), 1, rx);
+                    fflush(rx);
+                    break;
+                }
             }
         }
     }
@@ -86,12 +118,135 @@ void* IpcIface::ipc_thread_handle(void* in) {
     pthread_exit(NULL);
 }
 
+void* IpcIface::ipc_shm_thread_handle(void* in) {
+    ipc_targs_t* targs = (ipc_targs_t*)in;
+    ipc_shm_hdr_t* hdr = targs->shm;
+    uint8_t* buf = (uint8_t*)hdr + hdr->buf_offset;
+    uint64_t tail = hdr->tail.load(std::memory_order_relaxed);
+    long backoff = IPC_SHM_MIN_BACKOFF_NS;
+
+    while (1) {
+        if (tail == hdr->head.load(std::memory_order_acquire)) {
+            // Commands posted before closing are still served
+            if (hdr->closed.load(std::memory_order_acquire)) break;
+            // A client which crashed or was killed never closes the channel
+            pid_t client = hdr->client_pid.load(std::memory_order_relaxed);
+            if (client > 0 && kill(client, 0) != 0 && errno == ESRCH) {
+                printf("[IPC] Client %d exited without closing the channel.\n",
+                       client);
+                break;
+            }
+            struct timespec period = {0, backoff};
+            nanosleep(&period, NULL);
+            backoff = 2 * backoff < IPC_SHM_MAX_BACKOFF_NS
+                          ? 2 * backoff
+                          : IPC_SHM_MAX_BACKOFF_NS;
+            continue;
+        }
+        backoff = IPC_SHM_MIN_BACKOFF_NS;
+        ipc_shm_cmd_t* cmd = &hdr->ring[tail % IPC_SHM_RING_SIZE];
+        uint64_t len = std::min<uint64_t>(cmd->len, hdr->buf_size);
+        switch (cmd->opcode) {
+            case Read:
+                sim::MEM.read(cmd->addr, len, buf);
+                break;
+            case Write:
+                sim::MEM.write(cmd->addr, len, buf, nullptr);
+                break;
+            case Poll:
+                cmd->result = poll(cmd->addr, cmd->len & 0xFFFFFFFF,
+                                   (cmd->len >> 32) & 0xFFFFFFFF);
+                break;
+            case Profile:
+                cmd->result = profile(cmd->addr);
+                break;
+        }
+        hdr->tail.store(++tail, std::memory_order_release);
+    }
+
+    printf("[IPC] Shared-memory channel closed. Joining main thread.\n");
+    pthread_exit(NULL);
+}
+
+// Create the shared-memory segment and back the memory region of `size`
+// bytes starting at the global memory base with it. The testbench accesses
+// this region through a mapping, i.e. not on the page-table fast path, so it
+// should only cover the data exchanged with the client.
+void IpcIface::shm_create(const char* name, uint64_t size) {
+    size_t hdr_len = sizeof(ipc_shm_hdr_t);
+    size_t buf_offset = (hdr_len + IPC_SHM_ALIGN - 1) / IPC_SHM_ALIGN *
+                        IPC_SHM_ALIGN;
+    size_t data_offset = buf_offset + IPC_SHM_BUF_SIZE;
+    size_t len = data_offset + size;
+
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 || ftruncate(fd, len) < 0) {
+        fprintf(stderr, "[IPC] Failed to create shared memory `%s`: %s\n",
+                name, strerror(errno));
+        exit(IPC_ERR_SHM);
+    }
+    void* map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "[IPC] Failed to map shared memory `%s`: %s\n", name,
+                strerror(errno));
+        shm_unlink(name);
+        exit(IPC_ERR_SHM);
+    }
+
+    // The segment is zero-filled, so only the static fields need setting
+    ipc_shm_hdr_t* hdr = (ipc_shm_hdr_t*)map;
+    hdr->base = sim::BOOTDATA.global_mem_start;
+    hdr->size = size;
+    hdr->data_offset = data_offset;
+    hdr->buf_offset = buf_offset;
+    hdr->buf_size = IPC_SHM_BUF_SIZE;
+    hdr->ring_size = IPC_SHM_RING_SIZE;
+    hdr->client_pid = getppid();
+    if (size && !sim::MEM.add_mapping(
+                    {hdr->base, size, (uint8_t*)map + data_offset, true})) {
+        fprintf(stderr, "[IPC] Shared memory `%s` overlaps another mapping\n",
+                name);
+        shm_unlink(name);
+        exit(IPC_ERR_SHM);
+    }
+    // Publish the segment to the client last
+    std::atomic_thread_fence(std::memory_order_release);
+    hdr->magic = IPC_SHM_MAGIC;
+
+    targs.shm = hdr;
+}
+
 // Conditionally construct IPC iff any arguments specify it
 IpcIface::IpcIface(int argc, char** argv) {
     static constexpr char IPC_FLAG[6] = "--ipc";
+    static constexpr char IPC_SHM_FLAG[10] = "--ipc-shm";
     active = false;
+    targs.shm_name = NULL;
+    targs.shm = NULL;
     for (auto i = 1; i < argc; ++i) {
-        if (strncmp(argv[i], IPC_FLAG, strlen(IPC_FLAG)) == 0) {
+        if (strncmp(argv[i], IPC_SHM_FLAG, strlen(IPC_SHM_FLAG)) == 0) {
+            // Check for duplicate args
+            if (active) {
+                fprintf(stderr, "[IPC] Duplicate IPC thread args: %s", argv[i]);
+                exit(IPC_ERR_DOUBLE_ARG);
+            }
+            // Parse shared memory name and optional region size. Without a
+            // shared region, all accesses go through the command ring.
+            char* ipc_args = argv[i] + strlen(IPC_SHM_FLAG) + 1;
+            char* name = strtok(ipc_args, ",");
+            char* size_arg = strtok(NULL, ",");
+            uint64_t size = size_arg ? strtoull(size_arg, NULL, 0) : 0;
+            targs.shm_name = (char*)malloc(strlen(name) + 1);
+            strcpy(targs.shm_name, name);
+            shm_create(targs.shm_name, size);
+            pthread_create(&thread, NULL, *ipc_shm_thread_handle,
+                           (void*)&targs);
+            printf("[IPC] Thread launched with shared memory `%s` "
+                   "(0x%lx bytes)\n",
+                   targs.shm_name, size);
+            active = true;
+        } else if (strncmp(argv[i], IPC_FLAG, strlen(IPC_FLAG)) == 0) {
             // Check for duplicate args
             if (active) {
                 fprintf(stderr, "[IPC] Duplicate IPC thread args: %s", argv[i]);
@@ -121,7 +276,14 @@ IpcIface::~IpcIface() {
         pthread_join(thread, NULL);
         printf("[IPC] Thread joined\n");
         active = false;
-        free(targs.tx);
-        free(targs.rx);
+        if (targs.shm) {
+            // The global memory may still be accessed after this point, so
+            // the mapping is kept alive until the process exits.
+            shm_unlink(targs.shm_name);
+            free(targs.shm_name);
+        } else {
+            free(targs.tx);
+            free(targs.rx);
+        }
     }
 }
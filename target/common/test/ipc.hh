@@ -14,19 +14,40 @@
 #include <time.h>
 
 #include <algorithm>
+#include <atomic>
 
 class IpcIface {
    private:
     static const int IPC_BUF_SIZE = 4096;
     static const int IPC_BUF_SIZE_STRB = IPC_BUF_SIZE / 8 + 1;
     static const int IPC_ERR_DOUBLE_ARG = 30;
-    static const long IPC_POLL_PERIOD_NS = 100000L;
+    static const int IPC_ERR_SHM = 31;
+    // Bounds of the exponential backoff while the shared-memory channel is
+    // idle, such that bursts of commands are served with low latency
+    static const long IPC_SHM_MIN_BACKOFF_NS = 1000L;
+    static const long IPC_SHM_MAX_BACKOFF_NS = 1000000L;
+
+    // Shared-memory channel: magic marking a ready segment ("SNIPCSHM"),
+    // number of command slots and size of the bounce buffer used for
+    // accesses outside the shared region.
+    static const uint64_t IPC_SHM_MAGIC = 0x4d48534350494e53ULL;
+    static const int IPC_SHM_RING_SIZE = 64;
+    static const size_t IPC_SHM_BUF_SIZE = 1 << 20;
+    static const size_t IPC_SHM_ALIGN = 4096;
 
     // Possible IPC operations
     enum ipc_opcode_e {
         Read = 0,
         Write = 1,
         Poll = 2,
+        Profile = 3,
+    };
+
+    // Memory profiler actions, passed in the address of a `Profile` op
+    enum ipc_profile_e {
+        ProfileStop = 0,
+        ProfileStart = 1,
+        ProfileDump = 2,
     };
 
     // Operations are 3 doubles, followed by data streams in either direction
@@ -36,10 +57,45 @@ class IpcIface {
         uint64_t len;
     } ipc_op_t;
 
+    // Shared-memory command. Read and write data is exchanged through the
+    // bounce buffer, poll results are returned in `result`.
+    typedef struct {
+        uint64_t opcode;
+        uint64_t addr;
+        uint64_t len;
+        uint64_t result;
+    } ipc_shm_cmd_t;
+
+    // Header of the shared-memory segment. The client produces commands by
+    // filling `ring[head % IPC_SHM_RING_SIZE]` and incrementing `head`; the
+    // testbench consumes them and increments `tail` once each completes.
+    // Only one command using the bounce buffer may be in flight at a time.
+    // The memory region `[base, base + size)`, if not empty, is backed
+    // directly by the segment at `data_offset`. The testbench stops serving
+    // the channel once the client sets `closed`, or once the process
+    // `client_pid` exits. It defaults to the parent of the testbench, and may
+    // be overwritten by the client.
+    typedef struct {
+        uint64_t magic;
+        uint64_t base;
+        uint64_t size;
+        uint64_t data_offset;
+        uint64_t buf_offset;
+        uint64_t buf_size;
+        uint64_t ring_size;
+        std::atomic<uint64_t> head;
+        std::atomic<uint64_t> tail;
+        std::atomic<uint64_t> closed;
+        std::atomic<int64_t> client_pid;
+        ipc_shm_cmd_t ring[IPC_SHM_RING_SIZE];
+    } ipc_shm_hdr_t;
+
     // Args passed to IPC thread
     typedef struct {
         char* tx;
         char* rx;
+        char* shm_name;
+        ipc_shm_hdr_t* shm;
     } ipc_targs_t;
 
     // Thread to asynchronously handle FIFOs
@@ -48,6 +104,11 @@ class IpcIface {
     bool active;
 
     static void* ipc_thread_handle(void* in);
+    static void* ipc_shm_thread_handle(void* in);
+    static uint32_t poll(uint64_t addr, uint32_t mask, uint32_t expected);
+    static uint32_t profile(uint64_t action);
+
+    void shm_create(const char* name, uint64_t size);
 
    public:
     IpcIface(int argc, char** argv);
@@ -0,0 +1,182 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+
+// Standalone microbenchmark of the simulation memory model. Replays the
+// access patterns of the `tb_memory_read`/`tb_memory_write` DPI calls without
+// any RTL simulator, and compares the `GlobalMemory` implementation against
+// the original hash-map based one, which is reproduced below for reference.
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <iostream>
+#include <unordered_map>
+
+#include "tb_lib.hh"
+
+// Reference implementation: one hash-map lookup per page and a linear
+// mapping scan per byte.
+struct LegacyMemory {
+    static constexpr size_t ADDR_SHIFT = 12;
+    static constexpr size_t SIZE_OF_PAGE = (size_t)1 << ADDR_SHIFT;
+
+    std::unordered_map<uint64_t, std::unique_ptr<uint8_t[]>> pages;
+    std::set<uint64_t> touched;
+    std::vector<sim::GlobalMemory::Mapping> mappings;
+
+    uint8_t *find_mapping(uint64_t addr) const {
+        for (const auto &m : mappings) {
+            if (m.base <= addr && m.base + m.size > addr) {
+                return m.into + (addr - m.base);
+            }
+        }
+        return nullptr;
+    }
+
+    void write(size_t addr, size_t len, const uint8_t *data,
+               const uint8_t *strb) {
+        size_t end = addr + len;
+        size_t data_idx = 0;
+        while (addr < end) {
+            size_t byte_start = addr;
+            addr >>= ADDR_SHIFT;
+            auto &page = pages[addr];
+            uint64_t page_idx = addr;
+            if (!page) {
+                page = std::make_unique<uint8_t[]>(SIZE_OF_PAGE);
+                std::fill(&page[0], &page[SIZE_OF_PAGE], 0);
+            }
+            addr += 1;
+            addr <<= ADDR_SHIFT;
+            size_t byte_end = std::min(addr, end);
+            bool any_changed = false;
+            for (size_t i = byte_start; i < byte_end; i++, data_idx++) {
+                if (!strb || strb[data_idx]) {
+                    auto host = find_mapping(i);
+                    if (host) {
+                        *host = data[data_idx];
+                    } else {
+                        page[i % SIZE_OF_PAGE] = data[data_idx];
+                        any_changed = true;
+                    }
+                }
+            }
+            if (any_changed) touched.insert(page_idx);
+        }
+        std::cout << std::dec;
+    }
+
+    void read(size_t addr, size_t len, uint8_t *data) {
+        size_t end = addr + len;
+        size_t data_idx = 0;
+        while (addr < end) {
+            size_t byte_start = addr;
+            addr >>= ADDR_SHIFT;
+            auto &page = pages[addr];
+            addr += 1;
+            addr <<= ADDR_SHIFT;
+            size_t byte_end = std::min(addr, end);
+            for (size_t i = byte_start; i < byte_end; i++, data_idx++) {
+                auto host = find_mapping(i);
+                if (host) {
+                    data[data_idx] = *host;
+                } else {
+                    data[data_idx] = page ? page[i % SIZE_OF_PAGE] : 0;
+                }
+            }
+        }
+        std::cout << std::dec;
+    }
+};
+
+// Base address and footprint of the benchmarked region (L3 in the default
+// Snitch cluster configuration).
+static const uint64_t BASE_ADDR = 0x80000000;
+static const size_t FOOTPRINT = 16 << 20;
+
+template <typename Mem>
+static double run_beats(Mem &mem, size_t beat_bytes, size_t num_beats,
+                        bool write, bool partial_strb) {
+    uint8_t data[64];
+    uint8_t strb[64];
+    for (size_t i = 0; i < beat_bytes; i++) {
+        data[i] = i;
+        strb[i] = partial_strb ? (i & 1) : 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    uint64_t addr = BASE_ADDR;
+    for (size_t i = 0; i < num_beats; i++) {
+        if (write) {
+            mem.write(addr, beat_bytes, data, strb);
+        } else {
+            mem.read(addr, beat_bytes, data);
+        }
+        // Sequential bursts, wrapping around the footprint
+        addr += beat_bytes;
+        if (addr >= BASE_ADDR + FOOTPRINT) addr = BASE_ADDR;
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+template <typename Mem>
+static double run_bulk(Mem &mem, size_t block_bytes, size_t num_blocks,
+                       bool write) {
+    auto buf = std::make_unique<uint8_t[]>(block_bytes);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t addr = BASE_ADDR;
+    for (size_t i = 0; i < num_blocks; i++) {
+        if (write) {
+            mem.write(addr, block_bytes, buf.get(), nullptr);
+        } else {
+            mem.read(addr, block_bytes, buf.get());
+        }
+        addr += block_bytes;
+        if (addr + block_bytes > BASE_ADDR + FOOTPRINT) addr = BASE_ADDR;
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+static void report(const char *name, size_t bytes, double legacy, double t) {
+    printf("%-28s %10.1f MB/s %10.1f MB/s %8.1fx\n", name,
+           bytes / legacy / 1e6, bytes / t / 1e6, legacy / t);
+}
+
+int main(int argc, char **argv) {
+    // Scale the amount of traffic with an optional argument (in MiB)
+    size_t traffic = (argc > 1 ? strtoul(argv[1], NULL, 0) : 64) << 20;
+    size_t beat = 8;
+    size_t beats = traffic / beat;
+    size_t block = 4096;
+    size_t blocks = traffic / block;
+
+    LegacyMemory legacy;
+    sim::GlobalMemory mem;
+
+    printf("%-28s %15s %15s %9s\n", "Benchmark", "Legacy", "GlobalMemory",
+           "Speedup");
+    // Populate both memories first, so that page allocation is not measured
+    run_bulk(legacy, block, FOOTPRINT / block, true);
+    run_bulk(mem, block, FOOTPRINT / block, true);
+
+    report("dpi write 64b full strobe", traffic,
+           run_beats(legacy, beat, beats, true, false),
+           run_beats(mem, beat, beats, true, false));
+    report("dpi write 64b partial strobe", traffic,
+           run_beats(legacy, beat, beats, true, true),
+           run_beats(mem, beat, beats, true, true));
+    report("dpi read 64b", traffic,
+           run_beats(legacy, beat, beats, false, false),
+           run_beats(mem, beat, beats, false, false));
+    report("dpi write 512b full strobe", traffic,
+           run_beats(legacy, 64, traffic / 64, true, false),
+           run_beats(mem, 64, traffic / 64, true, false));
+    report("bulk write 4KiB", traffic, run_bulk(legacy, block, blocks, true),
+           run_bulk(mem, block, blocks, true));
+    report("bulk read 4KiB", traffic, run_bulk(legacy, block, blocks, false),
+           run_bulk(mem, block, blocks, false));
+    return 0;
+}
@@ -0,0 +1,164 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+
+#include "mem_profile.hh"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "tb_lib.hh"
+
+namespace sim {
+
+MemProfile MEM_PROFILE;
+
+void MemProfile::configure(int argc, char **argv) {
+    static constexpr char MEM_PROFILE_FLAG[14] = "--mem-profile";
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], MEM_PROFILE_FLAG, strlen(MEM_PROFILE_FLAG)) != 0) {
+            continue;
+        }
+        const char *arg = argv[i] + strlen(MEM_PROFILE_FLAG);
+        if (*arg == '=') {
+            // `--mem-profile=<path>[@<window_ns>]`
+            path = arg + 1;
+            auto at = path.rfind('@');
+            if (at != std::string::npos) {
+                window_ns = std::max(
+                    1ul, strtoul(path.c_str() + at + 1, NULL, 0));
+                path.resize(at);
+            }
+        } else if (*arg != '\0') {
+            continue;
+        }
+        printf("[TB] Profiling memory traffic to `%s` (%lu ns windows)\n",
+               path.c_str(), window_ns);
+        start();
+    }
+}
+
+void MemProfile::start() {
+    std::lock_guard<std::mutex> lock(mutex);
+    total = Counters();
+    pages.clear();
+    last_page = UINT64_MAX;
+    last_counters = nullptr;
+    windows.clear();
+    first_window = UINT64_MAX;
+    std::fill_n(read_sizes, SIZE_BINS, 0);
+    std::fill_n(write_sizes, SIZE_BINS, 0);
+    started = true;
+    on.store(true, std::memory_order_relaxed);
+}
+
+void MemProfile::stop() { on.store(false, std::memory_order_relaxed); }
+
+void MemProfile::record(bool write, uint64_t addr, size_t bytes,
+                        uint64_t time_ps) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Bus words never cross a page.
+    uint64_t page = addr >> GlobalMemory::ADDR_SHIFT;
+    if (page != last_page) {
+        last_page = page;
+        last_counters = &pages[page];
+    }
+    uint64_t window = time_ps / 1000 / window_ns;
+    if (first_window == UINT64_MAX) first_window = window;
+    window = window > first_window ? window - first_window : 0;
+    if (window >= windows.size()) windows.resize(window + 1);
+    size_t bin = 0;
+    while (bin + 1 < SIZE_BINS && ((size_t)1 << bin) < bytes) bin++;
+
+    Counters *counters[] = {&total, last_counters, &windows[window]};
+    for (Counters *c : counters) {
+        if (write) {
+            c->writes++;
+            c->write_bytes += bytes;
+        } else {
+            c->reads++;
+            c->read_bytes += bytes;
+        }
+    }
+    (write ? write_sizes : read_sizes)[bin]++;
+}
+
+void MemProfile::record_write(uint64_t addr, size_t len, const uint8_t *strb,
+                              uint64_t time_ps) {
+    size_t bytes = 0;
+    for (size_t i = 0; i < len; i++) bytes += strb[i] != 0;
+    record(true, addr, bytes, time_ps);
+}
+
+bool MemProfile::dump() {
+    std::lock_guard<std::mutex> lock(mutex);
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f) {
+        fprintf(stderr, "[TB] Cannot write memory profile `%s`\n",
+                path.c_str());
+        return false;
+    }
+    auto counters = [f](const Counters &c) {
+        fprintf(f,
+                "{\"reads\": %lu, \"writes\": %lu, \"read_bytes\": %lu, "
+                "\"write_bytes\": %lu}",
+                c.reads, c.writes, c.read_bytes, c.write_bytes);
+    };
+    auto histogram = [f](const uint64_t *bins) {
+        fprintf(f, "{");
+        const char *sep = "";
+        for (size_t i = 0; i < SIZE_BINS; i++) {
+            if (!bins[i]) continue;
+            fprintf(f, "%s\"%zu\": %lu", sep, (size_t)1 << i, bins[i]);
+            sep = ", ";
+        }
+        fprintf(f, "}");
+    };
+
+    fprintf(f, "{\n  \"page_size\": %zu,\n  \"window_ns\": %lu,\n",
+            GlobalMemory::SIZE_OF_PAGE, window_ns);
+    fprintf(f, "  \"first_window_ns\": %lu,\n",
+            first_window == UINT64_MAX ? 0 : first_window * window_ns);
+    fprintf(f, "  \"total\": ");
+    counters(total);
+    fprintf(f, ",\n  \"access_sizes\": {\"read\": ");
+    histogram(read_sizes);
+    fprintf(f, ", \"write\": ");
+    histogram(write_sizes);
+    // Bandwidth as the bytes read and written in each window.
+    fprintf(f, "},\n  \"windows\": {\"read_bytes\": [");
+    for (size_t i = 0; i < windows.size(); i++) {
+        fprintf(f, "%s%lu", i ? ", " : "", windows[i].read_bytes);
+    }
+    fprintf(f, "], \"write_bytes\": [");
+    for (size_t i = 0; i < windows.size(); i++) {
+        fprintf(f, "%s%lu", i ? ", " : "", windows[i].write_bytes);
+    }
+    fprintf(f, "]},\n  \"pages\": {");
+    std::vector<uint64_t> order;
+    order.reserve(pages.size());
+    for (const auto &p : pages) order.push_back(p.first);
+    std::sort(order.begin(), order.end());
+    for (size_t i = 0; i < order.size(); i++) {
+        fprintf(f, "%s\n    \"0x%lx\": ", i ? "," : "",
+                order[i] << GlobalMemory::ADDR_SHIFT);
+        counters(pages[order[i]]);
+    }
+    fprintf(f, "\n  }\n}\n");
+    fclose(f);
+    printf("[TB] Wrote memory profile `%s` (%zu pages, %zu windows)\n",
+           path.c_str(), pages.size(), windows.size());
+    return true;
+}
+
+void MemProfile::finish() {
+    if (!started) return;
+    stop();
+    dump();
+    started = false;
+}
+
+}  // namespace sim
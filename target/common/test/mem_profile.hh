@@ -0,0 +1,86 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+
+// Profiler of the memory traffic between the DUT and the global memory.
+// Accesses made through the memory DPI calls are counted per page, per time
+// window and per access size, and dumped as JSON. The profiler costs a
+// single relaxed load per access while it is disabled, and can be switched
+// on and off at runtime through IPC.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sim {
+
+class MemProfile {
+   public:
+    // Default dump path and time window (in ns) if not configured.
+    static constexpr const char *DEFAULT_PATH = "mem_profile.json";
+    static constexpr uint64_t DEFAULT_WINDOW_NS = 1000;
+
+    // Parse `--mem-profile[=<path>[@<window_ns>]]`, which enables the
+    // profiler from the start of the simulation.
+    void configure(int argc, char **argv);
+
+    bool enabled() const { return on.load(std::memory_order_relaxed); }
+
+    // Clear all counters and start counting.
+    void start();
+    // Stop counting. The counters are kept until the next `start`.
+    void stop();
+
+    // Count an access of `bytes` bytes within the bus word at `addr`,
+    // issued at `time_ps`. Only call while `enabled()`.
+    void record(bool write, uint64_t addr, size_t bytes, uint64_t time_ps);
+    // Count a write to the `len`-byte bus word at `addr` with per-byte
+    // strobes `strb`.
+    void record_write(uint64_t addr, size_t len, const uint8_t *strb,
+                      uint64_t time_ps);
+
+    // Write the counters to the configured path. Returns false on failure.
+    bool dump();
+    // Dump the counters if the profiler was ever started since the last
+    // call, then disable it. Called at the end of a binary's simulation.
+    void finish();
+
+   private:
+    struct Counters {
+        uint64_t reads = 0;
+        uint64_t writes = 0;
+        uint64_t read_bytes = 0;
+        uint64_t write_bytes = 0;
+    };
+    // Access sizes are binned by powers of two, up to a 64 KiB bus word.
+    static constexpr size_t SIZE_BINS = 17;
+
+    std::atomic<bool> on{false};
+    bool started = false;
+    std::string path = DEFAULT_PATH;
+    uint64_t window_ns = DEFAULT_WINDOW_NS;
+
+    // All counters are updated by the simulation thread, and read by the
+    // IPC thread when it requests a dump.
+    std::mutex mutex;
+    Counters total;
+    std::unordered_map<uint64_t, Counters> pages;
+    // Last page accessed, to skip the hash lookup for sequential accesses.
+    uint64_t last_page = UINT64_MAX;
+    Counters *last_counters = nullptr;
+    std::vector<Counters> windows;
+    uint64_t first_window = UINT64_MAX;
+    uint64_t read_sizes[SIZE_BINS] = {};
+    uint64_t write_sizes[SIZE_BINS] = {};
+};
+
+// The profile of the global memory traffic.
+extern MemProfile MEM_PROFILE;
+
+}  // namespace sim
@@ -8,6 +8,7 @@
 #include <iostream>
 #include <memory>
 
+#include "mem_profile.hh"
 #include "sim.hh"
 #include "tb_lib.hh"
 
@@ -27,6 +28,8 @@ namespace sim {
 void sim_thread_main(void *arg) { ((Sim *)arg)->main(); }
 
 Sim::Sim(int argc, char **argv) : htif_t(argc, argv), ipc(argc, argv) {
+    map_files(argc, argv);
+    MEM_PROFILE.configure(argc, argv);
     for (auto i = 1; i < argc; ++i) {
         if (strcmp(argv[i], "--disable_preloading") == 0) {
             printf("fesvr-based binary preloading disabled\n");
@@ -112,6 +115,14 @@ int fesvr_tick() {
 // Destroy simulation object, synchronizes the IPC thread
 void fesvr_cleanup() { s.reset(); }
 
+// Current simulation time in ps, the simulation precision.
+static uint64_t time_ps() {
+    s_vpi_time t;
+    t.type = vpiSimTime;
+    vpi_get_time(NULL, &t);
+    return (uint64_t)t.high << 32 | t.low;
+}
+
 // DPI calls.
 void tb_memory_read(long long addr, int len, const svOpenArrayHandle data) {
     // std::cout << "[TB] Read " << std::hex << addr << std::dec << " (" << len
@@ -119,6 +130,9 @@ void tb_memory_read(long long addr, int len, const svOpenArrayHandle data) {
     void *data_ptr = svGetArrayPtr(data);
     assert(data_ptr);
     sim::MEM.read(addr, len, (uint8_t *)data_ptr);
+    if (sim::MEM_PROFILE.enabled()) {
+        sim::MEM_PROFILE.record(false, addr, len, time_ps());
+    }
 }
 
 void tb_memory_write(long long addr, int len, const svOpenArrayHandle data,
@@ -131,6 +145,10 @@ void tb_memory_write(long long addr, int len, const svOpenArrayHandle data,
     assert(strb_ptr);
     sim::MEM.write(addr, len, (const uint8_t *)data_ptr,
                    (const uint8_t *)strb_ptr);
+    if (sim::MEM_PROFILE.enabled()) {
+        sim::MEM_PROFILE.record_write(addr, len, (const uint8_t *)strb_ptr,
+                                      time_ps());
+    }
 }
 
 const long long clint_addr = sim::BOOTDATA.clint_base;
@@ -6,22 +6,28 @@
 #include <fesvr/context.h>
 #include <fesvr/htif.h>
 
+#include <atomic>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
 #include <memory>
 #include <set>
+#include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "ipc.hh"
 
+class Vtestharness;
+
 namespace sim {
 using namespace std::chrono_literals;
 
 // Simulation object with `fesvr` support.
 struct Sim : htif_t {
     Sim(int argc, char **argv);
+    ~Sim();
 
     virtual void start();
 
@@ -32,7 +38,7 @@ struct Sim : htif_t {
     void read_chunk(addr_t taddr, size_t len, void *dst);
     void write_chunk(addr_t taddr, size_t len, const void *src);
     bool is_address_preloaded(addr_t taddr, size_t len) override {
-        return disable_preloading;
+        return disable_preloading || is_bulk_preloaded(taddr, len);
     }
     uint32_t get_bin_entry() { return get_entry_point(); }
 
@@ -45,11 +51,46 @@ struct Sim : htif_t {
 
     void reset() {}
 
+    // Release the global memory contents of the previous binary before the
+    // next one is run on the same model (see `tb_bin.cc`). `cow` file
+    // mappings are reverted to the file contents.
+    static void reset_memory();
+
    private:
+    // Look up the `tohost` symbol of the ELF at `path` and, unless preloading
+    // is disabled, copy all its loadable segments directly into the global
+    // memory, bypassing the chunked `fesvr` loader.
+    void scan_elf(const std::string &path);
+    bool is_bulk_preloaded(addr_t taddr, size_t len) const;
+    // Map the files given with `--map-file <path>@<addr>[,ro|rw|cow]` (or
+    // `--map-file=...`) into the global memory. `rw` mappings write through
+    // to the file, `cow` (the default) mappings keep writes private, and
+    // writes to `ro` mappings are ignored.
+    void map_files(int argc, char **argv);
+    void map_file(const std::string &spec);
+
+    // Prepare the model for running this binary: register the global memory
+    // watchpoints. Verilator only.
+    void bind(Vtestharness &top);
+
     context_t *host;
     context_t target;
     bool vlt_vcd = false;
     bool disable_preloading = false;
+    // Address ranges `[base, base + size)` loaded by `scan_elf`.
+    std::vector<std::pair<addr_t, size_t>> preloaded;
+    // Address of the HTIF `tohost` word, zero if unknown.
+    addr_t htif_tohost_addr = 0;
+    // Maximum number of cycles between two HTIF services. HTIF is serviced
+    // early whenever the target writes a command to `tohost`.
+    uint64_t htif_interval = 100000;
+    // HTIF service statistics.
+    uint64_t htif_switches = 0;
+    uint64_t htif_tohost_switches = 0;
+    std::chrono::steady_clock::duration htif_host_time{0};
+    std::atomic<bool> htif_pending{false};
+    // Global memory watchpoints registered for this binary.
+    std::vector<int> watchpoints;
     IpcIface ipc;
 };
 
@@ -2,23 +2,139 @@
 // Solderpad Hardware License, Version 0.51, see LICENSE for details.
 // SPDX-License-Identifier: SHL-0.51
 
+#include <fcntl.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
 
 #include "sim.hh"
 
 extern std::unique_ptr<sim::Sim> s;
 
-int main(int argc, char **argv, char **env) {
-    // Write binary path to .rtlbinary for the `make annotate` target
+// Write binary path to .rtlbinary for the `make annotate` target
+static void write_rtlbinary(const char *path) {
     FILE *fd;
     fd = fopen(".rtlbinary", "w");
-    if (fd != NULL && argc >= 2) {
-        fprintf(fd, "%s\n", argv[1]);
+    if (fd != NULL && path != NULL) {
+        fprintf(fd, "%s\n", path);
         fclose(fd);
     } else {
         fprintf(stderr, "Warning: Failed to write binary name to .rtlbinary\n");
     }
+}
+
+// Server mode, enabled with `--server,<req>,<resp>`: after the binary given
+// on the command line, the same model runs the binaries requested on the
+// named FIFO `<req>`, one `<elf>\t<run_dir>\t<log>` line each. Every binary
+// is run from `<run_dir>` with its output redirected to `<log>`, after the
+// DUT is reset and the global memory cleared. The exit code of every binary,
+// including the first, is written to the named FIFO `<resp>` as one line.
+// The server exits when `<req>` is closed.
+static int serve(const std::string &spec, int argc, char **argv) {
+    auto comma = spec.find(',');
+    if (comma == std::string::npos) {
+        fprintf(stderr, "[TB] Invalid --server `%s`\n", spec.c_str());
+        return 1;
+    }
+    // Open in the order the client does, see `SimServer.py`.
+    FILE *req = fopen(spec.substr(0, comma).c_str(), "r");
+    FILE *resp = req ? fopen(spec.substr(comma + 1).c_str(), "w") : NULL;
+    if (!resp) {
+        fprintf(stderr, "[TB] Cannot open server FIFOs `%s`\n", spec.c_str());
+        return 1;
+    }
+
+    // The ELF is the first positional argument; the other arguments are
+    // passed on to every binary. Flags may take their value as the next
+    // argument, which is not positional.
+    static const char *VALUE_FLAGS[] = {"--map-file"};
+    std::vector<char *> args(argv, argv + argc);
+    int elf_arg = 1;
+    while (elf_arg < argc && argv[elf_arg][0] == '-') {
+        for (auto flag : VALUE_FLAGS)
+            if (strcmp(argv[elf_arg], flag) == 0) elf_arg++;
+        elf_arg++;
+    }
+    if (elf_arg >= argc) {
+        fprintf(stderr, "[TB] No binary given\n");
+        return 1;
+    }
+
+    s = std::make_unique<sim::Sim>(argc, argv);
+    fprintf(resp, "%d\n", s->run());
+    fflush(resp);
+
+    char *line = NULL;
+    size_t size = 0;
+    while (getline(&line, &size, req) > 0) {
+        std::string elf(line), run_dir, log;
+        if (!elf.empty() && elf.back() == '\n') elf.pop_back();
+        auto tab = elf.find('\t');
+        auto tab2 = tab == std::string::npos ? tab : elf.find('\t', tab + 1);
+        if (tab2 == std::string::npos) {
+            fprintf(stderr, "[TB] Invalid server request `%s`\n", elf.c_str());
+            break;
+        }
+        run_dir = elf.substr(tab + 1, tab2 - tab - 1);
+        log = elf.substr(tab2 + 1);
+        elf.resize(tab);
+
+        fflush(stdout);
+        fflush(stderr);
+        int fd = open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || chdir(run_dir.c_str()) != 0) {
+            fprintf(stderr, "[TB] Cannot run `%s` in `%s`\n", elf.c_str(),
+                    run_dir.c_str());
+            if (fd >= 0) close(fd);
+            fprintf(resp, "%d\n", -1);
+            fflush(resp);
+            continue;
+        }
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        close(fd);
+        write_rtlbinary(elf.c_str());
+
+        // Tear down the previous binary before clearing the memory it may
+        // still be watching.
+        s.reset();
+        sim::Sim::reset_memory();
+        args[elf_arg] = &elf[0];
+        s = std::make_unique<sim::Sim>(argc, args.data());
+        fprintf(resp, "%d\n", s->run());
+        fflush(resp);
+    }
+    free(line);
+    s.reset();
+    fflush(stdout);
+    return 0;
+}
+
+int main(int argc, char **argv, char **env) {
+    write_rtlbinary(argc >= 2 ? argv[1] : NULL);
+
+    static constexpr char SERVER_FLAG[10] = "--server,";
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], SERVER_FLAG, strlen(SERVER_FLAG)) != 0) continue;
+        // Per-binary IPC channels and checkpoints are not supported.
+        for (int j = 1; j < argc; j++) {
+            if (strncmp(argv[j], "--ipc", 5) == 0 ||
+                strncmp(argv[j], "--checkpoint=", 13) == 0 ||
+                strncmp(argv[j], "--restore=", 10) == 0) {
+                fprintf(stderr, "[TB] `%s` is not supported with --server\n",
+                        argv[j]);
+                return 1;
+            }
+        }
+        return serve(argv[i] + strlen(SERVER_FLAG), argc, argv);
+    }
 
     s = std::make_unique<sim::Sim>(argc, argv);
-    return s->run();
+    int exit_code = s->run();
+    // Finish the simulation while the testbench globals are still alive.
+    s.reset();
+    return exit_code;
 }
@@ -6,109 +6,481 @@
 // Author: Florian Zaruba <zarubaf@iis.ee.ethz.ch>
 
 #pragma once
-#include "sim.hh"
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
 
 namespace sim {
 
 struct GlobalMemory {
     static constexpr size_t ADDR_SHIFT = 12;
     static constexpr size_t SIZE_OF_PAGE = (size_t)1 << ADDR_SHIFT;
+    static constexpr size_t PAGE_MASK = SIZE_OF_PAGE - 1;
+
+    // The page number (the upper 52 address bits) is resolved through a
+    // radix tree with `LEVELS` levels of `LEVEL_BITS` bits each. Inner nodes
+    // and pages are allocated lazily and never freed while the memory lives,
+    // so lookups are lock-free and may race with allocations.
+    static constexpr size_t LEVEL_BITS = 13;
+    static constexpr size_t LEVELS = 4;
+    static constexpr size_t NODE_SIZE = (size_t)1 << LEVEL_BITS;
+    static constexpr uint64_t LEVEL_MASK = NODE_SIZE - 1;
+
+    struct Node {
+        std::atomic<void *> slot[NODE_SIZE];
+    };
 
-    std::unordered_map<uint64_t, std::unique_ptr<uint8_t[]>> pages;
+    // Set of page indices which have been allocated by a write.
     std::set<uint64_t> touched;
 
-    // A mapping of host memory into Manticore memory.
+    // A mapping of host memory into Manticore memory. Writes to a read-only
+    // mapping are ignored.
     struct Mapping {
         uint64_t base;  // manticore memory
         size_t size;
         uint8_t *into;  // host memory
+        bool writable;
     };
-    std::vector<Mapping> mappings;
+    // Non-overlapping mappings, indexed by base address.
+    std::map<uint64_t, Mapping> mappings;
+    // Range `[mapped_lo, mapped_hi)` spanned by all mappings. Accesses
+    // outside of it go straight to the pages without searching `mappings`.
+    uint64_t mapped_lo = UINT64_MAX;
+    uint64_t mapped_hi = 0;
 
-    uint8_t *find_mapping(uint64_t addr) const {
-        for (const auto &m : mappings) {
-            if (m.base <= addr && m.base + m.size > addr) {
-                return m.into + (addr - m.base);
-            }
-        }
-        return nullptr;
+    // A watchpoint on a 32-bit word. `notify` is called from the writing
+    // thread, with the new word value, whenever a write through this class
+    // touches the word and its masked value differs from the masked
+    // `expected` value. Writes from the host side of a mapping are not seen.
+    struct Watchpoint {
+        uint64_t addr;
+        uint32_t mask;
+        uint32_t expected;
+        std::function<void(uint32_t)> notify;
+    };
+
+    // Interval at which blocked `wait_for_change` calls re-read their word,
+    // covering writes which race with the watchpoint's registration.
+    static constexpr int WATCH_RECHECK_PERIOD_MS = 10;
+
+    GlobalMemory() : root(new Node()), id(next_id()) {}
+    ~GlobalMemory() { free_node(root, LEVELS - 1); }
+    GlobalMemory(const GlobalMemory &) = delete;
+    GlobalMemory &operator=(const GlobalMemory &) = delete;
+
+    // Add a mapping. Fails if it is empty or overlaps an existing mapping.
+    // Mappings must be added before the simulation starts.
+    bool add_mapping(const Mapping &m) {
+        if (m.size == 0 || overlaps_mapping(m.base, m.size)) return false;
+        mappings[m.base] = m;
+        mapped_lo = std::min(mapped_lo, m.base);
+        mapped_hi = std::max(mapped_hi, m.base + m.size);
+        return true;
+    }
+
+    // Return the mapping containing all of `[addr, addr + len)`, if any.
+    const Mapping *lookup_mapping(uint64_t addr, size_t len = 1) const {
+        auto it = mappings.upper_bound(addr);
+        if (it == mappings.begin()) return nullptr;
+        const Mapping &m = (--it)->second;
+        return m.base + m.size >= addr + len ? &m : nullptr;
     }
 
-    // Copy a chunk of data into memory.
+    // Return the host address backing `[addr, addr + len)` if the range lies
+    // entirely within one mapping.
+    uint8_t *find_mapping(uint64_t addr, size_t len = 1) const {
+        const Mapping *m = lookup_mapping(addr, len);
+        return m ? m->into + (addr - m->base) : nullptr;
+    }
+
+    // Whether any mapping overlaps the range `[addr, addr + len)`. As the
+    // mappings are disjoint, only the last one starting before the end of
+    // the range can.
+    bool overlaps_mapping(uint64_t addr, size_t len) const {
+        auto it = mappings.lower_bound(addr + len);
+        if (it == mappings.begin()) return false;
+        const Mapping &m = (--it)->second;
+        return m.base + m.size > addr;
+    }
+
+    // Same as `overlaps_mapping`, but only searches the mappings if the range
+    // intersects the range they span.
+    bool is_mapped(uint64_t addr, size_t len) const {
+        return addr < mapped_hi && addr + len > mapped_lo &&
+               overlaps_mapping(addr, len);
+    }
+
+    // Return the page with index `page_idx`. If the page does not exist, it
+    // is allocated (zero-filled) if `alloc` is set, else `nullptr` is
+    // returned.
+    uint8_t *get_page(uint64_t page_idx, bool alloc) {
+        // Fast path: the last page accessed by this thread.
+        PageCache &cache = page_cache();
+        if (cache.id == id && cache.page_idx == page_idx) return cache.page;
+        uint8_t *page = walk(page_idx, alloc);
+        if (page) cache = {id, page_idx, page};
+        return page;
+    }
+
+    // Copy a chunk of data into memory. Bytes whose strobe is zero are left
+    // untouched; a null `strb` enables all bytes.
     void write(size_t addr, size_t len, const uint8_t *data,
                const uint8_t *strb) {
-        // std::cout << "[GlobalMemory] Write " << std::hex << addr << std::dec
-        //           << " (" << len << " bytes)\n";
-        size_t end = addr + len;
-        size_t data_idx = 0;
-        while (addr < end) {
-            size_t byte_start = addr;
-            addr >>= ADDR_SHIFT;
-            auto &page = pages[addr];
-            uint64_t page_idx = addr;
-            if (!page) {
-                // std::cout << "[TB] Allocate page " << std::hex << (addr <<
-                // ADDR_SHIFT) << "\n";
-                page = std::make_unique<uint8_t[]>(SIZE_OF_PAGE);
-                std::fill(&page[0], &page[SIZE_OF_PAGE], 0);
+        size_t start = addr, end = addr + len;
+        while (len > 0) {
+            size_t offset = addr & PAGE_MASK;
+            size_t chunk = std::min(len, SIZE_OF_PAGE - offset);
+            if (is_mapped(addr, chunk)) {
+                const Mapping *m = lookup_mapping(addr, chunk);
+                if (m) {
+                    if (m->writable) {
+                        write_strobed(m->into + (addr - m->base), data, strb,
+                                      chunk);
+                    }
+                } else {
+                    write_mapped(addr, chunk, data, strb);
+                }
+            } else {
+                uint8_t *page = get_page(addr >> ADDR_SHIFT, true);
+                write_strobed(page + offset, data, strb, chunk);
             }
-            // std::cout << "[TB] Write to page " << std::hex << (addr <<
-            // ADDR_SHIFT)
-            // << "\n";
-            addr += 1;
-            addr <<= ADDR_SHIFT;
-            size_t byte_end = std::min(addr, end);
-            bool any_changed = false;
-            for (size_t i = byte_start; i < byte_end; i++, data_idx++) {
-                if (!strb || strb[data_idx]) {
-                    // std::cout << "[TB] Write byte " << std::hex << i << " = "
-                    // << (uint32_t)data[data_idx] << "\n";
-                    auto host = find_mapping(i);
-                    if (host) {
-                        *host = data[data_idx];
-                    } else {
-                        page[i % SIZE_OF_PAGE] = data[data_idx];
-                        any_changed = true;
+            addr += chunk;
+            data += chunk;
+            if (strb) strb += chunk;
+            len -= chunk;
+        }
+        if (is_watched(start, end)) check_watchpoints(start, end);
+    }
+
+    // Zero a range of memory. Pages which were never written already read as
+    // zero and are not allocated.
+    void clear(size_t addr, size_t len) {
+        size_t start = addr, end = addr + len;
+        while (len > 0) {
+            size_t offset = addr & PAGE_MASK;
+            size_t chunk = std::min(len, SIZE_OF_PAGE - offset);
+            if (is_mapped(addr, chunk)) {
+                const Mapping *m = lookup_mapping(addr, chunk);
+                if (m) {
+                    if (m->writable) {
+                        memset(m->into + (addr - m->base), 0, chunk);
+                    }
+                } else {
+                    for (size_t i = 0; i < chunk; i++) {
+                        const uint8_t zero = 0;
+                        write_mapped(addr + i, 1, &zero, nullptr);
                     }
                 }
+            } else {
+                uint8_t *page = get_page(addr >> ADDR_SHIFT, false);
+                if (page) memset(page + offset, 0, chunk);
             }
-            if (any_changed) touched.insert(page_idx);
+            addr += chunk;
+            len -= chunk;
         }
-        std::cout << std::dec;
+        if (is_watched(start, end)) check_watchpoints(start, end);
     }
 
     // Copy a chunk of data out of the memory.
     void read(size_t addr, size_t len, uint8_t *data) {
-        // std::cout << "[GlobalMemory] Read " << std::hex << addr << std::dec
-        //           << " (" << len << " bytes)\n";
-        size_t end = addr + len;
-        size_t data_idx = 0;
-        while (addr < end) {
-            size_t byte_start = addr;
-            addr >>= ADDR_SHIFT;
-            auto &page = pages[addr];
-            // std::cout << "[TB] Read from page " << std::hex << (addr <<
-            // ADDR_SHIFT)
-            // << "\n";
-            addr += 1;
-            addr <<= ADDR_SHIFT;
-            size_t byte_end = std::min(addr, end);
-            for (size_t i = byte_start; i < byte_end; i++, data_idx++) {
-                auto host = find_mapping(i);
+        while (len > 0) {
+            size_t offset = addr & PAGE_MASK;
+            size_t chunk = std::min(len, SIZE_OF_PAGE - offset);
+            if (is_mapped(addr, chunk)) {
+                const uint8_t *host = find_mapping(addr, chunk);
                 if (host) {
-                    data[data_idx] = *host;
+                    copy_words(data, host, chunk);
                 } else {
-                    if (page) {
-                        // std::cout << "[TB] Read byte " << std::hex << i <<
-                        // "\n";
-                        data[data_idx] = page[i % SIZE_OF_PAGE];
-                    } else {
-                        data[data_idx] = 0;
-                    }
+                    read_mapped(addr, chunk, data);
+                }
+            } else {
+                const uint8_t *page = get_page(addr >> ADDR_SHIFT, false);
+                if (page) {
+                    copy_words(data, page + offset, chunk);
+                } else {
+                    memset(data, 0, chunk);
                 }
             }
+            addr += chunk;
+            data += chunk;
+            len -= chunk;
+        }
+    }
+
+    // Release all pages, such that the whole memory reads as zero again, and
+    // invalidate the per-thread page caches. Mappings are kept. No other
+    // thread may access the memory concurrently.
+    void reset() {
+        std::lock_guard<std::mutex> lock(alloc_mutex);
+        free_node(root, LEVELS - 1);
+        root = new Node();
+        touched.clear();
+        id = next_id();
+    }
+
+    // Register a watchpoint and return a handle to remove it with.
+    int add_watchpoint(uint64_t addr, uint32_t mask, uint32_t expected,
+                       std::function<void(uint32_t)> notify) {
+        std::lock_guard<std::mutex> lock(watch_mutex);
+        int handle = next_watch++;
+        watchpoints[handle] = {addr, mask, expected, std::move(notify)};
+        update_watch_range();
+        return handle;
+    }
+
+    void remove_watchpoint(int handle) {
+        std::lock_guard<std::mutex> lock(watch_mutex);
+        watchpoints.erase(handle);
+        update_watch_range();
+    }
+
+    // Block until the masked 32-bit word at `addr` differs from the masked
+    // `expected` value, and return the word. The caller sleeps until a
+    // write to the word wakes it up.
+    uint32_t wait_for_change(uint64_t addr, uint32_t mask, uint32_t expected) {
+        std::mutex m;
+        std::condition_variable cv;
+        bool done = false;
+        uint32_t value;
+        int handle =
+            add_watchpoint(addr, mask, expected, [&](uint32_t new_value) {
+                std::lock_guard<std::mutex> lock(m);
+                done = true;
+                value = new_value;
+                cv.notify_one();
+            });
+        std::unique_lock<std::mutex> lock(m);
+        while (!done) {
+            uint32_t current;
+            read(addr, sizeof(current), (uint8_t *)&current);
+            if ((current & mask) != (expected & mask)) {
+                value = current;
+                break;
+            }
+            cv.wait_for(lock,
+                        std::chrono::milliseconds(WATCH_RECHECK_PERIOD_MS));
+        }
+        lock.unlock();
+        remove_watchpoint(handle);
+        return value;
+    }
+
+   private:
+    // Per-thread cache of the last page looked up. Entries are tagged with
+    // the unique ID of the owning memory, so that they never alias across
+    // instances.
+    struct PageCache {
+        uint64_t id;
+        uint64_t page_idx;
+        uint8_t *page;
+    };
+
+    Node *root;
+    uint64_t id;
+    std::mutex alloc_mutex;
+
+    // Registered watchpoints. The watched words, merged into at most
+    // `MAX_WATCH_RANGES` sorted ranges `[watch_lo[i], watch_hi[i])`, are
+    // published for writes to skip the watchpoint check without taking the
+    // lock. If there are more ranges, the last one extends to cover them.
+    static constexpr size_t MAX_WATCH_RANGES = 8;
+    std::mutex watch_mutex;
+    std::map<int, Watchpoint> watchpoints;
+    int next_watch = 0;
+    std::atomic<int> num_watch_ranges{0};
+    std::atomic<uint64_t> watch_lo[MAX_WATCH_RANGES];
+    std::atomic<uint64_t> watch_hi[MAX_WATCH_RANGES];
+
+    bool is_watched(uint64_t start, uint64_t end) const {
+        int n = num_watch_ranges.load(std::memory_order_acquire);
+        for (int i = 0; i < n; i++) {
+            if (start < watch_hi[i].load(std::memory_order_relaxed) &&
+                end > watch_lo[i].load(std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Must be called with `watch_mutex` held.
+    void update_watch_range() {
+        std::set<uint64_t> words;
+        for (const auto &w : watchpoints) words.insert(w.second.addr);
+        std::vector<std::pair<uint64_t, uint64_t>> ranges;
+        for (uint64_t addr : words) {
+            uint64_t hi = addr + sizeof(uint32_t);
+            if (!ranges.empty() && (addr <= ranges.back().second ||
+                                    ranges.size() == MAX_WATCH_RANGES)) {
+                ranges.back().second = std::max(ranges.back().second, hi);
+            } else {
+                ranges.emplace_back(addr, hi);
+            }
+        }
+        for (size_t i = 0; i < ranges.size(); i++) {
+            watch_lo[i].store(ranges[i].first, std::memory_order_relaxed);
+            watch_hi[i].store(ranges[i].second, std::memory_order_relaxed);
+        }
+        num_watch_ranges.store(ranges.size(), std::memory_order_release);
+    }
+
+    void check_watchpoints(uint64_t start, uint64_t end) {
+        std::lock_guard<std::mutex> lock(watch_mutex);
+        for (const auto &w : watchpoints) {
+            const Watchpoint &wp = w.second;
+            if (start >= wp.addr + sizeof(uint32_t) || end <= wp.addr) {
+                continue;
+            }
+            uint32_t value;
+            read(wp.addr, sizeof(value), (uint8_t *)&value);
+            if ((value & wp.mask) != (wp.expected & wp.mask)) wp.notify(value);
+        }
+    }
+
+    static uint64_t next_id() {
+        static std::atomic<uint64_t> counter(1);
+        return counter++;
+    }
+
+    static PageCache &page_cache() {
+        static thread_local PageCache cache = {0, 0, nullptr};
+        return cache;
+    }
+
+    // Atomically install `fresh` into an empty slot. If another thread won
+    // the race, its object is returned and ours is released.
+    static void *install(std::atomic<void *> &slot, Node *fresh) {
+        void *expected = nullptr;
+        if (slot.compare_exchange_strong(expected, fresh,
+                                         std::memory_order_acq_rel)) {
+            return fresh;
+        }
+        delete fresh;
+        return expected;
+    }
+
+    uint8_t *walk(uint64_t page_idx, bool alloc) {
+        Node *node = root;
+        for (size_t level = LEVELS - 1; level > 0; level--) {
+            auto &slot =
+                node->slot[(page_idx >> (level * LEVEL_BITS)) & LEVEL_MASK];
+            void *next = slot.load(std::memory_order_acquire);
+            if (!next) {
+                if (!alloc) return nullptr;
+                next = install(slot, new Node());
+            }
+            node = static_cast<Node *>(next);
+        }
+        auto &slot = node->slot[page_idx & LEVEL_MASK];
+        void *page = slot.load(std::memory_order_acquire);
+        if (!page && alloc) {
+            auto fresh = new uint8_t[SIZE_OF_PAGE]();
+            void *expected = nullptr;
+            if (slot.compare_exchange_strong(expected, fresh,
+                                             std::memory_order_acq_rel)) {
+                page = fresh;
+                std::lock_guard<std::mutex> lock(alloc_mutex);
+                touched.insert(page_idx);
+            } else {
+                delete[] fresh;
+                page = expected;
+            }
+        }
+        return static_cast<uint8_t *>(page);
+    }
+
+    static void free_node(Node *node, size_t level) {
+        for (size_t i = 0; i < NODE_SIZE; i++) {
+            void *child = node->slot[i].load(std::memory_order_relaxed);
+            if (!child) continue;
+            if (level > 0) {
+                free_node(static_cast<Node *>(child), level - 1);
+            } else {
+                delete[] static_cast<uint8_t *>(child);
+            }
+        }
+        delete node;
+    }
+
+    // Copy `len` bytes. Bus-sized accesses are copied as 64-bit words, since
+    // a variable-length `memcpy` has a large fixed cost for such short
+    // transfers.
+    static void copy_words(uint8_t *dst, const uint8_t *src, size_t len) {
+        if (len > 64) {
+            memcpy(dst, src, len);
+            return;
+        }
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+            memcpy(dst + i, src + i, sizeof(uint64_t));
+        }
+        for (; i < len; i++) dst[i] = src[i];
+    }
+
+    // Copy `len` bytes under strobe. Strobes are processed eight at a time,
+    // such that fully enabled or fully disabled words need no byte loop.
+    static void write_strobed(uint8_t *dst, const uint8_t *src,
+                              const uint8_t *strb, size_t len) {
+        if (!strb) {
+            copy_words(dst, src, len);
+            return;
+        }
+        constexpr uint64_t LSBS = 0x0101010101010101ull;
+        constexpr uint64_t MSBS = 0x8080808080808080ull;
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+            uint64_t s;
+            memcpy(&s, strb + i, sizeof(s));
+            if (s == 0) continue;
+            // No strobe byte is zero: the whole word is enabled.
+            if (((s - LSBS) & ~s & MSBS) == 0) {
+                memcpy(dst + i, src + i, sizeof(uint64_t));
+                continue;
+            }
+            for (size_t j = i; j < i + sizeof(uint64_t); j++) {
+                if (strb[j]) dst[j] = src[j];
+            }
+        }
+        for (; i < len; i++) {
+            if (strb[i]) dst[i] = src[i];
+        }
+    }
+
+    // Byte-wise fallbacks for ranges which straddle a mapping boundary.
+    void write_mapped(size_t addr, size_t len, const uint8_t *data,
+                      const uint8_t *strb) {
+        uint8_t *page = nullptr;
+        for (size_t i = 0; i < len; i++) {
+            if (strb && !strb[i]) continue;
+            const Mapping *m = lookup_mapping(addr + i);
+            if (m) {
+                if (m->writable) m->into[addr + i - m->base] = data[i];
+            } else {
+                if (!page) page = get_page((addr + i) >> ADDR_SHIFT, true);
+                page[(addr + i) & PAGE_MASK] = data[i];
+            }
+        }
+    }
+
+    void read_mapped(size_t addr, size_t len, uint8_t *data) {
+        const uint8_t *page = get_page(addr >> ADDR_SHIFT, false);
+        for (size_t i = 0; i < len; i++) {
+            auto host = find_mapping(addr + i);
+            if (host) {
+                data[i] = *host;
+            } else {
+                data[i] = page ? page[(addr + i) & PAGE_MASK] : 0;
+            }
         }
-        std::cout << std::dec;
     }
 };
 
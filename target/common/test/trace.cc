@@ -0,0 +1,222 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+
+// Binary instruction tracer. The core tracers call into this file through DPI
+// when the RTL is compiled with `SNITCH_BINARY_TRACE`. Records are appended
+// to a per-hart block buffer on the simulation thread; full blocks are handed
+// to a background thread, which compresses them and writes them to disk, so
+// that neither string formatting nor file I/O is on the simulation path.
+
+#include "trace.hh"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <svdpi.h>
+#include <zlib.h>
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sim {
+namespace trace {
+
+// Uncompressed size of a block. Large enough to amortize the compression
+// call, small enough to keep the memory footprint low with many harts.
+static const size_t BLOCK_SIZE = 1 << 20;
+// Maximum number of blocks waiting for compression before the simulation
+// thread is stalled.
+static const size_t MAX_PENDING_BLOCKS = 64;
+// zlib level 1 compresses traces by ~10x at several hundred MB/s.
+static const int COMPRESSION_LEVEL = 1;
+
+struct HartTrace {
+    FILE *file;
+    std::vector<uint8_t> block;
+};
+
+class Compressor {
+   public:
+    Compressor() : worker(&Compressor::run, this) {}
+
+    ~Compressor() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        not_empty.notify_all();
+        worker.join();
+    }
+
+    // Queue the block of `hart` for compression and leave an empty block in
+    // its place.
+    void push(HartTrace *hart) {
+        std::vector<uint8_t> block;
+        block.reserve(BLOCK_SIZE);
+        std::swap(block, hart->block);
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock,
+                      [this] { return pending.size() < MAX_PENDING_BLOCKS; });
+        pending.emplace_back(hart->file, std::move(block));
+        lock.unlock();
+        not_empty.notify_one();
+    }
+
+    // Block until all queued blocks have been written.
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        drained.wait(lock, [this] { return pending.empty() && !busy; });
+    }
+
+   private:
+    void run() {
+        std::vector<uint8_t> out;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            not_empty.wait(lock, [this] { return stop || !pending.empty(); });
+            if (pending.empty()) break;
+            auto item = std::move(pending.front());
+            pending.pop_front();
+            busy = true;
+            lock.unlock();
+            not_full.notify_one();
+            write_block(item.first, item.second, out);
+            lock.lock();
+            busy = false;
+            if (pending.empty()) drained.notify_all();
+        }
+    }
+
+    static void write_block(FILE *file, const std::vector<uint8_t> &raw,
+                            std::vector<uint8_t> &out) {
+        uLongf size = compressBound(raw.size());
+        out.resize(size);
+        BlockHeader hdr;
+        hdr.raw_size = raw.size();
+        if (compress2(out.data(), &size, raw.data(), raw.size(),
+                      COMPRESSION_LEVEL) == Z_OK &&
+            size < raw.size()) {
+            hdr.size = size;
+            fwrite(&hdr, sizeof(hdr), 1, file);
+            fwrite(out.data(), size, 1, file);
+        } else {
+            hdr.size = raw.size();
+            fwrite(&hdr, sizeof(hdr), 1, file);
+            fwrite(raw.data(), raw.size(), 1, file);
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::condition_variable drained;
+    std::deque<std::pair<FILE *, std::vector<uint8_t>>> pending;
+    bool busy = false;
+    bool stop = false;
+    std::thread worker;
+};
+
+static std::map<int, std::unique_ptr<HartTrace>> harts;
+static std::unique_ptr<Compressor> compressor;
+
+static void append(int hart_id, Kind kind, long long time, long long cycle,
+                   int priv, uint32_t pc, uint64_t insn,
+                   const svBitVecVal *extras, unsigned num_fields) {
+    auto it = harts.find(hart_id);
+    if (it == harts.end()) return;
+    HartTrace *hart = it->second.get();
+
+    RecordHeader rec;
+    rec.kind = kind;
+    rec.priv = priv;
+    rec.num_fields = num_fields;
+    rec.pc = pc;
+    rec.time = time;
+    rec.cycle = cycle;
+    rec.insn = insn;
+
+    size_t offset = hart->block.size();
+    hart->block.resize(offset + sizeof(rec) + num_fields * sizeof(uint64_t));
+    uint8_t *dst = hart->block.data() + offset;
+    memcpy(dst, &rec, sizeof(rec));
+    dst += sizeof(rec);
+    // Packed structs are passed with the first declared field in the most
+    // significant bits; emit the fields in declaration order.
+    for (unsigned i = 0; i < num_fields; i++) {
+        unsigned word = 2 * (num_fields - 1 - i);
+        uint64_t field = (uint64_t)extras[word + 1] << 32 | extras[word];
+        memcpy(dst, &field, sizeof(field));
+        dst += sizeof(field);
+    }
+
+    if (hart->block.size() >= BLOCK_SIZE) compressor->push(hart);
+}
+
+}  // namespace trace
+}  // namespace sim
+
+using namespace sim::trace;
+
+// Number of 64-bit fields in the `snitch_pkg` trace port structs.
+static const unsigned SNITCH_TRACE_FIELDS = 29;
+static const unsigned FPU_TRACE_FIELDS = 34;
+static const unsigned FPU_SEQ_TRACE_FIELDS = 6;
+
+extern "C" {
+
+void snitch_trace_open(int hart_id, long long time_scale) {
+    if (!compressor) compressor.reset(new Compressor());
+    char fn[64];
+    snprintf(fn, sizeof(fn), "logs/trace_hart_%05x.bin", hart_id);
+    FILE *file = fopen(fn, "wb");
+    if (!file) {
+        fprintf(stderr, "[Tracer] Cannot open %s\n", fn);
+        return;
+    }
+    FileHeader hdr;
+    memcpy(hdr.magic, MAGIC, sizeof(MAGIC));
+    hdr.version = VERSION;
+    hdr.hart_id = hart_id;
+    hdr.time_scale = time_scale;
+    fwrite(&hdr, sizeof(hdr), 1, file);
+    auto hart = std::unique_ptr<HartTrace>(new HartTrace{file, {}});
+    hart->block.reserve(BLOCK_SIZE);
+    harts[hart_id] = std::move(hart);
+}
+
+void snitch_trace_snitch(int hart_id, long long time, long long cycle,
+                         int priv, int pc, int insn,
+                         const svBitVecVal *extras) {
+    append(hart_id, Snitch, time, cycle, priv, pc, (uint32_t)insn, extras,
+           SNITCH_TRACE_FIELDS);
+}
+
+void snitch_trace_fpu(int hart_id, long long time, long long cycle, int priv,
+                      long long insn, const svBitVecVal *extras) {
+    append(hart_id, Fpu, time, cycle, priv, 0, insn, extras,
+           FPU_TRACE_FIELDS);
+}
+
+void snitch_trace_fpu_seq(int hart_id, long long time, long long cycle,
+                          int priv, const svBitVecVal *extras) {
+    append(hart_id, FpuSeq, time, cycle, priv, 0, 0, extras,
+           FPU_SEQ_TRACE_FIELDS);
+}
+
+void snitch_trace_close(int hart_id) {
+    auto it = harts.find(hart_id);
+    if (it == harts.end()) return;
+    HartTrace *hart = it->second.get();
+    if (!hart->block.empty()) compressor->push(hart);
+    compressor->flush();
+    fclose(hart->file);
+    harts.erase(it);
+    if (harts.empty()) compressor.reset();
+}
+}
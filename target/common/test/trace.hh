@@ -0,0 +1,61 @@
+// Copyright 2024 ETH Zurich and University of Bologna.
+// Solderpad Hardware License, Version 0.51, see LICENSE for details.
+// SPDX-License-Identifier: SHL-0.51
+
+// Binary instruction trace format, written by `trace.cc` when the RTL is
+// compiled with `SNITCH_BINARY_TRACE` and read by `util/trace/bintrace.py`.
+//
+// A trace file starts with a `FileHeader`, followed by a sequence of blocks.
+// Each block consists of a `BlockHeader` and `size` bytes of payload, which
+// is zlib-compressed unless `size == raw_size`. The uncompressed payload is a
+// sequence of records, each a `RecordHeader` followed by `num_fields` 64-bit
+// values: the fields of the respective trace port struct in `snitch_pkg`, in
+// declaration order. All values are little endian.
+
+#pragma once
+
+#include <stdint.h>
+
+namespace sim {
+namespace trace {
+
+static const char MAGIC[8] = {'S', 'N', 'T', 'R', 'A', 'C', 'E', '\0'};
+static const uint32_t VERSION = 1;
+
+// Trace sources, matching `snitch_pkg::trace_src_e`.
+enum Kind : uint8_t {
+    Snitch = 0,
+    Fpu = 1,
+    FpuSeq = 2,
+};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t hart_id;
+    // Factor converting the recorded times to the `%t` representation of
+    // the textual traces (i.e. simulator precision).
+    uint64_t time_scale;
+};
+
+struct BlockHeader {
+    uint32_t raw_size;
+    uint32_t size;
+};
+
+struct RecordHeader {
+    uint8_t kind;
+    uint8_t priv;
+    uint16_t num_fields;
+    uint32_t pc;
+    uint64_t time;
+    uint64_t cycle;
+    uint64_t insn;
+};
+
+static_assert(sizeof(FileHeader) == 24, "Unexpected FileHeader padding");
+static_assert(sizeof(BlockHeader) == 8, "Unexpected BlockHeader padding");
+static_assert(sizeof(RecordHeader) == 32, "Unexpected RecordHeader padding");
+
+}  // namespace trace
+}  // namespace sim
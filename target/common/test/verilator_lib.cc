@@ -6,6 +6,7 @@
 
 #include "Vtestharness.h"
 #include "Vtestharness__Dpi.h"
+#include "mem_profile.hh"
 #include "sim.hh"
 #include "tb_lib.hh"
 #include "verilated.h"
@@ -15,8 +16,8 @@ std::unique_ptr<sim::Sim> s;
 
 namespace sim {
 
-// Number of cycles between HTIF checks.
-const int HTIFTimeInterval = 200;
+// Number of sim::TIME increments per clock cycle.
+const int TIME_PER_CYCLE = 2;
 
 // We want to return timestamp in picosecond accuracy, assuming that one cycle
 // takes 1ns Since 1 cycle takes 2 sim::TIME increments, scale by 500 to get
@@ -27,24 +28,53 @@ void sim_thread_main(void *arg) { ((Sim *)arg)->main(); }
 // Sim time.
 vluint64_t TIME = 0;
 
+// The Verilated model and the simulation thread evaluating it live for the
+// whole process. In server mode (see `tb_bin.cc`), one `Sim` is created per
+// binary, and the simulation thread binds to the `Sim` of the binary
+// currently run, `active`, whenever `generation` changes.
+static context_t sim_thread;
+static bool sim_thread_started = false;
+static Sim *active = nullptr;
+static uint64_t generation = 0;
+
 Sim::Sim(int argc, char **argv) : htif_t(argc, argv), ipc(argc, argv) {
+    static constexpr char HTIF_INTERVAL_FLAG[17] = "--htif_interval=";
     // Search arguments for `--vcd` flag and enable waves if requested
     for (auto i = 1; i < argc; ++i) {
         if (strcmp(argv[i], "--vcd") == 0) {
             printf("VCD wave generation enabled\n");
             vlt_vcd = true;
+        } else if (strncmp(argv[i], HTIF_INTERVAL_FLAG,
+                           strlen(HTIF_INTERVAL_FLAG)) == 0) {
+            htif_interval = std::max(
+                1ul, strtoul(argv[i] + strlen(HTIF_INTERVAL_FLAG), NULL, 0));
+            printf("HTIF fallback interval set to %lu cycles\n",
+                   htif_interval);
         }
     }
+    map_files(argc, argv);
+    MEM_PROFILE.configure(argc, argv);
     Verilated::commandArgs(argc, argv);
 }
 
-void Sim::idle() { target.switch_to(); }
+void Sim::idle() { sim_thread.switch_to(); }
 
 /// Execute the simulation.
 int Sim::run() {
     host = context_t::current();
-    target.init(sim_thread_main, this);
-    return htif_t::run();
+    active = this;
+    generation++;
+    if (!sim_thread_started) {
+        sim_thread.init(sim_thread_main, this);
+        sim_thread_started = true;
+    }
+    int exit_code = htif_t::run();
+    printf(
+        "[TB] HTIF serviced %lu times (%lu on tohost writes), %.3f s spent on "
+        "host side\n",
+        htif_switches, htif_tohost_switches,
+        std::chrono::duration<double>(htif_host_time).count());
+    return exit_code;
 }
 
 void Sim::main() {
@@ -54,34 +84,79 @@ void Sim::main() {
     auto top = std::make_unique<Vtestharness>();
     auto vcd = std::make_unique<VerilatedVcdC>();
 
-    // Trace 8 levels of hierarchy.
-    if (vlt_vcd) {
+    // Trace 8 levels of hierarchy. Waves are configured by the first binary.
+    bool dump_vcd = vlt_vcd;
+    if (dump_vcd) {
         top->trace(vcd.get(), 8);
         vcd->open("sim.vcd");
         vcd->dump(TIME);
     }
     TIME += 2;
 
+    // Per-binary state, set up when binding to a new `Sim`.
+    uint64_t bound = 0;
+    Sim *sim = nullptr;
+    vluint64_t next_htif = 0;
+
     while (!Verilated::gotFinish()) {
+        if (bound != generation) {
+            // Reset the DUT to boot the next binary; the global memory has
+            // already been reset by the server.
+            top->restart_i = bound != 0;
+            bound = generation;
+            sim = active;
+            sim->bind(*top);
+            next_htif = TIME + sim->htif_interval * TIME_PER_CYCLE;
+        }
         // Evaluate the DUT.
         top->eval();
-        if (vlt_vcd) vcd->dump(TIME);
+        top->restart_i = 0;
+        if (dump_vcd) vcd->dump(TIME);
         // Increase global time.
         TIME++;
-        // Switch to the HTIF interface in regular intervals.
-        if (TIME % HTIFTimeInterval == 0) {
-            host->switch_to();
+        // Switch to the HTIF interface on `tohost` writes, and at least in
+        // regular intervals.
+        bool on_tohost = sim->htif_pending.load(std::memory_order_relaxed);
+        if (on_tohost || TIME >= next_htif) {
+            sim->htif_pending = false;
+            sim->htif_switches++;
+            if (on_tohost) sim->htif_tohost_switches++;
+            auto start = std::chrono::steady_clock::now();
+            sim->host->switch_to();
+            // The host may have moved on to the next binary, in which case
+            // `sim` is gone and the statistics go to the next `Sim`.
+            if (bound == generation) {
+                sim->htif_host_time += std::chrono::steady_clock::now() - start;
+                next_htif = TIME + sim->htif_interval * TIME_PER_CYCLE;
+            }
         }
     }
 
     // Clean up.
-    if (vlt_vcd) vcd->close();
+    if (dump_vcd) vcd->close();
+}
+
+void Sim::bind(Vtestharness &top) {
+    // Switch to the HTIF interface as soon as the target posts a command,
+    // i.e. writes a non-zero value to either word of `tohost`.
+    if (htif_tohost_addr) {
+        for (addr_t word = 0; word < 2; word++) {
+            watchpoints.push_back(MEM.add_watchpoint(
+                htif_tohost_addr + word * sizeof(uint32_t), 0xFFFFFFFF, 0,
+                [this](uint32_t) { htif_pending = true; }));
+        }
+    }
 }
 }  // namespace sim
 
 // Verilator callback to get the current time.
 double sc_time_stamp() { return sim::TIME * sim::TIME_CYCLES_TO_TIMESTAMP; }
 
+// Current simulation time in ps, as reported by `sc_time_stamp`.
+static uint64_t time_ps() {
+    return sim::TIME * sim::TIME_CYCLES_TO_TIMESTAMP;
+}
+
 // DPI calls.
 void tb_memory_read(long long addr, int len, const svOpenArrayHandle data) {
     // std::cout << "[TB] Read " << std::hex << addr << std::dec << " (" << len
@@ -89,6 +164,9 @@ void tb_memory_read(long long addr, int len, const svOpenArrayHandle data) {
     void *data_ptr = svGetArrayPtr(data);
     assert(data_ptr);
     sim::MEM.read(addr, len, (uint8_t *)data_ptr);
+    if (sim::MEM_PROFILE.enabled()) {
+        sim::MEM_PROFILE.record(false, addr, len, time_ps());
+    }
 }
 
 void tb_memory_write(long long addr, int len, const svOpenArrayHandle data,
@@ -101,6 +179,10 @@ void tb_memory_write(long long addr, int len, const svOpenArrayHandle data,
     assert(strb_ptr);
     sim::MEM.write(addr, len, (const uint8_t *)data_ptr,
                    (const uint8_t *)strb_ptr);
+    if (sim::MEM_PROFILE.enabled()) {
+        sim::MEM_PROFILE.record_write(addr, len, (const uint8_t *)strb_ptr,
+                                      time_ps());
+    }
 }
 
 const long long clint_addr = sim::BOOTDATA.clint_base;
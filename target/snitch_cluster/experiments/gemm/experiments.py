@@ -0,0 +1,223 @@
+#!/usr/bin/env python3
+# Copyright 2025 ETH Zurich and University of Bologna.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+"""Compare the cluster grid shapes of a multi-cluster GEMM.
+
+Every problem shape is run on each of the cluster grids listed in the
+testlist, and the runtime is compared against the single-cluster
+(1x1x1) grid of the same shape.
+
+If the testlist runs some experiments with multicast operand loads,
+these are instead compared against the same experiments without
+multicast, in terms of runtime and of the bandwidth drawn from memory
+for the A and B operands.
+
+If the testlist lets the planner choose some of the tilings (tiles of
+zero), these are instead compared against the tilings chosen by hand
+for the same shape and grid, in terms of runtime and of FPU
+utilization.
+"""
+
+import matplotlib.pyplot as plt
+import numpy as np
+from mako.template import Template
+from pathlib import Path
+from snitch.target.experiment_utils import ExperimentManager
+
+# Files
+DATA_DIR = Path('data').absolute()
+RESULT_DIR = Path('results')
+
+BASELINE_GRID = '1x1x1'
+
+# System and precision the testlists are written for, see cfg.json.tpl
+NUM_CLUSTERS = 4
+NUM_CORES = 8
+PREC = 8
+
+
+class GemmExperimentManager(ExperimentManager):
+
+    def derive_axes(self, experiment):
+        return {
+            'shape': experiment['shape'],
+            'grid': 'x'.join(str(dim) for dim in experiment['grid']),
+            'multicast': experiment.get('multicast', False),
+            'tiling': get_tiling(experiment),
+        }
+
+    def derive_data_cfg(self, experiment):
+        # Create parent directory for configuration file
+        cfg_path = DATA_DIR / experiment['name'] / 'cfg.json'
+        cfg_path.parent.mkdir(parents=True, exist_ok=True)
+
+        # Fill in configuration template and write configuration file
+        with open('cfg.json.tpl') as f:
+            cfg = Template(f.read()).render(experiment=experiment)
+        with open(cfg_path, 'w') as f:
+            f.write(cfg)
+        return cfg_path
+
+
+def get_tiling(experiment):
+    tiles = experiment['tiles']
+    if not any(tiles):
+        return 'auto'
+    return 'x'.join(str(dim) for dim in tiles)
+
+
+def get_runtime(row):
+    # From the start of the first tile computation, i.e. the first region
+    # delimited by the GEMM kernels, to the end of the last core
+    data = row['results'].performance_data
+    harts = [regions for thread, regions in data.items() if thread.startswith('hart_')]
+    start = min(regions[1]['tstart'] for regions in harts if len(regions) > 2)
+    end = max(regions[-1]['tend'] for regions in harts)
+    return end - start
+
+
+def get_operand_traffic(experiment):
+    # Bytes of A and B read from memory. Without multicast, every cluster
+    # along the N (resp. M) dimension of the grid reads its own copy of the
+    # A (resp. B) tiles. Every replica of the grid reads the whole problem.
+    m, n, k = experiment['m'], experiment['n'], experiment['k']
+    grid_m, grid_n, grid_k = experiment['grid']
+    replicas = NUM_CLUSTERS // (grid_m * grid_n * grid_k)
+    if experiment.get('multicast', False):
+        a_copies, b_copies = 1, 1
+    else:
+        a_copies, b_copies = grid_n, grid_m
+    return replicas * PREC * k * (m * a_copies + n * b_copies)
+
+
+def get_fpu_util(experiment, runtime):
+    # Fraction of the cycles in which the FPUs of the clusters in the grid
+    # issue a multiply-accumulate. Every FP64 FPU issues one per cycle.
+    m, n, k = experiment['m'], experiment['n'], experiment['k']
+    num_clusters = np.prod(experiment['grid'])
+    return m * n * k / (num_clusters * NUM_CORES * runtime)
+
+
+def get_speedup(df, row):
+    baseline = df[(df['shape'] == row['shape']) & (df['grid'] == BASELINE_GRID)]
+    return baseline['runtime'].item() / row['runtime']
+
+
+def get_multicast_speedup(df, row):
+    baseline = df[(df['shape'] == row['shape']) & (df['grid'] == row['grid']) &
+                  ~df['multicast']]
+    return baseline['runtime'].item() / row['runtime']
+
+
+def get_planner_speedup(df, row):
+    baseline = df[(df['shape'] == row['shape']) & (df['grid'] == row['grid']) &
+                  (df['tiling'] != 'auto')]
+    return baseline['runtime'].item() / row['runtime']
+
+
+def plot(df):
+    shapes = df['shape'].unique().tolist()
+    fig, ax = plt.subplots(1, len(shapes), sharey=True, squeeze=False)
+    for i, shape in enumerate(shapes):
+        shape_df = df[df['shape'] == shape]
+        ind = np.arange(len(shape_df))
+        bars = ax[0][i].bar(ind, shape_df['speedup'])
+        ax[0][i].bar_label(bars, fmt='{:.2f}')
+        ax[0][i].set_xticks(ind, shape_df['grid'], rotation=90)
+        ax[0][i].set_title(shape)
+    ax[0][0].set_ylabel('Speedup')
+
+    file = RESULT_DIR / 'grid.pdf'
+    file.parent.mkdir(parents=True, exist_ok=True)
+    plt.tight_layout()
+    plt.savefig(file)
+
+
+def plot_multicast(df):
+    configs = df[['shape', 'grid']].drop_duplicates()
+    labels = [f'{shape}\n{grid}' for shape, grid in configs.itertuples(index=False)]
+    ind = np.arange(len(configs))
+    width = 0.4
+    fig, ax = plt.subplots(1, 2, figsize=(10, 4))
+    for i, multicast in enumerate([False, True]):
+        mdf = df[df['multicast'] == multicast]
+        label = 'multicast' if multicast else 'unicast'
+        offset = (i - 0.5) * width
+        ax[0].bar(ind + offset, mdf['runtime'], width, label=label)
+        ax[1].bar(ind + offset, mdf['bandwidth'], width, label=label)
+    for subplot in ax:
+        subplot.set_xticks(ind, labels)
+        subplot.legend()
+    ax[0].set_ylabel('Runtime [cycles]')
+    ax[1].set_ylabel('A and B memory bandwidth [B/cycle]')
+
+    file = RESULT_DIR / 'multicast.pdf'
+    file.parent.mkdir(parents=True, exist_ok=True)
+    plt.tight_layout()
+    plt.savefig(file)
+
+
+def plot_ragged(df):
+    configs = df[['shape', 'grid']].drop_duplicates()
+    labels = [f'{shape}\n{grid}' for shape, grid in configs.itertuples(index=False)]
+    ind = np.arange(len(configs))
+    width = 0.4
+    fig, ax = plt.subplots(1, 2, figsize=(10, 4))
+    for i, auto in enumerate([False, True]):
+        tdf = df[(df['tiling'] == 'auto') == auto]
+        label = 'planner' if auto else 'manual'
+        offset = (i - 0.5) * width
+        ax[0].bar(ind + offset, tdf['runtime'], width, label=label)
+        ax[1].bar(ind + offset, tdf['fpu_util'], width, label=label)
+    for subplot in ax:
+        subplot.set_xticks(ind, labels)
+        subplot.legend()
+    ax[0].set_ylabel('Runtime [cycles]')
+    ax[1].set_ylabel('FPU utilization')
+
+    file = RESULT_DIR / 'ragged.pdf'
+    file.parent.mkdir(parents=True, exist_ok=True)
+    plt.tight_layout()
+    plt.savefig(file)
+
+
+def main():
+    parser = GemmExperimentManager.parser()
+    parser.add_argument('--plot', action='store_true')
+    args = parser.parse_args()
+    manager = GemmExperimentManager(args=args)
+    manager.run()
+
+    if args.plot:
+        df = manager.get_results()
+        df['runtime'] = df.apply(get_runtime, axis=1)
+        df['traffic'] = [get_operand_traffic(e) for e in manager.experiments]
+        df['bandwidth'] = df['traffic'] / df['runtime']
+        df['fpu_util'] = [get_fpu_util(e, runtime)
+                          for e, runtime in zip(manager.experiments, df['runtime'])]
+        multicast = df['multicast'].any()
+        ragged = (df['tiling'] == 'auto').any()
+        if ragged:
+            df['speedup'] = df.apply(lambda row: get_planner_speedup(df, row), axis=1)
+        elif multicast:
+            df['speedup'] = df.apply(lambda row: get_multicast_speedup(df, row), axis=1)
+        else:
+            df['speedup'] = df.apply(lambda row: get_speedup(df, row), axis=1)
+        df.drop(labels=['results'], inplace=True, axis=1)
+        print(df)
+
+        RESULT_DIR.mkdir(parents=True, exist_ok=True)
+        if ragged:
+            df.to_csv(RESULT_DIR / 'ragged.csv', index=False)
+            plot_ragged(df)
+        elif multicast:
+            df.to_csv(RESULT_DIR / 'multicast.csv', index=False)
+            plot_multicast(df)
+        else:
+            df.to_csv(RESULT_DIR / 'results.csv', index=False)
+            plot(df)
+
+
+if __name__ == '__main__':
+    main()
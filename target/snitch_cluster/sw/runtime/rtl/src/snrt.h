@@ -31,6 +31,7 @@
 #include "dump.h"
 #include "eu.h"
 #include "kmp.h"
+#include "log.h"
 #include "omp.h"
 #include "perf_cnt.h"
 #include "printf.h"
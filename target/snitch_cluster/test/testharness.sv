@@ -7,7 +7,15 @@
 
 module testharness #(
   parameter realtime ClkPeriod = 1ns
-);
+)
+`ifdef VERILATOR
+(
+  // Reset the DUT and boot again, driven by the Verilator testbench to run
+  // several binaries on the same model (see `tb_bin.cc`).
+  input logic restart_i
+)
+`endif
+;
 
   import snitch_cluster_pkg::*;
 
@@ -78,14 +86,25 @@ module testharness #(
   );
 
   initial begin
-    // Wait for the reset
-    vip.wait_for_reset();
-    // Wait for a few cycles
-    vip.wait_for_cycles(300);
-    // Write entrypoint to the scratch register
-    vip.write_entry_point();
-    // Set Cluster Clint interrupt
-    vip.set_cl_clint_interrupt();
+`ifdef VERILATOR
+    forever begin
+`endif
+      // Wait for the reset
+      vip.wait_for_reset();
+      // Wait for a few cycles
+      vip.wait_for_cycles(300);
+      // Write entrypoint to the scratch register
+      vip.write_entry_point();
+      // Set Cluster Clint interrupt
+      vip.set_cl_clint_interrupt();
+`ifdef VERILATOR
+      // Reset again on request and repeat the boot sequence
+      @(posedge restart_i);
+      fork
+        vip.apply_reset();
+      join_none
+    end
+`endif
   end
 
 endmodule
@@ -40,7 +40,7 @@ module vip_snitch_cluster
   ///////////////////////////
 
   // Generate reset
-  initial begin
+  task automatic apply_reset;
     rst_n = 0;
     #ClkPeriod;
     rst_n = 1;
@@ -48,7 +48,9 @@ module vip_snitch_cluster
     rst_n = 0;
     #ClkPeriod;
     rst_n = 1;
-  end
+  endtask
+
+  initial apply_reset();
 
   // Generate clock
   initial begin
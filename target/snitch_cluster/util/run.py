@@ -34,7 +34,8 @@ def run_simulations(simulations, args):
                                      dry_run=args.dry_run,
                                      early_exit=args.early_exit,
                                      verbose=args.verbose,
-                                     report_path=Path(args.run_dir) / 'report.csv')
+                                     report_path=Path(args.run_dir) / 'report.csv',
+                                     use_servers=args.server)
 
 
 def main():
@@ -0,0 +1,217 @@
+#!/usr/bin/env python3
+# Copyright 2024 ETH Zurich and University of Bologna.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+"""Decodes the profiled regions dumped by the Snitch runtime.
+
+Regions delimited by `snrt_perf_region_begin()` and
+`snrt_perf_region_end()` are recorded by every core, together with
+the value of `mcycle` and of the first performance counters, and
+flushed to the `snrt_perf_dump` array in L3. This script takes the raw
+contents of that array, e.g. as read out by a verification script
+(see `verif_utils.py`), and matches the begin and end records of each
+core into execution regions.
+
+By default, the output JSON has the format produced by
+[`join.py`][join], so it can be fed to [`roi.py`][roi] together with
+a ROI specification file. With `--roi`, regions are instead labeled
+directly, after their IDs or the names given with `--label`, and the
+output can be passed to [`visualize.py`][visualize].
+
+The performance counters are named after the metrics they were
+configured with, as listed in the cluster peripheral's register
+description.
+"""
+
+import argparse
+import json
+from pathlib import Path
+import struct
+import sys
+
+
+PERIPH_HJSON = Path(__file__).resolve().parent / \
+    '../../hw/snitch_cluster/src/snitch_cluster_peripheral/snitch_cluster_peripheral_reg.hjson'
+
+# Header fields of a core's dump, see `snrt_perf_dump_t`
+HEADER_FIELDS = ['hartid', 'num_cnts', 'len', 'count', 'dropped']
+
+REGION_END = 0x80000000
+
+
+def load_metric_names(hjson_path=PERIPH_HJSON):
+    """Map the metric values of the PERF_CNT_SEL register to their names."""
+    # Only needed to name the counters, as by the register tool
+    import hjson
+    with open(hjson_path, 'r') as f:
+        regs = hjson.load(f)
+    for reg in regs['registers']:
+        if reg.get('multireg', {}).get('name') == 'PERF_CNT_SEL':
+            for field in reg['multireg']['fields']:
+                if field['name'] == 'METRIC':
+                    return {int(e['value']): e['name'].lower() for e in field['enum']}
+    raise ValueError(f'No PERF_CNT_SEL metrics found in {hjson_path}')
+
+
+def parse_dumps(raw, num_harts):
+    """Parse the dumps of all harts from the raw contents of `snrt_perf_dump`.
+
+    Returns:
+        A list with, for each hart which set up region profiling, a
+        dictionary with the header fields, the counter selection and the
+        list of records as `(id, mcycle, counters)` tuples.
+    """
+    dump_size = len(raw) // num_harts
+    dumps = []
+    for i in range(num_harts):
+        base = i * dump_size
+        header = dict(zip(HEADER_FIELDS, struct.unpack_from('<5I', raw, base)))
+        num_cnts = header['num_cnts']
+        if not num_cnts:
+            continue
+        offset = base + 4 * len(HEADER_FIELDS)
+        header['select'] = list(struct.unpack_from(f'<{num_cnts}I', raw, offset))
+        offset += 4 * num_cnts
+        record_fmt = f'<{2 + num_cnts}I'
+        record_size = struct.calcsize(record_fmt)
+        records = []
+        for j in range(header['count']):
+            fields = struct.unpack_from(record_fmt, raw, offset + j * record_size)
+            records.append((fields[0], fields[1], fields[2:]))
+        header['records'] = records
+        dumps.append(header)
+    return dumps
+
+
+def counter_names(select, metrics):
+    """Name each counter after its metric, and hart if the metric is repeated."""
+    decoded = [(metrics.get(sel >> 16, f'metric{sel >> 16}'), sel & 0xffff) for sel in select]
+    names = []
+    for metric, hart in decoded:
+        repeated = sum(m == metric for m, _ in decoded) > 1
+        names.append(f'{metric}_hart{hart}' if repeated else metric)
+    return names
+
+
+def match_regions(dump, metrics, period=1):
+    """Match the begin and end records of a hart into regions.
+
+    Regions may nest. Each region is reported with its start and end
+    times, in ns given the clock `period`, its ID and the increment of
+    each performance counter over the region. Regions are sorted by
+    start time.
+    """
+    names = counter_names(dump['select'], metrics)
+    open_regions = []
+    regions = []
+    for region_id, mcycle, cnts in dump['records']:
+        if not region_id & REGION_END:
+            open_regions.append((region_id, mcycle, cnts))
+            continue
+        region_id &= ~REGION_END
+        # Match the innermost open region with the same ID
+        for k in reversed(range(len(open_regions))):
+            if open_regions[k][0] == region_id:
+                _, start, start_cnts = open_regions.pop(k)
+                break
+        else:
+            print(f'Warning: unmatched end of region {region_id} on hart {dump["hartid"]}',
+                  file=sys.stderr)
+            continue
+        cycles = (mcycle - start) % 2**32
+        region = {
+            'tstart': start * period,
+            'tend': (start + cycles) * period,
+            'id': region_id,
+            'cycles': cycles,
+        }
+        for name, begin, end in zip(names, start_cnts, cnts):
+            region[name] = (end - begin) % 2**32
+        regions.append(region)
+    for region_id, _, _ in open_regions:
+        print(f'Warning: region {region_id} on hart {dump["hartid"]} never ends',
+              file=sys.stderr)
+    if dump['dropped']:
+        print(f'Warning: {dump["dropped"]} records dropped on hart {dump["hartid"]}',
+              file=sys.stderr)
+    return sorted(regions, key=lambda region: region['tstart'])
+
+
+def decode(raw, num_harts, metrics, period=1):
+    """Decode the raw contents of `snrt_perf_dump` into `join.py` format."""
+    return {f'hart_{dump["hartid"]}': match_regions(dump, metrics, period)
+            for dump in parse_dumps(raw, num_harts)}
+
+
+def label_regions(data, labels):
+    """Label the decoded regions, in the format produced by `roi.py`."""
+    output = {}
+    for thread, regions in data.items():
+        output[thread] = [{
+            'label': labels.get(region['id'], f'region_{region["id"]}'),
+            'tstart': region['tstart'],
+            'tend': region['tend'],
+            'attrs': {key: value for key, value in region.items()
+                      if key not in ['tstart', 'tend', 'id']}
+        } for region in regions]
+    return output
+
+
+def parse_label(arg):
+    region_id, name = arg.split('=', 1)
+    return int(region_id, 0), name
+
+
+def main():
+    # Argument parsing
+    parser = argparse.ArgumentParser()
+    parser.add_argument(
+        'input',
+        help='Raw contents of the snrt_perf_dump array')
+    parser.add_argument(
+        '--num-harts',
+        type=int,
+        required=True,
+        help='Number of harts in the system, i.e. the length of snrt_perf_dump')
+    parser.add_argument(
+        '--period',
+        type=float,
+        default=1,
+        help='Clock period in ns, to convert cycles to simulation time')
+    parser.add_argument(
+        '--hjson',
+        default=PERIPH_HJSON,
+        help='Cluster peripheral register description, to name the counter metrics')
+    parser.add_argument(
+        '--roi',
+        action='store_true',
+        help='Label the regions and emit a ROI JSON for visualize.py')
+    parser.add_argument(
+        '--label',
+        type=parse_label,
+        action='append',
+        default=[],
+        metavar='ID=NAME',
+        help='Name of the regions with the given ID, used with --roi')
+    parser.add_argument(
+        '-o',
+        '--output',
+        nargs='?',
+        default='perf.json',
+        help='Output JSON file')
+    args = parser.parse_args()
+
+    with open(args.input, 'rb') as f:
+        raw = f.read()
+    metrics = load_metric_names(args.hjson)
+    output = decode(raw, args.num_harts, metrics, args.period)
+    if args.roi:
+        output = label_regions(output, dict(args.label))
+
+    # Write output to file
+    with open(args.output, 'w') as f:
+        json.dump(output, f, indent=4)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+# Copyright 2024 ETH Zurich and University of Bologna.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+
+import struct
+from bench.perf_regions import REGION_END, decode, label_regions
+
+METRICS = {0: 'cycle', 6: 'retired_instr'}
+NUM_CNTS = 2
+DUMP_LEN = 4
+
+
+# Emulates the layout of `snrt_perf_dump_t`
+def pack_dump(hartid, select, records, dropped=0):
+    raw = struct.pack('<5I', hartid, NUM_CNTS, DUMP_LEN, len(records), dropped)
+    raw += struct.pack(f'<{NUM_CNTS}I', *select)
+    for record in records:
+        raw += struct.pack(f'<{2 + NUM_CNTS}I', *record)
+    return raw + bytes(4 * (2 + NUM_CNTS) * (DUMP_LEN - len(records)))
+
+
+def test_decode():
+    raw = pack_dump(0, [0 << 16, 6 << 16], [
+        (1, 100, 10, 0),
+        (2, 110, 20, 5),
+        (2 | REGION_END, 150, 60, 25),
+        (1 | REGION_END, 200, 110, 30),
+    ])
+    # Counters wrap around, and repeated metrics are told apart by hart
+    raw += pack_dump(1, [6 << 16 | 1, 6 << 16 | 2], [
+        (3, 2**32 - 10, 2**32 - 1, 7),
+        (3 | REGION_END, 20, 4, 9),
+    ])
+    # Harts which do not record regions are skipped
+    raw += bytes(len(raw) // 2)
+    assert decode(raw, 3, METRICS) == {
+        'hart_0': [
+            {'tstart': 100, 'tend': 200, 'id': 1, 'cycles': 100, 'cycle': 100,
+             'retired_instr': 30},
+            {'tstart': 110, 'tend': 150, 'id': 2, 'cycles': 40, 'cycle': 40,
+             'retired_instr': 20},
+        ],
+        'hart_1': [
+            {'tstart': 2**32 - 10, 'tend': 2**32 + 20, 'id': 3, 'cycles': 30,
+             'retired_instr_hart1': 5, 'retired_instr_hart2': 2},
+        ],
+    }
+
+
+def test_label_regions():
+    data = {'hart_0': [{'tstart': 100, 'tend': 200, 'id': 1, 'cycles': 100},
+                       {'tstart': 110, 'tend': 150, 'id': 2, 'cycles': 40}]}
+    assert label_regions(data, {1: 'gemm'}) == {
+        'hart_0': [
+            {'label': 'gemm', 'tstart': 100, 'tend': 200, 'attrs': {'cycles': 100}},
+            {'label': 'region_2', 'tstart': 110, 'tend': 150, 'attrs': {'cycles': 40}},
+        ]
+    }
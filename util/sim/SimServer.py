@@ -0,0 +1,136 @@
+# Copyright 2024 ETH Zurich and University of Bologna.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+"""Persistent simulation servers.
+
+Verilator testbenches launched with `--server,<req>,<resp>` keep their
+model alive after the first binary, and run further binaries requested
+through a pair of named FIFOs (see `tb_bin.cc`). This saves the
+simulator's start-up cost, and allows the operating system to keep
+sharing one copy of the model between simulations.
+"""
+
+import os
+import subprocess
+import tempfile
+import threading
+from pathlib import Path
+
+
+class ServerJob(object):
+    """A binary run on a `SimServer`.
+
+    Mimics the interface of `subprocess.Popen` used by the `Simulation`
+    classes, such that a job can stand in for a simulation process.
+    """
+
+    def __init__(self, server):
+        self.server = server
+        self.returncode = None
+
+    def poll(self):
+        # Fail the job if the server died before reporting its exit code
+        if self.returncode is None and self.server.process.poll() is not None:
+            # Let the reader consume a response still in flight
+            self.server.reader.join(timeout=1)
+            if self.returncode is None:
+                self.returncode = self.server.process.returncode or -1
+        return self.returncode
+
+
+class SimServer(object):
+    """A simulation binary serving a sequence of simulations."""
+
+    def __init__(self):
+        self.process = None
+        self.job = None
+        self.req = None
+
+    def alive(self):
+        return self.process is not None and self.process.poll() is None
+
+    def idle(self):
+        return self.job is None or self.job.poll() is not None
+
+    def submit(self, sim):
+        """Run a simulation on the server.
+
+        The first simulation starts the server with its own command. The
+        simulation's `log` and `run_dir` must have been set up by the
+        caller.
+
+        Returns:
+            A `ServerJob` acting as the simulation's process.
+        """
+        assert self.idle()
+        self.job = ServerJob(self)
+        if self.alive():
+            self.req.write(f'{Path(sim.elf).resolve()}\t{Path(sim.run_dir).resolve()}\t'
+                           f'{Path(sim.log).resolve()}\n')
+            self.req.flush()
+        else:
+            self.start(sim)
+        return self.job
+
+    def start(self, sim):
+        self.close()
+        self.tmpdir = tempfile.TemporaryDirectory(prefix='simserver')
+        req = os.path.join(self.tmpdir.name, 'req')
+        resp = os.path.join(self.tmpdir.name, 'resp')
+        os.mkfifo(req)
+        os.mkfifo(resp)
+        with open(sim.log, 'w') as f:
+            self.process = subprocess.Popen(sim.cmd + [f'--server,{req},{resp}'], stdout=f,
+                                            stderr=subprocess.STDOUT, cwd=sim.run_dir,
+                                            universal_newlines=True)
+        self.reader = threading.Thread(target=self.serve_responses, args=(req, resp),
+                                       daemon=True)
+        self.reader.start()
+
+    def serve_responses(self, req, resp):
+        # Opening a FIFO blocks until the other end is opened, so open both ends in
+        # the same order as the server, in the background.
+        self.req = open(req, 'w')
+        with open(resp, 'r') as f:
+            for line in f:
+                self.job.returncode = int(line)
+
+    def close(self):
+        """Stop the server once it has finished its current simulation."""
+        if self.req is not None:
+            self.req.close()
+            self.req = None
+        if self.process is not None:
+            self.process.wait()
+            self.process = None
+            self.tmpdir.cleanup()
+
+
+class SimServerPool(object):
+    """A pool of simulation servers, started on demand.
+
+    A server only runs simulations with the same command as the one it
+    was started with, except for the binary, since it keeps the
+    simulation model and arguments of that command.
+    """
+
+    def __init__(self):
+        self.servers = {}
+
+    @staticmethod
+    def key(sim):
+        elf = str(sim.elf)
+        return tuple(None if arg == elf else arg for arg in sim.cmd)
+
+    def submit(self, sim):
+        servers = self.servers.setdefault(self.key(sim), [])
+        server = next((s for s in servers if s.idle()), None)
+        if server is None:
+            server = SimServer()
+            servers.append(server)
+        return server.submit(sim)
+
+    def close(self):
+        for servers in self.servers.values():
+            for server in servers:
+                server.close()
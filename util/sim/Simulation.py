@@ -47,7 +47,7 @@ class Simulation(object):
         self.expected_retcode = int(retcode)
         self.env = None
 
-    def launch(self, dry_run=None):
+    def launch(self, dry_run=None, server=None):
         """Launch the simulation.
 
         Launch the simulation by invoking the command stored in the
@@ -57,6 +57,8 @@ class Simulation(object):
         Arguments:
             dry_run: A preview of the simulation command is displayed
                 without actually launching the simulation.
+            server: A `SimServerPool` to run the simulation on, if the
+                simulation supports it (see `supports_server`).
         """
         # Override dry_run setting at launch time
         if dry_run is not None:
@@ -72,12 +74,20 @@ class Simulation(object):
             # Create run directory and log file
             os.makedirs(self.run_dir, exist_ok=True)
             self.log = self.run_dir / self.LOG_FILE
+            # Run simulation on a persistent server
+            if server is not None and self.supports_server():
+                self.process = server.submit(self)
+                return
             # Launch simulation subprocess
             with open(self.log, 'w') as f:
                 self.process = subprocess.Popen(self.cmd, stdout=f, stderr=subprocess.STDOUT,
                                                 cwd=self.run_dir, universal_newlines=True,
                                                 env=self.env)
 
+    def supports_server(self):
+        """Return whether the simulation can run on a `SimServer`."""
+        return False
+
     def launched(self):
         """Return whether the simulation was launched."""
         if self.process:
@@ -185,7 +195,10 @@ class VerilatorSimulation(RTLSimulation):
     The return code of the simulation is returned directly as the
     return code of the command launching the simulation.
     """
-    pass
+
+    def supports_server(self):
+        # Servers run plain binaries, in their own environment
+        return not self.ext_verif_logic and self.env is None
 
 
 class QuestaVCSSimulation(RTLSimulation):
@@ -11,6 +11,9 @@
 
 import os
 import sys
+import ctypes
+import ctypes.util
+import mmap
 import tempfile
 import subprocess
 import struct
@@ -22,18 +25,65 @@ import signal
 # Simulation monitor polling period (in seconds)
 SIM_MONITOR_POLL_PERIOD = 2
 
+# Shared-memory channel, see `ipc_shm_hdr_t` in `target/common/test/ipc.hh`
+SHM_MAGIC = 0x4d48534350494e53
+SHM_HDR_FMT = '=7Q'
+SHM_HEAD_OFFSET = 56
+SHM_TAIL_OFFSET = 64
+SHM_CLOSED_OFFSET = 72
+SHM_CLIENT_PID_OFFSET = 80
+SHM_RING_OFFSET = 88
+SHM_CMD_FMT = '=4Q'
+# C11 memory orders of the accesses to the ring indices of the shared-memory channel
+ATOMIC_ACQUIRE = 2
+ATOMIC_RELEASE = 3
+# Maximum backoff (in seconds) while waiting on the shared-memory channel
+SHM_MAX_BACKOFF = 1e-3
+# Memory profiler actions, see `ipc_profile_e` in `target/common/test/ipc.hh`
+PROFILE_ACTIONS = {'stop': 0, 'start': 1, 'dump': 2}
+
 
 class SnitchSim:
 
-    def __init__(self, sim_bin: str, snitch_bin: str, simulator: str = None, log: str = None):
+    def __init__(self, sim_bin: str, snitch_bin: str, simulator: str = None, log: str = None,
+                 ipc: str = 'fifo', shm_size: int = 0):
+        """Constructor.
+
+        Args:
+            ipc: Either `fifo`, to exchange all data through named pipes, or
+                `shm`, to exchange commands and data through a POSIX
+                shared-memory segment. The latter is only supported by the
+                RTL testbenches.
+            shm_size: Number of bytes, from the start of the global memory,
+                which the segment backs directly and this process maps, if
+                `ipc` is `shm`. Accesses by the simulation to this region are
+                slower, so it should only cover the data exchanged with it.
+        """
         self.sim_bin = sim_bin
         self.snitch_bin = snitch_bin
         self.sim = None
         self.tmpdir = None
         self.simulator = simulator
         self.log = open(log, 'w+') if log else log
+        if ipc not in ('fifo', 'shm'):
+            raise ValueError(f'Unknown IPC mode `{ipc}`')
+        if ipc == 'shm' and simulator == 'gvsoc':
+            raise ValueError('Shared-memory IPC is not supported by GVSoC')
+        self.ipc = ipc
+        self.shm_size = shm_size
+        self.shm = None
 
     def start(self):
+        if self.ipc == 'shm':
+            self.__start_shm()
+        else:
+            self.__start_fifo()
+        # Create thread to monitor simulation
+        self.stop_sim_monitor = threading.Event()
+        self.sim_monitor = threading.Thread(target=self.__monitor_sim)
+        self.sim_monitor.start()
+
+    def __start_fifo(self):
         # Create FIFOs
         self.tmpdir = tempfile.TemporaryDirectory()
         tx_fd = os.path.join(self.tmpdir.name, 'tx')
@@ -50,10 +100,67 @@ class SnitchSim:
         # Open FIFOs
         self.tx = open(tx_fd, 'wb', buffering=0)  # Unbuffered
         self.rx = open(rx_fd, 'rb')
-        # Create thread to monitor simulation
-        self.stop_sim_monitor = threading.Event()
-        self.sim_monitor = threading.Thread(target=self.__monitor_sim)
-        self.sim_monitor.start()
+
+    def __start_shm(self):
+        # The segment is created by the simulator, under a name unique to this object
+        self.shm_name = f'/snitchsim-{os.getpid()}-{id(self):x}'
+        shm_path = os.path.join('/dev/shm', self.shm_name[1:])
+        ipc_arg = f'--ipc-shm,{self.shm_name},{self.shm_size}'
+        self.sim = subprocess.Popen([self.sim_bin, self.snitch_bin, ipc_arg], stdout=self.log)
+        # Wait for the simulator to create and publish the segment
+        while True:
+            if self.sim.poll() is not None:
+                raise RuntimeError(f'Simulation `{self.sim_bin}` exited before creating the '
+                                   'shared-memory segment')
+            if os.path.exists(shm_path):
+                with open(shm_path, 'r+b') as f:
+                    size = os.fstat(f.fileno()).st_size
+                    if size > 0:
+                        shm = mmap.mmap(f.fileno(), size)
+                        if struct.unpack_from('=Q', shm, 0)[0] == SHM_MAGIC:
+                            self.shm = shm
+                            break
+                        shm.close()
+            time.sleep(0.01)
+        _, self.shm_base, self.shm_size, self.shm_data, self.shm_buf, self.shm_buf_size, \
+            self.shm_ring_size = struct.unpack_from(SHM_HDR_FMT, self.shm, 0)
+        # The ring indices are accessed atomically, such that the simulator only sees the
+        # head of a command after its body, and this process the results after the tail
+        libatomic = ctypes.CDLL(ctypes.util.find_library('atomic'))
+        self.atomic_load = getattr(libatomic, '__atomic_load_8')
+        self.atomic_load.argtypes = [ctypes.c_void_p, ctypes.c_int]
+        self.atomic_load.restype = ctypes.c_uint64
+        self.atomic_store = getattr(libatomic, '__atomic_store_8')
+        self.atomic_store.argtypes = [ctypes.c_void_p, ctypes.c_uint64, ctypes.c_int]
+        self.atomic_store.restype = None
+        self.shm_ptr = ctypes.c_char.from_buffer(self.shm)
+        self.shm_head = self.__shm_load(SHM_HEAD_OFFSET)
+        # Let the simulator stop serving the channel if this process dies without closing it
+        self.__shm_store(SHM_CLIENT_PID_OFFSET, os.getpid())
+
+    def __shm_load(self, offset: int) -> int:
+        return self.atomic_load(ctypes.addressof(self.shm_ptr) + offset, ATOMIC_ACQUIRE)
+
+    def __shm_store(self, offset: int, value: int):
+        self.atomic_store(ctypes.addressof(self.shm_ptr) + offset, value, ATOMIC_RELEASE)
+
+    def __shm_offset(self, addr: int, length: int):
+        """Offset of `[addr, addr + length)` in the segment if it is shared, else `None`."""
+        if self.shm_base <= addr and addr + length <= self.shm_base + self.shm_size:
+            return self.shm_data + addr - self.shm_base
+        return None
+
+    def __shm_command(self, opcode: int, addr: int, length: int) -> int:
+        """Post a command to the ring and wait for its completion."""
+        slot = SHM_RING_OFFSET + (self.shm_head % self.shm_ring_size) * struct.calcsize(SHM_CMD_FMT)
+        struct.pack_into(SHM_CMD_FMT, self.shm, slot, opcode, addr, length, 0)
+        self.shm_head += 1
+        self.__shm_store(SHM_HEAD_OFFSET, self.shm_head)
+        backoff = 1e-6
+        while self.__shm_load(SHM_TAIL_OFFSET) < self.shm_head:
+            time.sleep(backoff)
+            backoff = min(2 * backoff, SHM_MAX_BACKOFF)
+        return struct.unpack_from(SHM_CMD_FMT, self.shm, slot)[3]
 
     def __sim_active(func):
         @functools.wraps(func)
@@ -80,18 +187,41 @@ class SnitchSim:
 
     @__sim_active
     def read(self, addr: int, length: int) -> bytes:
+        if self.shm:
+            offset = self.__shm_offset(addr, length)
+            if offset is not None:
+                return self.shm[offset:offset + length]
+            # Fall back to the bounce buffer outside the shared region
+            data = bytearray()
+            for i in range(0, length, self.shm_buf_size):
+                chunk = min(self.shm_buf_size, length - i)
+                self.__shm_command(0, addr + i, chunk)
+                data += self.shm[self.shm_buf:self.shm_buf + chunk]
+            return bytes(data)
         op = struct.pack('=QQQ', 0, addr, length)
         self.tx.write(op)
         return self.rx.read(length)
 
     @__sim_active
     def write(self, addr: int, data: bytes):
+        if self.shm:
+            offset = self.__shm_offset(addr, len(data))
+            if offset is not None:
+                self.shm[offset:offset + len(data)] = data
+                return
+            for i in range(0, len(data), self.shm_buf_size):
+                chunk = data[i:i + self.shm_buf_size]
+                self.shm[self.shm_buf:self.shm_buf + len(chunk)] = chunk
+                self.__shm_command(1, addr + i, len(chunk))
+            return
         op = struct.pack('=QQQ', 1, addr, len(data))
         self.tx.write(op)
         self.tx.write(data)
 
     @__sim_active
     def poll(self, addr: int, mask32: int, exp32: int):
+        if self.shm:
+            return self.__shm_command(2, addr, (exp32 << 32) | mask32) & 0xFFFFFFFF
         op = struct.pack('=QQLL', 2, addr, mask32, exp32)
         while True:
             try:
@@ -103,11 +233,41 @@ class SnitchSim:
         bytestring = self.rx.read(4)
         return int.from_bytes(bytestring, byteorder='little')
 
+    @__sim_active
+    def mem_profile(self, action: str):
+        """Control the testbench's memory traffic profiler.
+
+        Args:
+            action: `start` to clear the profile and start counting,
+                `stop` to stop counting, or `dump` to write the profile
+                to the path given with `--mem-profile`
+                (`mem_profile.json` by default).
+        """
+        if self.simulator == 'gvsoc':
+            raise ValueError('Memory profiling is not supported by GVSoC')
+        if action not in PROFILE_ACTIONS:
+            raise ValueError(f'Unknown memory profile action `{action}`')
+        if self.shm:
+            status = self.__shm_command(3, PROFILE_ACTIONS[action], 0)
+        else:
+            self.tx.write(struct.pack('=QQQ', 3, PROFILE_ACTIONS[action], 0))
+            status = int.from_bytes(self.rx.read(4), byteorder='little')
+        if status != 0:
+            raise RuntimeError(f'Memory profile action `{action}` failed')
+
     @__sim_active
     def finish(self, wait_for_sim: bool = True):
-        # Close FIFOs (simulator can exit only once TX FIFO closes)
-        self.rx.close()
-        self.tx.close()
+        if self.shm:
+            # Close channel (simulator can exit only once it is closed)
+            self.__shm_store(SHM_CLOSED_OFFSET, 1)
+            # Release the pointer into the mapping, which cannot be closed while exported
+            self.shm_ptr = None
+            self.shm.close()
+            self.shm = None
+        else:
+            # Close FIFOs (simulator can exit only once TX FIFO closes)
+            self.rx.close()
+            self.tx.close()
         # Close simulation monitor
         self.stop_sim_monitor.set()
         self.sim_monitor.join()
@@ -117,7 +277,15 @@ class SnitchSim:
         else:
             self.sim.terminate()
         # Cleanup
-        self.tmpdir.cleanup()
+        if self.tmpdir:
+            self.tmpdir.cleanup()
+            self.tmpdir = None
+        if self.ipc == 'shm':
+            # Normally unlinked by the simulator, unless it was terminated
+            try:
+                os.unlink(os.path.join('/dev/shm', self.shm_name[1:]))
+            except FileNotFoundError:
+                pass
         self.sim = None
 
 
@@ -56,6 +56,7 @@ import signal
 import psutil
 import pandas as pd
 from prettytable import PrettyTable
+from snitch.util.sim.SimServer import SimServerPool
 
 
 POLL_PERIOD = 0.2
@@ -118,6 +119,11 @@ def parser(default_simulator='vsim', simulator_choices=['vsim']):
         help=('Maximum number of tests to run in parallel. '
               'One if the option is not present. Equal to the number of CPU cores '
               'if the option is present but not followed by an argument.'))
+    parser.add_argument(
+        '--server',
+        action='store_true',
+        help=('Run tests on persistent simulation servers, reusing the simulation model '
+              'across tests. Only supported on Verilator.'))
     return parser
 
 
@@ -323,12 +329,14 @@ def get_unique_run_dir(sim, prefix=None):
 
 
 def run_simulations(simulations, n_procs=1, dry_run=None, early_exit=False,
-                    verbose=False, report_path=None):
+                    verbose=False, report_path=None, use_servers=False):
     """Run simulations defined by a list of `Simulation` objects.
 
     Args:
         simulations: A list of `Simulation` objects as returned e.g. by
             [sim_utils.get_simulations][].
+        use_servers: Run the simulations which support it on a pool of
+            persistent simulation servers, see [SimServer][].
 
     Returns:
         The number of failed simulations.
@@ -341,13 +349,14 @@ def run_simulations(simulations, n_procs=1, dry_run=None, early_exit=False,
     failed_sims = []
     successful_sims = []
     early_exit_requested = False
+    servers = SimServerPool() if use_servers else None
     try:
         while (len(simulations) or len(running_sims)) and not early_exit_requested:
             # If there are still simulations to run and there are less running simulations than
             # the maximum number of processes allowed in parallel, spawn new simulation
             if len(simulations) and len(running_sims) < n_procs:
                 running_sims.append(simulations.pop(0))
-                running_sims[-1].launch(dry_run=dry_run)
+                running_sims[-1].launch(dry_run=dry_run, server=servers)
             # Remove completed sims from running sims list
             idcs = [i for i, sim in enumerate(running_sims) if sim.completed()]
             completed_sims = [running_sims.pop(i) for i in sorted(idcs, reverse=True)]
@@ -374,6 +383,8 @@ def run_simulations(simulations, n_procs=1, dry_run=None, early_exit=False,
     # Clean up after early exit
     if early_exit_requested:
         terminate_processes()
+    if servers is not None:
+        servers.close()
 
     # Print summary and dump report
     print_summary(simulations + running_sims + successful_sims + failed_sims)
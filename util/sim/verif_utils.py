@@ -100,10 +100,24 @@ class Verifier:
         parser.add_argument(
             '--simulator',
             help='Specifies simulator')
+        parser.add_argument(
+            '--ipc',
+            choices=['fifo', 'shm'],
+            default='fifo',
+            help='IPC channel to the simulation: named pipes, or a shared-memory '
+                 'mapping of the simulation memory (RTL simulators only)')
         parser.add_argument(
             '--dump-results',
             action='store_true',
             help='Dump results even if the simulation does not fail')
+        parser.add_argument(
+            '--perf-dump',
+            help='Write the raw contents of the profiled regions (snrt_perf_dump) '
+                 'to this file, to be decoded with util/bench/perf_regions.py')
+        parser.add_argument(
+            '--log-dump',
+            help='Write the raw contents of the deferred log (snrt_log_buffers) '
+                 'to this file, to be decoded with util/trace/snrt_log.py')
         return parser
 
     def parse_args(self):
@@ -148,7 +162,7 @@ class Verifier:
 
         # Start simulation
         sim = SnitchSim(self.args.sim_bin, self.args.snitch_bin, simulator=self.args.simulator,
-                        log=self.args.log)
+                        log=self.args.log, ipc=self.args.ipc)
         sim.start()
 
         # Wait for kernel execution to be over
@@ -163,6 +177,16 @@ class Verifier:
             address = elf.get_symbol_address(uid)
             size = elf.get_symbol_size(uid)
             self.raw_outputs[uid] = sim.read(address, size)
+        if self.args.perf_dump:
+            address = elf.get_symbol_address('snrt_perf_dump')
+            size = elf.get_symbol_size('snrt_perf_dump')
+            with open(self.args.perf_dump, 'wb') as f:
+                f.write(sim.read(address, size))
+        if self.args.log_dump:
+            address = elf.get_symbol_address('snrt_log_buffers')
+            size = elf.get_symbol_size('snrt_log_buffers')
+            with open(self.args.log_dump, 'wb') as f:
+                f.write(sim.read(address, size))
 
         # Terminate
         sim.finish(wait_for_sim=True)
@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+# Copyright 2024 ETH Zurich and University of Bologna.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+"""Reader for the binary instruction traces of Snitch.
+
+When the RTL is compiled with `SNITCH_BINARY_TRACE` (`BIN_TRACE=1`), the
+core tracers in `snitch_cc.sv` hand their records to the DPI library in
+`target/common/test/trace.cc`, which writes compressed binary traces
+(`trace_hart_*.bin`) instead of textual ones (`trace_hart_*.dasm`). See
+`target/common/test/trace.hh` for a description of the format.
+
+This module decodes such traces back into the lines the textual tracer would
+have produced, so that all downstream tools, in particular `gen_trace.py`,
+can consume either format. It can also be run as a script to convert a
+binary trace to its textual equivalent.
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+MAGIC = b'SNTRACE\0'
+VERSION = 1
+
+FILE_HEADER = struct.Struct('<8sIIQ')
+BLOCK_HEADER = struct.Struct('<II')
+RECORD_HEADER = struct.Struct('<BBHIQQQ')
+
+# Fields of the trace port structs in `snitch_pkg`, in declaration order
+SNITCH_FIELDS = (
+    'source', 'stall', 'exception', 'rs1', 'rs2', 'rd', 'is_load', 'is_store',
+    'is_branch', 'pc_d', 'opa', 'opb', 'opa_select', 'opb_select', 'write_rd',
+    'csr_addr', 'writeback', 'gpr_rdata_1', 'ls_size', 'ld_result_32',
+    'lsu_rd', 'retire_load', 'alu_result', 'ls_amo', 'retire_acc', 'acc_pid',
+    'acc_pdata_32', 'fpu_offload', 'is_seq_insn')
+FPU_FIELDS = (
+    'source', 'acc_q_hs', 'fpu_out_hs', 'lsu_q_hs', 'op_in', 'rs1', 'rs2',
+    'rs3', 'rd', 'op_sel_0', 'op_sel_1', 'op_sel_2', 'src_fmt', 'dst_fmt',
+    'int_fmt', 'acc_qdata_0', 'acc_qdata_1', 'acc_qdata_2', 'op_0', 'op_1',
+    'op_2', 'use_fpu', 'fpu_in_rd', 'fpu_in_acc', 'ls_size', 'is_load',
+    'is_store', 'lsu_qaddr', 'lsu_rd', 'acc_wb_ready', 'fpu_out_acc',
+    'fpr_waddr', 'fpr_wdata', 'fpr_we')
+FPU_SEQ_FIELDS = (
+    'source', 'cbuf_push', 'max_inst', 'max_iter', 'stg_max', 'stg_mask')
+
+# Record kinds (`sim::trace::Kind`)
+KIND_SNITCH = 0
+KIND_FPU = 1
+KIND_FPU_SEQ = 2
+
+FIELDS = {
+    KIND_SNITCH: SNITCH_FIELDS,
+    KIND_FPU: FPU_FIELDS,
+    KIND_FPU_SEQ: FPU_SEQ_FIELDS,
+}
+
+
+def is_binary_trace(path):
+    """Check whether the file at `path` is a binary trace."""
+    try:
+        with open(path, 'rb') as f:
+            return f.read(len(MAGIC)) == MAGIC
+    except OSError:
+        return False
+
+
+def read_records(f):
+    """Yield all records of a binary trace opened in binary mode.
+
+    Returns a generator of `(time, cycle, priv, kind, pc, insn, fields)`
+    tuples, where `time` is already scaled as `%t` would print it and
+    `fields` is a tuple of the struct fields in declaration order.
+    """
+    magic, version, _, time_scale = FILE_HEADER.unpack(f.read(FILE_HEADER.size))
+    if magic != MAGIC:
+        raise ValueError('Not a binary Snitch trace')
+    if version != VERSION:
+        raise ValueError(f'Unsupported binary trace version {version}')
+    while True:
+        hdr = f.read(BLOCK_HEADER.size)
+        if len(hdr) < BLOCK_HEADER.size:
+            # A truncated header means the simulation did not terminate
+            # cleanly: return all records written so far.
+            return
+        raw_size, size = BLOCK_HEADER.unpack(hdr)
+        block = f.read(size)
+        if len(block) < size:
+            return
+        if size != raw_size:
+            block = zlib.decompress(block)
+        offset = 0
+        while offset < len(block):
+            kind, priv, num_fields, pc, time, cycle, insn = \
+                RECORD_HEADER.unpack_from(block, offset)
+            offset += RECORD_HEADER.size
+            fields = struct.unpack_from(f'<{num_fields}Q', block, offset)
+            offset += 8 * num_fields
+            yield time * time_scale, cycle, priv, kind, pc, insn, fields
+
+
+def format_record(time, cycle, priv, kind, pc, insn, fields):
+    """Format a record as a line of the textual tracer."""
+    extras = ''.join(f"'{name}': 0x{val:x}, " for name, val in zip(FIELDS[kind], fields))
+    if kind == KIND_SNITCH:
+        pc_str, insn_str = f'{pc:08x}', f'{insn:08x}'
+    elif kind == KIND_FPU:
+        pc_str, insn_str = 'z' * 8, f'{insn:016x}'
+    else:
+        pc_str, insn_str = 'z' * 8, 'z' * 16
+    return f'{time:>20} {cycle} {priv:8} 0x{pc_str} DASM({insn_str}) #; {{{extras}}}\n'
+
+
+class BinaryTraceReader:
+    """File-like view of a binary trace, yielding the textual trace lines.
+
+    Only implements what `gen_trace.py` needs from its input file.
+    """
+
+    def __init__(self, path):
+        self.name = path
+        self.file = open(path, 'rb')
+        self.records = read_records(self.file)
+
+    def readline(self):
+        for record in self.records:
+            return format_record(*record)
+        return ''
+
+    def __iter__(self):
+        return iter(self.readline, '')
+
+    def close(self):
+        self.file.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument(
+        'infile',
+        metavar='trace_hart_xxxxx.bin',
+        help='Binary trace to convert')
+    parser.add_argument(
+        '-o',
+        '--output',
+        type=argparse.FileType('w'),
+        default=sys.stdout,
+        help='Path to the textual (.dasm) output trace')
+    args = parser.parse_args()
+
+    with BinaryTraceReader(args.infile) as trace, args.output as out:
+        out.writelines(trace)
+
+
+if __name__ == '__main__':
+    main()
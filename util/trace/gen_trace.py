@@ -9,7 +9,8 @@
 
 This script takes a trace generated by a Snitch hart
 (see `snitch_cc.sv`) and transforms the additional decode stage info
-into meaningful annotation.
+into meaningful annotation. Both textual (`.dasm`) and binary (`.bin`,
+see `bintrace.py`) traces are accepted.
 
 It also counts and computes various performance metrics for every
 execution region. An execution region is a sequence of instructions.
@@ -47,6 +48,7 @@ from typing import Optional
 from itertools import tee, islice, chain
 from functools import lru_cache
 from snitch.util.trace.sequencer import Sequencer
+from snitch.util.trace.bintrace import BinaryTraceReader, is_binary_trace
 import warnings
 
 DASM_IN_REGEX = r'DASM\(([0-9a-fA-F]+)\)'
@@ -1018,6 +1020,13 @@ def current_and_next(iterable):
 # -------------------- Main --------------------
 
 
+def open_trace(path):
+    """Open a textual or binary trace as a file of textual trace lines."""
+    if path != '-' and is_binary_trace(path):
+        return BinaryTraceReader(path)
+    return argparse.FileType('r')(path)
+
+
 # noinspection PyTypeChecker
 def main():
     # Argument parsing and iterator creation
@@ -1026,9 +1035,9 @@ def main():
         'infile',
         metavar='infile.dasm',
         nargs='?',
-        type=argparse.FileType('r'),
+        type=open_trace,
         default=sys.stdin,
-        help='A matching ASCII signal dump',
+        help='A matching ASCII signal dump, or a binary trace',
     )
     parser.add_argument(
         '-o',
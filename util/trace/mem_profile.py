@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+# Copyright 2024 ETH Zurich and University of Bologna.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+"""Summarize a memory traffic profile of the testbench.
+
+This script takes the JSON profile written by the testbench's memory
+profiler (`--mem-profile`) and reports the read/write mix, the access
+size distribution, the bandwidth over time and the hottest pages. If
+the simulated binary is given, pages are attributed to the symbols
+they overlap, to identify the buffers causing hot spots.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load_symbols(elf_path):
+    """Return the sized data and function symbols of an ELF file."""
+    from elftools.elf.elffile import ELFFile
+    from elftools.elf.sections import SymbolTableSection
+    symbols = []
+    with open(elf_path, 'rb') as f:
+        for section in ELFFile(f).iter_sections():
+            if not isinstance(section, SymbolTableSection):
+                continue
+            for sym in section.iter_symbols():
+                if sym['st_size'] and sym['st_info']['type'] in ('STT_OBJECT', 'STT_FUNC'):
+                    symbols.append((sym['st_value'], sym['st_size'], sym.name))
+    return symbols
+
+
+def page_symbols(symbols, base, size):
+    """Names of the symbols overlapping the page `[base, base + size)`."""
+    return [name for addr, length, name in symbols if addr < base + size and addr + length > base]
+
+
+def bandwidth_summary(profile, peak):
+    """Return bandwidth statistics over the profile's time windows."""
+    window = profile['window_ns']
+    reads = profile['windows']['read_bytes']
+    writes = profile['windows']['write_bytes']
+    traffic = [r + w for r, w in zip(reads, writes)]
+    busy = [t for t in traffic if t]
+    summary = {
+        'windows': len(traffic),
+        'active_windows': len(busy),
+        'peak_bw': max(traffic, default=0) / window,
+        'mean_active_bw': sum(busy) / len(busy) / window if busy else 0,
+    }
+    if peak:
+        # Windows in which the traffic reaches 80% of the peak bandwidth
+        summary['saturated_windows'] = sum(t >= 0.8 * peak * window for t in traffic)
+    return summary
+
+
+def main():
+    # Argument parsing
+    parser = argparse.ArgumentParser()
+    parser.add_argument(
+        'input',
+        help='Memory profile JSON file')
+    parser.add_argument(
+        '--elf',
+        help='Simulated binary, to attribute pages to symbols')
+    parser.add_argument(
+        '--top',
+        type=int,
+        default=10,
+        help='Number of hottest pages to report')
+    parser.add_argument(
+        '--peak-bw',
+        type=float,
+        help='Peak memory bandwidth in bytes per ns, to count saturated windows')
+    args = parser.parse_args()
+
+    with open(args.input) as f:
+        profile = json.load(f)
+
+    total = profile['total']
+    read_bytes, write_bytes = total['read_bytes'], total['write_bytes']
+    print(f"Accesses: {total['reads']} reads ({read_bytes} B), "
+          f"{total['writes']} writes ({write_bytes} B)")
+    if read_bytes + write_bytes:
+        print(f'Read share: {100 * read_bytes / (read_bytes + write_bytes):.1f}% of bytes')
+    for kind in ('read', 'write'):
+        sizes = ', '.join(f'{size} B: {count}'
+                          for size, count in profile['access_sizes'][kind].items())
+        print(f'{kind.capitalize()} access sizes: {sizes or "none"}')
+
+    bw = bandwidth_summary(profile, args.peak_bw)
+    print(f"Bandwidth over {bw['windows']} windows of {profile['window_ns']} ns from "
+          f"{profile['first_window_ns']} ns: peak {bw['peak_bw']:.2f} B/ns, "
+          f"mean {bw['mean_active_bw']:.2f} B/ns in {bw['active_windows']} active windows")
+    if 'saturated_windows' in bw:
+        print(f"Windows above 80% of peak bandwidth: {bw['saturated_windows']}")
+
+    symbols = load_symbols(args.elf) if args.elf else []
+    pages = sorted(profile['pages'].items(),
+                   key=lambda p: p[1]['read_bytes'] + p[1]['write_bytes'], reverse=True)
+    print(f'Hottest pages ({profile["page_size"]} B):')
+    for addr, c in pages[:args.top]:
+        names = page_symbols(symbols, int(addr, 16), profile['page_size'])
+        print(f"  {addr}: {c['read_bytes']:>10} B read, {c['write_bytes']:>10} B written"
+              + (f"  [{', '.join(names)}]" if names else ''))
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+# Copyright 2024 ETH Zurich and University of Bologna.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+"""Format the deferred log records of the Snitch runtime.
+
+`SNRT_LOG(fmt, ...)` records the address of its format string, the
+value of `mcycle` and its raw arguments in a per-hart ring buffer, the
+`snrt_log_buffers` array. This script takes the raw contents of that
+array, as read out after the run (e.g. with the `--log-dump` option of
+verification scripts) or during it through `SnitchSim.read()`, and
+formats the records with the format strings stored in the binary.
+
+Records are printed per hart in the order they were written, or
+merged across harts in `mcycle` order with `--sort`.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+# Header of a hart's buffer, and of each record, see `snrt_log_buffer_t`
+BUFFER_HDR_FIELDS = ['head', 'tail', 'len', 'dropped']
+RECORD_HDR_LEN = 3
+
+# printf conversion specifications supported by the runtime's printf
+SPEC_REGEX = re.compile(
+    r'%(?P<flags>[-+ #0]*)(?P<width>\*|\d+)?(?:\.(?P<precision>\*|\d+))?'
+    r'(?P<length>hh|h|ll|l|j|z|t|L)?(?P<conv>[diuxXoscpfFeEgG%])')
+
+
+class BinaryStrings(object):
+    """Reads NUL-terminated strings from the loadable sections of an ELF."""
+
+    def __init__(self, elf_path):
+        self.sections = []
+        with open(elf_path, 'rb') as f:
+            for section in ELFFile(f).iter_sections():
+                if section['sh_addr'] and section['sh_type'] != 'SHT_NOBITS':
+                    self.sections.append((section['sh_addr'], section.data()))
+
+    def read(self, addr):
+        for base, data in self.sections:
+            if base <= addr < base + len(data):
+                end = data.index(b'\0', addr - base)
+                return data[addr - base:end].decode(errors='replace')
+        return None
+
+
+def parse_buffers(raw, num_harts):
+    """Split the raw contents of `snrt_log_buffers` into the records of each hart.
+
+    Returns:
+        A dictionary mapping hart indices, i.e. `snrt_global_core_idx()`,
+        for harts which logged anything, to their number of dropped
+        records and their records as `(fmt_addr, mcycle, words)` tuples.
+    """
+    buffer_size = len(raw) // num_harts
+    buffers = {}
+    for hart in range(num_harts):
+        base = hart * buffer_size
+        hdr = dict(zip(BUFFER_HDR_FIELDS, struct.unpack_from('<4I', raw, base)))
+        length = hdr['len']
+        if not length:
+            continue
+        data = struct.unpack_from(f'<{length}I', raw, base + 4 * len(BUFFER_HDR_FIELDS))
+        records = []
+        pos = hdr['tail']
+        while pos != hdr['head']:
+            fmt, mcycle, n = (data[(pos + i) % length] for i in range(RECORD_HDR_LEN))
+            words = [data[(pos + RECORD_HDR_LEN + i) % length] for i in range(n)]
+            records.append((fmt, mcycle, words))
+            pos = (pos + RECORD_HDR_LEN + n) % 2**32
+        buffers[hart] = {'dropped': hdr['dropped'], 'records': records}
+    return buffers
+
+
+def format_record(fmt, words, strings):
+    """Format the argument words of a record as the runtime's printf would."""
+    words = list(words)
+
+    def pop(count=1):
+        if len(words) < count:
+            raise ValueError('missing arguments')
+        value = 0
+        for i in range(count):
+            value |= words.pop(0) << (32 * i)
+        return value
+
+    def convert(match):
+        spec = match.groupdict()
+        conv = spec['conv']
+        if conv == '%':
+            return '%'
+        width = str(pop()) if spec['width'] == '*' else (spec['width'] or '')
+        precision = str(pop()) if spec['precision'] == '*' else spec['precision']
+        pyspec = '%' + spec['flags'] + width + ('.' + precision if precision else '')
+        wide = spec['length'] in ('ll', 'j')
+        if conv in 'fFeEgG':
+            value = struct.unpack('<d', struct.pack('<Q', pop(2)))[0]
+        else:
+            value = pop(2 if wide else 1)
+        if conv in 'di':
+            bits = 64 if wide else 32
+            value -= (value >> (bits - 1)) << bits
+            return (pyspec + 'd') % value
+        if conv == 'u':
+            return (pyspec + 'd') % value
+        if conv == 'p':
+            return f'0x{value:08x}'
+        if conv == 's':
+            string = strings.read(value)
+            return (pyspec + 's') % (string if string is not None else f'<0x{value:08x}>')
+        if conv == 'c':
+            return (pyspec + 'c') % (value & 0xff)
+        return (pyspec + conv) % value
+
+    return SPEC_REGEX.sub(convert, fmt)
+
+
+def decode(raw, num_harts, strings):
+    """Decode the log records of all harts.
+
+    Returns:
+        A list of `(hart, mcycle, message)` tuples, per hart in the order
+        the records were written.
+    """
+    messages = []
+    for hart, buffer in parse_buffers(raw, num_harts).items():
+        if buffer['dropped']:
+            print(f'Warning: {buffer["dropped"]} records overwritten on hart {hart}',
+                  file=sys.stderr)
+        for fmt_addr, mcycle, words in buffer['records']:
+            fmt = strings.read(fmt_addr)
+            if fmt is None:
+                message = f'<unknown format string at 0x{fmt_addr:08x}>'
+            else:
+                try:
+                    message = format_record(fmt, words, strings)
+                except ValueError as e:
+                    message = f'<{e} for "{fmt}">'
+            messages.append((hart, mcycle, message.rstrip('\n')))
+    return messages
+
+
+def main():
+    # Argument parsing
+    parser = argparse.ArgumentParser()
+    parser.add_argument(
+        'elf',
+        help='The binary which produced the records')
+    parser.add_argument(
+        'input',
+        help='Raw contents of the snrt_log_buffers array')
+    parser.add_argument(
+        '--num-harts',
+        type=int,
+        required=True,
+        help='Number of harts in the system, i.e. the length of snrt_log_buffers')
+    parser.add_argument(
+        '--sort',
+        action='store_true',
+        help='Merge the records of all harts in mcycle order')
+    parser.add_argument(
+        '-o',
+        '--output',
+        help='Output file, instead of stdout')
+    args = parser.parse_args()
+
+    with open(args.input, 'rb') as f:
+        raw = f.read()
+    messages = decode(raw, args.num_harts, BinaryStrings(args.elf))
+    if args.sort:
+        messages.sort(key=lambda message: message[1])
+
+    out = open(args.output, 'w') if args.output else sys.stdout
+    for hart, mcycle, message in messages:
+        print(f'[hart {hart}] {mcycle:>10} {message}', file=out)
+    if args.output:
+        out.close()
+
+
+if __name__ == '__main__':
+    sys.exit(main())
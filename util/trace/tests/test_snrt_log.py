@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+# Copyright 2024 ETH Zurich and University of Bologna.
+# Licensed under the Apache License, Version 2.0, see LICENSE for details.
+# SPDX-License-Identifier: Apache-2.0
+
+from pathlib import Path
+import struct
+import sys
+
+sys.path.append(str(Path(__file__).parent / '..'))
+from snrt_log import decode, format_record, parse_buffers  # noqa: E402
+
+BUF_LEN = 16
+
+
+# Emulates the binary, with the strings at the given addresses
+class Strings(object):
+
+    def __init__(self, strings):
+        self.strings = strings
+
+    def read(self, addr):
+        return self.strings.get(addr)
+
+
+# Emulates the layout of `snrt_log_buffer_t`, with records written from `tail`
+def pack_buffer(records, tail=0, dropped=0):
+    if not records:
+        return bytes(4 * (4 + BUF_LEN))
+    data = [0] * BUF_LEN
+    head = tail
+    for fmt, mcycle, words in records:
+        for word in [fmt, mcycle, len(words)] + words:
+            data[head % BUF_LEN] = word
+            head += 1
+    return struct.pack(f'<{4 + BUF_LEN}I', head, tail, BUF_LEN, dropped, *data)
+
+
+def test_parse_buffers():
+    # Records wrap around the end of the buffer
+    raw = pack_buffer([(0x100, 10, [1, 2]), (0x104, 20, [3])], tail=12, dropped=2)
+    # Harts which do not log anything are skipped
+    raw += pack_buffer([])
+    raw += pack_buffer([(0x108, 30, [])])
+    assert parse_buffers(raw, 3) == {
+        0: {'dropped': 2, 'records': [(0x100, 10, [1, 2]), (0x104, 20, [3])]},
+        2: {'dropped': 0, 'records': [(0x108, 30, [])]},
+    }
+
+
+def test_format_record():
+    strings = Strings({0x200: 'world'})
+    assert format_record('%d %u %x', [2**32 - 1, 2**32 - 1, 255], strings) == \
+        '-1 4294967295 ff'
+    # 64-bit integers and doubles take two words, low word first
+    assert format_record('%lld', [2**32 - 2, 2**32 - 1], strings) == '-2'
+    double = struct.unpack('<2I', struct.pack('<d', 1.5))
+    assert format_record('%.2f', list(double), strings) == '1.50'
+    assert format_record('hello %s%c', [0x200, ord('!')], strings) == 'hello world!'
+    assert format_record('%s', [0x300], strings) == '<0x00000300>'
+    assert format_record('%*d|%%', [4, 7], strings) == '   7|%'
+
+
+def test_decode():
+    strings = Strings({0x100: 'x = %d\n', 0x104: 'done'})
+    raw = pack_buffer([(0x100, 10, [5]), (0x104, 12, [])])
+    raw += pack_buffer([(0x108, 11, []), (0x100, 13, [])])
+    assert decode(raw, 2, strings) == [
+        (0, 10, 'x = 5'),
+        (0, 12, 'done'),
+        (1, 11, '<unknown format string at 0x00000108>'),
+        (1, 13, '<missing arguments for "x = %d\n">'),
+    ]